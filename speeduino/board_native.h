@@ -0,0 +1,219 @@
+#ifndef NATIVE_H
+#define NATIVE_H
+#if defined(CORE_NATIVE)
+
+/*
+***********************************************************************************************************
+* General
+*
+* The native board runs the complete firmware as a host (Linux) program. There is no real hardware:
+* - micros()/millis() come from the host clock (See src/NativeArduino)
+* - The timer counters are derived from micros(), with the same 4uS tick as the Mega 2560
+* - Compare "interrupts" and the 1ms interval are dispatched by nativeServiceInterrupts()
+* - Crank/cam signals are generated by a simulated trigger wheel (See board_native.ino), or replayed from a file (See board_native_replay.ino)
+*/
+  #define PORT_TYPE uint8_t //Size of the port variables (Eg inj1_pin_port). Each native pin has its own 8-bit port, as on the AVR
+  #define PINMASK_TYPE uint8_t
+  #define COMPARE_TYPE uint16_t
+  #define COUNTER_TYPE uint16_t
+  #define SERIAL_BUFFER_SIZE 517 //Size of the serial buffer used by new comms protocol. For SD transfers this must be at least 512 + 1 (flag) + 4 (sector)
+  #define FPU_MAX_SIZE 0 //Size of the FPU buffer. 0 means no FPU.
+  #define EEPROM_LIB_H <EEPROM.h> //The name of the file that provides the EEPROM class
+  typedef int eeprom_address_t;
+  #define RTC_LIB_H <time.h> //There is no RTC library on the host. RTC_ENABLED is never set, so the standard header is a harmless stand in
+  #define micros_safe() micros() //timer5 method is not used on anything but AVR, the micros_safe() macro is simply an alias for the normal micros()
+  void initBoard(void);
+  uint16_t freeRam(void);
+  void doSystemReset(void);
+  void jumpToBootloader(void);
+  void nativeServiceInterrupts(void);
+  void nativeBoardBegin(void);
+  bool nativeBoardLoop(void);
+  void nativeBoardExit(void);
+  void nativeReplayBegin(void);
+  bool nativeReplayLoop(void);
+  void nativeDefaultConfig(void);
+
+  #define pinIsReserved(pin)  ( ((pin) == 0) ) //Forbidden pins like USB
+
+/*
+***********************************************************************************************************
+* Timers
+*
+* Each compare unit is a value and an interrupt enable flag. All units share one free running
+* counter, which ticks every 4uS (Identical to the Mega 2560 timers 3, 4 and 5)
+*/
+  enum native_timer_t {
+    NATIVE_TIMER_FUEL1, NATIVE_TIMER_FUEL2, NATIVE_TIMER_FUEL3, NATIVE_TIMER_FUEL4,
+    NATIVE_TIMER_FUEL5, NATIVE_TIMER_FUEL6, NATIVE_TIMER_FUEL7, NATIVE_TIMER_FUEL8,
+    NATIVE_TIMER_IGN1, NATIVE_TIMER_IGN2, NATIVE_TIMER_IGN3, NATIVE_TIMER_IGN4,
+    NATIVE_TIMER_IGN5, NATIVE_TIMER_IGN6, NATIVE_TIMER_IGN7, NATIVE_TIMER_IGN8,
+    NATIVE_TIMER_BOOST, NATIVE_TIMER_VVT, NATIVE_TIMER_IDLE, NATIVE_TIMER_FAN,
+    NATIVE_TIMER_COUNT
+  };
+
+  struct native_compare_t {
+    volatile COMPARE_TYPE compare; ///< The counter value that will trigger the interrupt
+    volatile bool enabled;         ///< Interrupt enable flag
+  };
+  extern native_compare_t nativeTimers[NATIVE_TIMER_COUNT];
+
+  #define NATIVE_TIMER_COUNTER ((COUNTER_TYPE)(micros() >> 2))
+  #define NATIVE_TIMER_ENABLE(timer) (nativeTimers[(timer)].enabled = true)
+  #define NATIVE_TIMER_DISABLE(timer) (nativeTimers[(timer)].enabled = false)
+
+  /*
+  Runs the ISR of each enabled compare unit whose compare value was passed by the counter in the (lastCounter, counter] window, exactly as a hardware compare match would.
+  Units with no ISR (nullptr) are skipped
+  */
+  static inline void nativeServiceCompareUnits(COUNTER_TYPE lastCounter, COUNTER_TYPE counter, void (* const isrs[NATIVE_TIMER_COUNT])(void))
+  {
+    COUNTER_TYPE elapsed = counter - lastCounter;
+    for (uint8_t timer = 0; timer < NATIVE_TIMER_COUNT; timer++)
+    {
+      //Ticks from the last service to the compare value
+      COUNTER_TYPE untilCompare = nativeTimers[timer].compare - lastCounter;
+      if ( (nativeTimers[timer].enabled == true) && (untilCompare != 0U) && (untilCompare <= elapsed) && (isrs[timer] != nullptr) ) { isrs[timer](); }
+    }
+  }
+
+  /*
+  The number of ticks after lastCounter at which the next enabled compare unit (With an ISR) will match. 0 if no unit is enabled.
+  Used with a virtual clock (See nativeSetVirtualClock()) to step straight from one compare match to the next
+  */
+  static inline uint32_t nativeTicksToNextCompare(COUNTER_TYPE lastCounter, void (* const isrs[NATIVE_TIMER_COUNT])(void))
+  {
+    uint32_t nextTicks = 0;
+    for (uint8_t timer = 0; timer < NATIVE_TIMER_COUNT; timer++)
+    {
+      if ( (nativeTimers[timer].enabled == true) && (isrs[timer] != nullptr) )
+      {
+        //A compare value equal to the last counter value has only just been passed, so won't match again until the counter wraps
+        uint32_t untilCompare = (COUNTER_TYPE)(nativeTimers[timer].compare - lastCounter);
+        if (untilCompare == 0U) { untilCompare = (uint32_t)UINT16_MAX + 1UL; }
+        if ( (nextTicks == 0U) || (untilCompare < nextTicks) ) { nextTicks = untilCompare; }
+      }
+    }
+    return nextTicks;
+  }
+
+/*
+***********************************************************************************************************
+* Schedules
+*/
+  #define FUEL1_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL2_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL3_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL4_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL5_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL6_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL7_COUNTER NATIVE_TIMER_COUNTER
+  #define FUEL8_COUNTER NATIVE_TIMER_COUNTER
+
+  #define IGN1_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN2_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN3_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN4_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN5_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN6_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN7_COUNTER  NATIVE_TIMER_COUNTER
+  #define IGN8_COUNTER  NATIVE_TIMER_COUNTER
+
+  #define FUEL1_COMPARE nativeTimers[NATIVE_TIMER_FUEL1].compare
+  #define FUEL2_COMPARE nativeTimers[NATIVE_TIMER_FUEL2].compare
+  #define FUEL3_COMPARE nativeTimers[NATIVE_TIMER_FUEL3].compare
+  #define FUEL4_COMPARE nativeTimers[NATIVE_TIMER_FUEL4].compare
+  #define FUEL5_COMPARE nativeTimers[NATIVE_TIMER_FUEL5].compare
+  #define FUEL6_COMPARE nativeTimers[NATIVE_TIMER_FUEL6].compare
+  #define FUEL7_COMPARE nativeTimers[NATIVE_TIMER_FUEL7].compare
+  #define FUEL8_COMPARE nativeTimers[NATIVE_TIMER_FUEL8].compare
+
+  #define IGN1_COMPARE  nativeTimers[NATIVE_TIMER_IGN1].compare
+  #define IGN2_COMPARE  nativeTimers[NATIVE_TIMER_IGN2].compare
+  #define IGN3_COMPARE  nativeTimers[NATIVE_TIMER_IGN3].compare
+  #define IGN4_COMPARE  nativeTimers[NATIVE_TIMER_IGN4].compare
+  #define IGN5_COMPARE  nativeTimers[NATIVE_TIMER_IGN5].compare
+  #define IGN6_COMPARE  nativeTimers[NATIVE_TIMER_IGN6].compare
+  #define IGN7_COMPARE  nativeTimers[NATIVE_TIMER_IGN7].compare
+  #define IGN8_COMPARE  nativeTimers[NATIVE_TIMER_IGN8].compare
+
+  #define FUEL1_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL1)
+  #define FUEL2_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL2)
+  #define FUEL3_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL3)
+  #define FUEL4_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL4)
+  #define FUEL5_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL5)
+  #define FUEL6_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL6)
+  #define FUEL7_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL7)
+  #define FUEL8_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_FUEL8)
+
+  #define FUEL1_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL1)
+  #define FUEL2_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL2)
+  #define FUEL3_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL3)
+  #define FUEL4_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL4)
+  #define FUEL5_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL5)
+  #define FUEL6_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL6)
+  #define FUEL7_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL7)
+  #define FUEL8_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_FUEL8)
+
+  #define IGN1_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN1)
+  #define IGN2_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN2)
+  #define IGN3_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN3)
+  #define IGN4_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN4)
+  #define IGN5_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN5)
+  #define IGN6_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN6)
+  #define IGN7_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN7)
+  #define IGN8_TIMER_ENABLE() NATIVE_TIMER_ENABLE(NATIVE_TIMER_IGN8)
+
+  #define IGN1_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN1)
+  #define IGN2_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN2)
+  #define IGN3_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN3)
+  #define IGN4_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN4)
+  #define IGN5_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN5)
+  #define IGN6_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN6)
+  #define IGN7_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN7)
+  #define IGN8_TIMER_DISABLE() NATIVE_TIMER_DISABLE(NATIVE_TIMER_IGN8)
+
+  #define MAX_TIMER_PERIOD 262140UL //The longest period of time (in uS) that the timer can permit (IN this case it is 65535 * 4, as each timer tick is 4uS)
+  #define uS_TO_TIMER_COMPARE(uS1) ((uS1) >> 2) //Converts a given number of uS into the required number of timer ticks until that time has passed
+
+/*
+***********************************************************************************************************
+* Auxiliaries
+*/
+  #define PWM_FAN_AVAILABLE
+
+  #define ENABLE_BOOST_TIMER()  NATIVE_TIMER_ENABLE(NATIVE_TIMER_BOOST)
+  #define DISABLE_BOOST_TIMER() NATIVE_TIMER_DISABLE(NATIVE_TIMER_BOOST)
+
+  #define ENABLE_VVT_TIMER()    NATIVE_TIMER_ENABLE(NATIVE_TIMER_VVT)
+  #define DISABLE_VVT_TIMER()   NATIVE_TIMER_DISABLE(NATIVE_TIMER_VVT)
+
+  #define ENABLE_FAN_TIMER()    NATIVE_TIMER_ENABLE(NATIVE_TIMER_FAN)
+  #define DISABLE_FAN_TIMER()   NATIVE_TIMER_DISABLE(NATIVE_TIMER_FAN)
+
+  #define BOOST_TIMER_COMPARE   nativeTimers[NATIVE_TIMER_BOOST].compare
+  #define BOOST_TIMER_COUNTER   NATIVE_TIMER_COUNTER
+  #define VVT_TIMER_COMPARE     nativeTimers[NATIVE_TIMER_VVT].compare
+  #define VVT_TIMER_COUNTER     NATIVE_TIMER_COUNTER
+  #define FAN_TIMER_COMPARE     nativeTimers[NATIVE_TIMER_FAN].compare
+  #define FAN_TIMER_COUNTER     NATIVE_TIMER_COUNTER
+
+/*
+***********************************************************************************************************
+* Idle
+*/
+  //Same as above, but for the timer controlling PWM idle
+  #define IDLE_COUNTER          NATIVE_TIMER_COUNTER
+  #define IDLE_COMPARE          nativeTimers[NATIVE_TIMER_IDLE].compare
+
+  #define IDLE_TIMER_ENABLE()   NATIVE_TIMER_ENABLE(NATIVE_TIMER_IDLE)
+  #define IDLE_TIMER_DISABLE()  NATIVE_TIMER_DISABLE(NATIVE_TIMER_IDLE)
+
+/*
+***********************************************************************************************************
+* CAN / Second serial
+*/
+  #define USE_SERIAL3
+
+#endif //CORE_NATIVE
+#endif //NATIVE_H
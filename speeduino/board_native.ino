@@ -0,0 +1,179 @@
+#if defined(CORE_NATIVE)
+#include "globals.h"
+#include "auxiliaries.h"
+#include "idle.h"
+#include "scheduler.h"
+#include "timers.h"
+
+native_compare_t nativeTimers[NATIVE_TIMER_COUNT];
+
+//The ISR attached to each compare unit. Must be in the same order as native_timer_t
+static void (* const nativeTimerISRs[NATIVE_TIMER_COUNT])(void) = {
+  fuelSchedule1Interrupt, fuelSchedule2Interrupt, fuelSchedule3Interrupt, fuelSchedule4Interrupt,
+  fuelSchedule5Interrupt, fuelSchedule6Interrupt, fuelSchedule7Interrupt, fuelSchedule8Interrupt,
+  ignitionSchedule1Interrupt, ignitionSchedule2Interrupt, ignitionSchedule3Interrupt, ignitionSchedule4Interrupt,
+  ignitionSchedule5Interrupt, ignitionSchedule6Interrupt, ignitionSchedule7Interrupt, ignitionSchedule8Interrupt,
+  boostInterrupt, vvtInterrupt, idleInterrupt, fanInterrupt,
+};
+
+static COUNTER_TYPE lastTimerCounter;
+static uint32_t lastMSInterval;
+
+/*
+The simulated crank trigger wheel. This is a missing tooth wheel on pinTrigger, spinning at a fixed RPM
+The RPM is set by the SPEEDUINO_NATIVE_RPM environment variable. 0 (The default) means the engine is stopped
+It is replaced by the recorded signals when a trigger replay is running (See board_native_replay.ino)
+*/
+#define NATIVE_WHEEL_TEETH    36
+#define NATIVE_WHEEL_MISSING  1
+static uint32_t nativeToothPeriod; //uS per tooth. 0 if the simulated wheel is stopped
+static uint32_t nativeLastToothTime;
+static uint8_t nativeToothNumber;
+
+void initBoard(void)
+{
+    /*
+    ***********************************************************************************************************
+    * General
+    */
+    const char *rpmText = getenv("SPEEDUINO_NATIVE_RPM");
+    unsigned long rpm = (rpmText != nullptr) ? strtoul(rpmText, nullptr, 10) : 0UL;
+    nativeToothPeriod = (rpm > 0UL) ? (60000000UL / (rpm * NATIVE_WHEEL_TEETH)) : 0UL;
+    nativeLastToothTime = micros();
+    nativeToothNumber = 1;
+
+    /*
+    ***********************************************************************************************************
+    * Timers
+    */
+    for (uint8_t timer = 0; timer < NATIVE_TIMER_COUNT; timer++)
+    {
+      nativeTimers[timer].compare = 0;
+      nativeTimers[timer].enabled = false;
+    }
+    lastTimerCounter = NATIVE_TIMER_COUNTER;
+    lastMSInterval = millis();
+
+    /*
+    ***********************************************************************************************************
+    * Auxiliaries
+    */
+    //All the auxiliary outputs share the 4uS schedule counter
+    boost_pwm_max_count = 1000000L / (4 * configPage6.boostFreq * 2); //Converts the frequency in Hz to the number of ticks (at 4uS) it takes to complete 1 cycle. The x2 is there because the frequency is stored at half value (in a byte) to allow frequencies up to 511Hz
+    vvt_pwm_max_count = 1000000L / (4 * configPage6.vvtFreq * 2); //Converts the frequency in Hz to the number of ticks (at 4uS) it takes to complete 1 cycle
+    fan_pwm_max_count = 1000000L / (4 * configPage6.fanFreq * 2); //Converts the frequency in Hz to the number of ticks (at 4uS) it takes to complete 1 cycle
+
+    /*
+    ***********************************************************************************************************
+    * Idle
+    */
+    //idle_pwm_max_count is set in idle.ino
+}
+
+/*
+Advances the simulated trigger wheel up to the current time, delivering an edge pair (Rising then falling) to the trigger ISR for every tooth that has passed.
+micros() is held at the time each tooth was due while its ISR runs, so the decoder sees exact tooth timing even if the host was late in getting here
+*/
+static inline void nativeServiceTriggerWheel(void)
+{
+  if ( (nativeToothPeriod == 0UL) || (pinTrigger >= NUM_DIGITAL_PINS) ) { return; }
+
+  uint32_t now = micros();
+  //If the host stalled for more than a revolution (E.g. it was suspended), restart the wheel from now rather than catching up
+  if ((now - nativeLastToothTime) > (nativeToothPeriod * NATIVE_WHEEL_TEETH)) { nativeLastToothTime = now - nativeToothPeriod; }
+
+  while ((now - nativeLastToothTime) >= nativeToothPeriod)
+  {
+    nativeLastToothTime += nativeToothPeriod;
+    nativeToothNumber++;
+    if (nativeToothNumber > NATIVE_WHEEL_TEETH) { nativeToothNumber = 1; }
+    if (nativeToothNumber > (NATIVE_WHEEL_TEETH - NATIVE_WHEEL_MISSING)) { continue; } //Missing tooth, no edges
+
+    native_pin_interrupt_t &trigger = nativePinInterrupts[pinTrigger];
+    nativeHoldMicros(nativeLastToothTime);
+    nativePortRegisters[pinTrigger] = HIGH;
+    if ( (trigger.handler != nullptr) && (trigger.mode != FALLING) ) { trigger.handler(); }
+    nativePortRegisters[pinTrigger] = LOW;
+    if ( (trigger.handler != nullptr) && (trigger.mode != RISING) ) { trigger.handler(); }
+    nativeReleaseMicros();
+  }
+}
+
+/*
+Delivers any pending "interrupts". This is the native equivalent of the interrupt controller and is called between main loop iterations, whenever interrupts are re-enabled and while delaying.
+A compare interrupt fires if its compare value was passed by the counter since the last call, exactly as a hardware compare match would.
+*/
+void nativeServiceInterrupts(void)
+{
+  static bool inInterrupt = false;
+  if ( (nativeInterruptsEnabled == false) || (inInterrupt == true) ) { return; }
+  inInterrupt = true;
+
+  nativeServiceTriggerWheel();
+
+  COUNTER_TYPE counter = NATIVE_TIMER_COUNTER;
+  if (counter != lastTimerCounter)
+  {
+    nativeServiceCompareUnits(lastTimerCounter, counter, nativeTimerISRs);
+    lastTimerCounter = counter;
+  }
+
+  uint32_t ms = millis();
+  while (ms != lastMSInterval)
+  {
+    lastMSInterval++;
+    oneMSInterval();
+  }
+
+  inInterrupt = false;
+}
+
+uint16_t freeRam(void)
+{
+  return UINT16_MAX; //There is no meaningful limit on the host
+}
+
+/*
+A blank config is all zeros, which leads to integer divisions by 0 during initialisation. These give 0 on the ARM boards, but trap on the host.
+This sets the minimum values needed to start: A 4 cylinder engine with a 36-1 crank wheel, matching the simulated trigger wheel
+*/
+void nativeDefaultConfig(void)
+{
+  configPage2.nCylinders = 4;
+  configPage2.divider = 2;
+  configPage4.triggerTeeth = NATIVE_WHEEL_TEETH;
+  configPage4.triggerMissingTeeth = NATIVE_WHEEL_MISSING;
+}
+
+void doSystemReset(void) { return; }
+void jumpToBootloader(void) { return; }
+
+/*
+Called once setup() has completed (See main() in src/NativeArduino)
+*/
+void nativeBoardBegin(void)
+{
+  nativeReplayBegin();
+}
+
+/*
+Called after each main loop iteration. Returns false to end the program
+*/
+bool nativeBoardLoop(void)
+{
+  nativeServiceInterrupts();
+  return nativeReplayLoop();
+}
+
+/*
+Called once the requested number of main loop iterations have completed, or nativeBoardLoop() has ended the program (See main() in src/NativeArduino)
+*/
+void nativeBoardExit(void)
+{
+  fprintf(stderr, "RPM: %u, Sync: %u, Loops/s: %lu, Sync loss count: %u\n", (unsigned)currentStatus.RPM, (unsigned)currentStatus.hasSync, (unsigned long)currentStatus.loopsPerSecond, (unsigned)currentStatus.syncLossCounter);
+
+  Serial.end();
+  Serial3.end();
+}
+
+#endif
@@ -0,0 +1,332 @@
+/*
+Speeduino - Simple engine management for the Arduino Mega 2560 platform
+Copyright (C) Josh Stewart
+A full copy of the license may be found in the projects root directory
+*/
+/** @file
+ * Offline replay of recorded trigger signals through the decoders, for the native board.
+ *
+ * When the SPEEDUINO_NATIVE_REPLAY environment variable names a file, the simulated trigger wheel is replaced by the
+ * edges in that file. The firmware then runs on a virtual clock that follows the recorded times, with the main loop run
+ * every NATIVE_REPLAY_LOOP_TIME uS in between the edges, and exits with a report once the file has been replayed:
+ * - The time (And number of primary teeth, ie calls of the primary handler) to gain sync, and each loss of sync
+ * - The error of the crank angle (getCrankAngle()) and RPM (currentStatus.RPM, from getRPM()) against the ground truth, when the file has it
+ * - The host CPU time of the trigger handlers per tooth
+ *
+ * Each line of the file is one of the following, and the formats may be mixed. Blank lines, comments (#) and headers are skipped:
+ * - Edge:      <time uS>,<P|S|T>,<level 0|1>[,<crank angle>[,<RPM>]]
+ *              An edge on the primary, secondary or tertiary input, optionally with the true crank angle (Including the trigger angle) and RPM at that time
+ * - Tooth log: <gap uS>
+ *              A primary tooth, this long after the previous one. This is the toothHistory format of the tooth logger
+ * - Composite: <time uS>,<flags>
+ *              An entry of the composite logger (toothHistory and compositeLogHistory). The COMPOSITE_LOG_TRIG flag marks
+ *              a secondary edge, otherwise it is primary. The recorded COMPOSITE_LOG_SYNC is compared with the replayed sync
+ *
+ * The decoder comes from the tune (See SPEEDUINO_EEPROM). It can be overridden with SPEEDUINO_NATIVE_DECODER=<TrigPattern>[,<triggerTeeth>,<triggerMissingTeeth>]
+ * Example: SPEEDUINO_NATIVE_DECODER=0,36,1 SPEEDUINO_NATIVE_REPLAY=synclosses.csv .pio/build/native/program
+ */
+#if defined(CORE_NATIVE)
+#include "globals.h"
+#include "decoders.h"
+#include <errno.h>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+#define NATIVE_REPLAY_LOOP_TIME 100 //uS of virtual time that each main loop takes
+#define NATIVE_REPLAY_LINE_SIZE 128
+
+struct nativeReplayEdge {
+  uint32_t time;     ///< The virtual time (micros()) of the edge
+  uint32_t line;     ///< The line of the file
+  uint8_t pin;
+  uint8_t level;     ///< The level of the input after the edge. NATIVE_REPLAY_PULSE for a tooth log entry
+  bool hasAngle;
+  int16_t angle;     ///< The true crank angle, when hasAngle is set
+  uint16_t rpm;      ///< The true RPM. 0 if unknown
+  int8_t loggedSync; ///< The sync recorded by the composite logger. -1 if unknown
+};
+#define NATIVE_REPLAY_PULSE 2 //A tooth log entry is a complete pulse on the primary input (Rising then falling edge), as from the simulated wheel
+
+struct nativeReplayErrors {
+  uint32_t count;
+  uint64_t totalAbs;
+  int32_t maxAbs;
+};
+
+struct nativeReplayCost {
+  uint32_t count;
+  uint64_t total;
+  uint64_t min;
+  uint64_t max;
+};
+
+static FILE *replayFile = nullptr;
+static uint32_t replayLine;         //The number of lines read from the file
+static uint32_t replayStartTime;    //The virtual time of the first edge
+static uint32_t replayTimeOffset;   //From the times in the file to virtual time
+static uint32_t replayLastFileTime; //The last time read from the file, for the tooth log format
+static bool replayFirstEdge;
+static nativeReplayEdge replayNextEdge;
+static bool replayHasNextEdge;
+static bool replayHadSync;
+
+static uint32_t replaySyncTime;
+static uint32_t replaySyncTeeth;
+static uint32_t replaySyncLosses;
+static uint32_t replaySyncDifferences;
+static nativeReplayErrors replayAngleErrors;
+static nativeReplayErrors replayRPMErrors;
+static nativeReplayCost replayPrimaryCost;
+static nativeReplayCost replaySecondaryCost;
+
+//Host CPU cycles. On x86 this is the time stamp counter, elsewhere nanoseconds
+static inline uint64_t nativeReplayCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static void addReplayError(nativeReplayErrors &errors, int32_t error)
+{
+  int32_t absError = (error < 0) ? -error : error;
+  errors.count++;
+  errors.totalAbs += (uint64_t)absError;
+  if (absError > errors.maxAbs) { errors.maxAbs = absError; }
+}
+
+static void addReplayCost(nativeReplayCost &cost, uint64_t cycles)
+{
+  if ( (cost.count == 0U) || (cycles < cost.min) ) { cost.min = cycles; }
+  if (cycles > cost.max) { cost.max = cycles; }
+  cost.total += cycles;
+  cost.count++;
+}
+
+/*
+Reads the next edge from the file. Returns false at the end of the file
+*/
+static bool readReplayEdge(nativeReplayEdge &edge)
+{
+  char line[NATIVE_REPLAY_LINE_SIZE];
+  while (fgets(line, sizeof(line), replayFile) != nullptr)
+  {
+    replayLine++;
+    //Headers and comments don't start with a number
+    if ( (line[0] < '0') || (line[0] > '9') ) { continue; }
+
+    char *fields[5] = { line, nullptr, nullptr, nullptr, nullptr };
+    uint8_t fieldCount = 1;
+    for (char *character = line; (*character != '\0') && (fieldCount < 5U); character++)
+    {
+      if (*character == ',') { *character = '\0'; fields[fieldCount++] = character + 1; }
+    }
+
+    uint32_t time = strtoul(fields[0], nullptr, 10);
+    edge.hasAngle = false;
+    edge.rpm = 0;
+    edge.loggedSync = -1;
+    if (fieldCount == 1U)
+    {
+      //Tooth log
+      time = replayLastFileTime + time;
+      edge.pin = pinTrigger;
+      edge.level = NATIVE_REPLAY_PULSE;
+    }
+    else if (fieldCount == 2U)
+    {
+      //Composite log
+      uint8_t flags = (uint8_t)strtoul(fields[1], nullptr, 10);
+      edge.pin = BIT_CHECK(flags, COMPOSITE_LOG_TRIG) ? pinTrigger2 : pinTrigger;
+      edge.level = BIT_CHECK(flags, COMPOSITE_LOG_TRIG) ? BIT_CHECK(flags, COMPOSITE_LOG_SEC) : BIT_CHECK(flags, COMPOSITE_LOG_PRI);
+      edge.loggedSync = BIT_CHECK(flags, COMPOSITE_LOG_SYNC) ? 1 : 0;
+    }
+    else
+    {
+      //Edge
+      switch (fields[1][0])
+      {
+        case 'S': case 's': edge.pin = pinTrigger2; break;
+        case 'T': case 't': edge.pin = pinTrigger3; break;
+        default: edge.pin = pinTrigger; break;
+      }
+      edge.level = (strtoul(fields[2], nullptr, 10) != 0UL) ? HIGH : LOW;
+      if (fieldCount > 3U) { edge.hasAngle = true; edge.angle = (int16_t)strtol(fields[3], nullptr, 10); }
+      if (fieldCount > 4U) { edge.rpm = (uint16_t)strtoul(fields[4], nullptr, 10); }
+    }
+
+    if (replayFirstEdge == true)
+    {
+      replayFirstEdge = false;
+      replayTimeOffset = replayStartTime - time;
+    }
+    replayLastFileTime = time;
+    edge.time = replayTimeOffset + time;
+    edge.line = replayLine;
+    return true;
+  }
+  return false;
+}
+
+/*
+Moves the virtual clock forward to the given time, stopping at every compare match on the way so that the schedules run at the right times (As runUntil() in the schedule tests)
+*/
+static void advanceReplayClock(uint32_t until)
+{
+  uint32_t now = micros();
+  while ((int32_t)(until - now) > 0)
+  {
+    uint32_t ticks = nativeTicksToNextCompare(lastTimerCounter, nativeTimerISRs);
+    uint32_t next = (now & ~3UL) + (ticks * 4UL);
+    if ( (ticks == 0U) || ((int32_t)(next - until) > 0) ) { next = until; }
+    nativeSetVirtualClock(next);
+    now = next;
+  }
+}
+
+//Sets the level of an input, calling its interrupt handler if that is an edge it is attached to
+static void replayPinLevel(uint8_t pin, uint8_t level)
+{
+  if (pin >= NUM_DIGITAL_PINS) { return; }
+  native_pin_interrupt_t &input = nativePinInterrupts[pin];
+  bool edge = (nativePortRegisters[pin] != level);
+  nativePortRegisters[pin] = level;
+  if ( (edge == false) || (input.handler == nullptr) ) { return; }
+  if ( (input.mode == CHANGE) || ( (input.mode == RISING) && (level == HIGH) ) || ( (input.mode == FALLING) && (level == LOW) ) )
+  {
+    uint64_t start = nativeReplayCycles();
+    input.handler();
+    addReplayCost( (pin == pinTrigger) ? replayPrimaryCost : replaySecondaryCost, nativeReplayCycles() - start);
+  }
+}
+
+static void replayEdge(const nativeReplayEdge &edge)
+{
+  advanceReplayClock(edge.time);
+  uint16_t syncLossCounter = currentStatus.syncLossCounter;
+
+  noInterrupts(); //Nothing else runs while the trigger handlers do
+  if (edge.level == NATIVE_REPLAY_PULSE)
+  {
+    replayPinLevel(edge.pin, HIGH);
+    replayPinLevel(edge.pin, LOW);
+  }
+  else { replayPinLevel(edge.pin, edge.level); }
+
+  //The decoder state is checked with interrupts still off, as the decoder left it
+  uint32_t time = edge.time - replayStartTime;
+  if ( (currentStatus.hasSync == true) && (replayHadSync == false) && (replaySyncTeeth == 0U) )
+  {
+    replaySyncTime = time;
+    replaySyncTeeth = replayPrimaryCost.count;
+  }
+  if ( ( (currentStatus.hasSync == false) && (replayHadSync == true) ) || (currentStatus.syncLossCounter != syncLossCounter) )
+  {
+    replaySyncLosses++;
+    fprintf(stderr, "Sync lost at %lu uS (Line %lu)\n", (unsigned long)time, (unsigned long)edge.line);
+  }
+  replayHadSync = currentStatus.hasSync;
+
+  if ( (edge.loggedSync >= 0) && ((edge.loggedSync == 1) != currentStatus.hasSync) ) { replaySyncDifferences++; }
+  if (currentStatus.hasSync == true)
+  {
+    //The angle between teeth can't be worked out until the main loop has first calculated the RPM after sync
+    if ( (edge.hasAngle == true) && (currentStatus.RPM > 0U) )
+    {
+      int32_t error = (getCrankAngle() - edge.angle) % CRANK_ANGLE_MAX;
+      if (error >= (CRANK_ANGLE_MAX / 2)) { error -= CRANK_ANGLE_MAX; }
+      else if (error < -(CRANK_ANGLE_MAX / 2)) { error += CRANK_ANGLE_MAX; }
+      addReplayError(replayAngleErrors, error);
+    }
+    //The RPM is 0 until the main loop has first calculated it after sync
+    if ( (edge.rpm > 0U) && (currentStatus.RPM > 0U) ) { addReplayError(replayRPMErrors, (int32_t)currentStatus.RPM - (int32_t)edge.rpm); }
+  }
+  interrupts();
+}
+
+static void printReplayErrors(const char *name, const nativeReplayErrors &errors)
+{
+  if (errors.count == 0U) { return; }
+  fprintf(stderr, "%s error: Mean %.2f, Max %ld (%lu samples)\n", name, (double)errors.totalAbs / errors.count, (long)errors.maxAbs, (unsigned long)errors.count);
+}
+
+static void printReplayCost(const char *name, const nativeReplayCost &cost)
+{
+  if (cost.count == 0U) { return; }
+  fprintf(stderr, "%s handler cost (Host cycles): Min %llu, Mean %llu, Max %llu (%lu calls)\n", name, (unsigned long long)cost.min, (unsigned long long)(cost.total / cost.count), (unsigned long long)cost.max, (unsigned long)cost.count);
+}
+
+static void printReplayReport(void)
+{
+  fprintf(stderr, "Replayed %lu lines\n", (unsigned long)replayLine);
+  if (replaySyncTeeth > 0U) { fprintf(stderr, "Time to sync: %lu uS (%lu primary teeth)\n", (unsigned long)replaySyncTime, (unsigned long)replaySyncTeeth); }
+  else { fprintf(stderr, "Sync was never gained\n"); }
+  fprintf(stderr, "Sync losses: %lu\n", (unsigned long)replaySyncLosses);
+  if (replaySyncDifferences > 0U) { fprintf(stderr, "Entries where the logged sync differs: %lu\n", (unsigned long)replaySyncDifferences); }
+  printReplayErrors("Crank angle", replayAngleErrors);
+  printReplayErrors("RPM", replayRPMErrors);
+  printReplayCost("Primary", replayPrimaryCost);
+  printReplayCost("Secondary", replaySecondaryCost);
+}
+
+/** Starts replaying the file named by SPEEDUINO_NATIVE_REPLAY, if any. Called once setup() has completed */
+void nativeReplayBegin(void)
+{
+  const char *path = getenv("SPEEDUINO_NATIVE_REPLAY");
+  if (path == nullptr) { return; }
+  replayFile = fopen(path, "r");
+  if (replayFile == nullptr) { fprintf(stderr, "Unable to open %s (%s)\n", path, strerror(errno)); return; }
+
+  const char *decoder = getenv("SPEEDUINO_NATIVE_DECODER");
+  if (decoder != nullptr)
+  {
+    char *next;
+    configPage4.TrigPattern = strtoul(decoder, &next, 10);
+    if (*next == ',') { configPage4.triggerTeeth = strtoul(next + 1, &next, 10); }
+    if (*next == ',') { configPage4.triggerMissingTeeth = strtoul(next + 1, &next, 10); }
+  }
+
+  //The replay replaces the simulated wheel, and sets the pace from now on
+  nativeToothPeriod = 0;
+  nativeSetVirtualClock(micros());
+  initialiseTriggers();
+
+  replayLine = 0;
+  replayLastFileTime = 0;
+  replayFirstEdge = true;
+  replayStartTime = micros() + 1000UL;
+  replayHadSync = currentStatus.hasSync;
+  replayHasNextEdge = readReplayEdge(replayNextEdge);
+}
+
+/** Runs the replay for one main loop. Returns false once the whole file has been replayed (After printing the report), true otherwise.
+ * Returns true straight away if no replay is running.
+ */
+bool nativeReplayLoop(void)
+{
+  if (replayFile == nullptr) { return true; }
+
+  uint32_t loopEnd = micros() + NATIVE_REPLAY_LOOP_TIME;
+  while ( (replayHasNextEdge == true) && ((int32_t)(replayNextEdge.time - loopEnd) <= 0) )
+  {
+    replayEdge(replayNextEdge);
+    replayHasNextEdge = readReplayEdge(replayNextEdge);
+  }
+  advanceReplayClock(loopEnd);
+
+  if (replayHasNextEdge == false)
+  {
+    printReplayReport();
+    fclose(replayFile);
+    replayFile = nullptr;
+    return false;
+  }
+  return true;
+}
+
+#endif
@@ -17,7 +17,7 @@
   #else //libmaple core aka STM32DUINO
     extern HardwareSerial &CANSerial;
   #endif
-#elif defined(CORE_TEENSY)
+#elif defined(CORE_TEENSY) || defined(CORE_NATIVE)
   #define CANSerial_AVAILABLE
   extern HardwareSerial &CANSerial;
 #endif
@@ -20,6 +20,7 @@ sendcancommand is called when a command is to be sent either to serial3
 #include "maths.h"
 #include "errors.h"
 #include "utilities.h"
+#include "output_channels.h"
 
 uint8_t currentsecondserialCommand;
 uint8_t currentCanPage = 1;//Not the same as the speeduino config page numbers
@@ -44,6 +45,8 @@ bool canCmdPending = false;
   #endif
 #elif defined(CORE_TEENSY)
   HardwareSerial &CANSerial = Serial2;
+#elif defined(CORE_NATIVE)
+  HardwareSerial &CANSerial = Serial3;
 #endif
 
 void secondserial_Command(void)
@@ -795,6 +798,7 @@ if (PIDmode == 0x01)
      else if (requestedPIDhigh == 0x78)
        {
           int16_t tempValue;
+          updateOutputChannels();
           tempValue = ProgrammableIOGetData(requestedPIDlow);
           outMsg.buf[0] =  0x06;                 // sending 6 bytes
           outMsg.buf[1] =  0x62;                 // Same as query, except that 40h is added to the mode value. So:62h = custom mode
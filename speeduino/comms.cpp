@@ -20,7 +20,10 @@ A full copy of the license may be found in the projects root directory
 #include "logger.h"
 #include "comms_legacy.h"
 #include "src/FastCRC/FastCRC.h"
+#include "crc_stream.h"
+#include "serial_tx.h"
 #include "table3d_axis_io.h"
+#include "isr_stats.h"
 #ifdef RTC_ENABLED
   #include "rtc_common.h"
 #endif
@@ -32,9 +35,24 @@ uint16_t serialPayloadLength = 0;
 bool serialReceivePending = false; /**< Whether or not a serial request has only been partially received. This occurs when a the length has been received in the serial buffer, but not all of the payload or CRC has yet been received. */
 uint16_t serialBytesReceived = 0; /**< The number of bytes received in the serial buffer during the current command. */
 uint32_t serialCRC = 0; 
-bool serialWriteInProgress = false;
-uint16_t serialBytesTransmitted = 0;
 uint32_t serialReceiveStartTime = 0; /**< The time at which the serial receive started. Used for calculating whether a timeout has occurred */
+static bool toothLogStreaming = false; /**< Whether the tooth and composite logs are being sent in streaming mode (The 'l' command), with the stream header */
+static uint8_t compactToothLogOffset = 0; /**< The next entry of the ready tooth log buffer to send in the compact format */
+static uint8_t toothLogSendOffset = 0; /**< The next entry of the ready tooth log buffer to be copied into serialPayload (See queueToothLogChunk()) */
+static uint8_t toothLogSendEntrySize = TOOTH_LOG_ENTRY_SIZE; /**< The size of each entry of the log being sent. TOOTH_LOG_ENTRY_SIZE or COMPOSITE_LOG_ENTRY_SIZE */
+static FastCRC32 CRC32_serialTx; /**< Used only for the CRC of payloads as they are sent (See sendSerialPayload()), which can be part way through when a new command arrives */
+static crcStream serialTxCRC;
+static outputChannelBlock deltaOutputChannels; /**< The realtime data block as of the last frame sent by the 'o' command, as held by the receiver */
+static_assert((OUTPUT_CHANNEL_DELTA_MAX_SIZE + 1U) <= SERIAL_BUFFER_SIZE, "A delta frame of every field must fit in serialPayload");
+
+static uint16_t serialTxSpace(void)
+{
+  int space = Serial.availableForWrite();
+  return (space > 0) ? (uint16_t)space : 0U;
+}
+static uint16_t serialTxWrite(const uint8_t *pData, uint16_t length) { return (uint16_t)Serial.write(pData, length); }
+static const serialTxPort serialTxPortSerial = { serialTxSpace, serialTxWrite };
+static serialTxQueue serialTx = { &serialTxPortSerial, &CRC32_serialTx, {}, 0, 0, 0 }; /**< Responses waiting to be written to Serial. Serviced from the main loop by continueSerialTransmission() */
 FastCRC32 CRC32_serial; //This instance of CRC32 is exclusively used on the comms envelope CRC validations. It is separate to those used for page or calibration calculations to prevent update calls clashing with one another
 #ifdef RTC_ENABLED
   uint8_t serialPayload[SD_FILE_TRANSMIT_BUFFER_SIZE]; /**< Serial payload buffer must be significantly larger for boards that support SD logging. Large enough to contain 4 sectors + overhead */
@@ -63,6 +81,9 @@ Comands are single byte (letter symbol) commands.
 */
 void parseSerial(void)
 {
+  //serialPayload is also the buffer that queued responses are sent from, so nothing is received into it until the
+  //previous response has all been written to the port. This also stops responses being written out of order
+  if(serialTx_isBusy(serialTx) == true) { return; }
 
   //Check for an existing legacy command in progress
   if(cmdPending == true)
@@ -151,84 +172,45 @@ void parseSerial(void)
 
 void sendSerialReturnCode(byte returnCode)
 {
-  Serial.write((uint8_t)0);
-  Serial.write((uint8_t)1); //Size is always 1
+  //Make room for the 2 entries. Normally the queue is empty, as TS waits for each response before sending the next command
+  while(serialTx_available(serialTx) < 2U) { serialTx_service(serialTx); }
 
-  Serial.write(returnCode);
-
-  //Calculate and send CRC
+  const uint8_t message[3] = { 0, 1, returnCode }; //Size is always 1
   uint32_t CRC32_val = CRC32_serial.crc32(&returnCode, 1);
-  Serial.write( ((CRC32_val >> 24) & 255) );
-  Serial.write( ((CRC32_val >> 16) & 255) );
-  Serial.write( ((CRC32_val >> 8) & 255) );
-  Serial.write( (CRC32_val & 255) );
+  const uint8_t CRC32_bytes[4] = { (uint8_t)(CRC32_val >> 24), (uint8_t)(CRC32_val >> 16), (uint8_t)(CRC32_val >> 8), (uint8_t)CRC32_val };
+  serialTx_queueBytes(serialTx, message, sizeof(message));
+  serialTx_queueBytes(serialTx, CRC32_bytes, sizeof(CRC32_bytes));
+  serialTx_service(serialTx);
 }
 
+/*
+Queues the payload to be sent: The length, the payload itself (Straight from serialPayload) and the CRC, which is
+added as each chunk of the payload is written. As much as the tx buffer can take is written now, the rest by
+continueSerialTransmission()
+*/
 void sendSerialPayload(void *payload, uint16_t payloadLength)
 {
-  //Start new transmission session
-  serialBytesTransmitted = 0; 
-  serialWriteInProgress = false;
-
-  uint16_t totalPayloadLength = payloadLength;
-  Serial.write(totalPayloadLength >> 8);
-  Serial.write(totalPayloadLength);
-
-  //Need to handle serial buffer being full. This is just for testing
-  serialPayloadLength = payloadLength; //Save the payload length in case we need to transmit in multiple steps
-  for(uint16_t i = 0; i < payloadLength; i++)
-  {
-    Serial.write(((uint8_t*)payload)[i]);
-    serialBytesTransmitted++;
-
-    if(Serial.availableForWrite() == 0)
-    {
-      //Serial buffer is full. Need to wait for it to be free
-      serialWriteInProgress = true;
-      break;
-    }
-  }
-
-  if(serialWriteInProgress == false)
-  {
-    //All data transmitted. Send the CRC
-    uint32_t CRC32_val = CRC32_serial.crc32((uint8_t*)payload, payloadLength);
-    Serial.write( ((CRC32_val >> 24) & 255) );
-    Serial.write( ((CRC32_val >> 16) & 255) );
-    Serial.write( ((CRC32_val >> 8) & 255) );
-    Serial.write( (CRC32_val & 255) );
-  }
+  //The payload is sent from serialPayload. Nothing else is received into it or queued until it has all been sent (See parseSerial())
+  //Some responses are built elsewhere (Eg. On the stack). These are all small
+  if(payload != serialPayload) { memmove(serialPayload, payload, payloadLength); }
+
+  const uint8_t header[2] = { highByte(payloadLength), lowByte(payloadLength) };
+  serialTx_queueBytes(serialTx, header, sizeof(header));
+  crcStream_begin(serialTxCRC);
+#if CRC_STREAM_SUSPENDABLE
+  serialTx_queueBuffer(serialTx, serialPayload, payloadLength, &serialTxCRC, NULL);
+#else
+  //The CRC hardware can't be left part way through until the rest is sent. It is quick enough to do it all now
+  crcStream_update(CRC32_serialTx, serialTxCRC, serialPayload, payloadLength);
+  serialTx_queueBuffer(serialTx, serialPayload, payloadLength, NULL, NULL);
+#endif
+  serialTx_queueCRC(serialTx, &serialTxCRC);
+  serialTx_service(serialTx);
 }
 
 void continueSerialTransmission(void)
 {
-  if(serialWriteInProgress == true)
-  {
-    serialWriteInProgress = false; //Assume we will reach the end of the serial buffer. If we run out of buffer, this will be set to true below
-    //Serial buffer is free. Continue sending the data
-    for(uint16_t i = serialBytesTransmitted; i < serialPayloadLength; i++)
-    {
-      Serial.write(serialPayload[i]);
-      serialBytesTransmitted++;
-
-      if(Serial.availableForWrite() == 0)
-      {
-        //Serial buffer is full. Need to wait for it to be free
-        serialWriteInProgress = true;
-        break;
-      }
-    }
-
-    if(serialWriteInProgress == false)
-    {
-      //All data transmitted. Send the CRC
-      uint32_t CRC32_val = CRC32_serial.crc32(serialPayload, serialPayloadLength);
-      Serial.write( ((CRC32_val >> 24) & 255) );
-      Serial.write( ((CRC32_val >> 16) & 255) );
-      Serial.write( ((CRC32_val >> 8) & 255) );
-      Serial.write( (CRC32_val & 255) );
-    }
-  }
+  serialTx_service(serialTx);
 }
 
 void processSerialCommand(void)
@@ -316,7 +298,8 @@ void processSerialCommand(void)
       currentStatus.compositeLogEnabled = false; //Safety first (Should never be required)
       toothLogSendInProgress = false;
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-      toothHistoryIndex = 0;
+      toothLog_reset(toothLog);
+      compactToothLogOffset = 0;
 
       //Disconnect the standard interrupt and add the logger version
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -333,7 +316,7 @@ void processSerialCommand(void)
 
       //Disconnect the logger interrupts and attach the normal ones
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-      attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+      attachInterrupt( digitalPinToInterrupt(pinTrigger), PRIMARY_TRIGGER_ISR, primaryTriggerEdge );
 
       detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
       attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );
@@ -347,11 +330,26 @@ void processSerialCommand(void)
       break;
     }
 
+    case 'i': // send the ISR execution time statistics. Command structure: "i", <reset>. If reset is 1, the min/max are cleared once sent
+    {
+#ifdef ISR_STATS
+      bool resetStats = (serialPayloadLength > 1U) && (serialPayload[1] == 1U);
+      serialPayload[0] = SERIAL_RC_OK;
+      uint16_t length = getISRStatsPayload(&serialPayload[1]);
+      sendSerialPayload(&serialPayload, length + 1U);
+      if(resetStats == true) { resetISRStats(); }
+#else
+      sendSerialReturnCode(SERIAL_RC_UKWN_ERR);
+#endif
+      break;
+    }
+
     case 'J': //Start the composite logger
       currentStatus.compositeLogEnabled = true;
       currentStatus.toothLogEnabled = false; //Safety first (Should never be required)
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-      toothHistoryIndex = 0;
+      toothLog_reset(toothLog);
+      compactToothLogOffset = 0;
 
       //Disconnect the standard interrupt and add the logger version
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -368,7 +366,7 @@ void processSerialCommand(void)
 
       //Disconnect the logger interrupts and attach the normal ones
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-      attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+      attachInterrupt( digitalPinToInterrupt(pinTrigger), PRIMARY_TRIGGER_ISR, primaryTriggerEdge );
 
       detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
       attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );
@@ -389,6 +387,20 @@ void processSerialCommand(void)
       break;
     }
 
+    case 'l': //Send the next buffer of the running tooth or composite logger, for tools that stream the log continuously. Command structure: "l", <format>
+      //The response is as for 'T', with the stream header (TOOTH_LOG_STREAM_HEADER_SIZE) between the return code and the entries.
+      //While the tool keeps up, the buffers follow on from each other with no missing entries.
+      //Format 1 (TOOTH_LOG_FORMAT_COMPACT) sends the entries in the compact format instead (See tooth_log.h and sendCompactToothLog())
+      if( (currentStatus.toothLogEnabled == false) && (currentStatus.compositeLogEnabled == false) ) { sendSerialReturnCode(SERIAL_RC_RANGE_ERR); }
+      else if( (serialPayloadLength > 1U) && (serialPayload[1] == TOOTH_LOG_FORMAT_COMPACT) ) { sendCompactToothLog(); }
+      else
+      {
+        toothLogStreaming = true;
+        if(currentStatus.toothLogEnabled == true) { sendToothLog(); }
+        else { sendCompositeLog(); }
+      }
+      break;
+
     case 'M':
     {
       //New write command
@@ -426,6 +438,15 @@ void processSerialCommand(void)
       break;
     }  
 
+    case 'o': //Send the realtime values that have changed since the last 'o' (See the delta format in output_channels.h). Command structure: "o", <all>. If all is 1, every value is sent
+    {
+      //The receiver must ask for every value for the first frame, and whenever it has missed one
+      bool allFields = (serialPayloadLength > 1U) && (serialPayload[1] == 1U);
+      uint16_t length = generateLiveValuesDelta(allFields);
+      sendSerialPayload(&serialPayload, length + 1U);
+      break;
+    }
+
     /*
     * New method for sending page values (MS command equivalent is 'r')
     */
@@ -459,7 +480,11 @@ void processSerialCommand(void)
 
     case 'Q': // send code version
     {
+#if defined(ISR_STATS)
+      char productString[] = { SERIAL_RC_OK, 's','p','e','e','d','u','i','n','o',' ','2','0','2','2','1','0','-','d','e','v','-','i','s','r'} ; //The realtime data includes the ISR execution times. Matches the ISR_STATS setting of the ini
+#else
       char productString[] = { SERIAL_RC_OK, 's','p','e','e','d','u','i','n','o',' ','2','0','2','2','1','0','-','d','e','v'} ; //Note no null terminator in array and statu variable at the start
+#endif
       //char productString[] = { SERIAL_RC_OK, 's','p','e','e','d','u','i','n','o',' ','2','0','2','2','0','7'} ; //Note no null terminator in array and statu variable at the start
       sendSerialPayload(&productString, sizeof(productString));
       break;
@@ -477,8 +502,12 @@ void processSerialCommand(void)
 
       if(cmd == 0x30) //Send output channels command 0x30 is 48dec
       {
-        generateLiveValues(offset, length);
-        sendSerialPayload(&serialPayload, (length + 1));
+        if(length >= SERIAL_BUFFER_SIZE) { sendSerialReturnCode(SERIAL_RC_RANGE_ERR); }
+        else
+        {
+          generateLiveValues(offset, length);
+          sendSerialPayload(&serialPayload, (length + 1));
+        }
       }
 #ifdef RTC_ENABLED
       else if(cmd == SD_RTC_PAGE) //Request to read SD card RTC
@@ -618,8 +647,9 @@ void processSerialCommand(void)
       
 
     case 'T': //Send 256 tooth log entries to Tuner Studios tooth logger
-      if(currentStatus.toothLogEnabled == true) { sendToothLog(0); } //Sends tooth log values as ints
-      else if (currentStatus.compositeLogEnabled == true) { sendCompositeLog(0); }
+      toothLogStreaming = false;
+      if(currentStatus.toothLogEnabled == true) { sendToothLog(); } //Sends tooth log values as ints
+      else if (currentStatus.compositeLogEnabled == true) { sendCompositeLog(); }
 
       break;
 
@@ -892,27 +922,49 @@ void processSerialCommand(void)
 }
 
 /** Send a status record back to tuning/logging SW.
- * This will "live" information from @ref currentStatus struct.
+ * This will "live" information from @ref currentStatus struct, refreshed into the realtime data block (See output_channels.h).
  * @param offset - Start field number
  * @param packetLength - Length of actual message (after possible ack/confirm headers)
  * E.g. tuning sw command 'A' (Send all values) will send data from field number 0, LOG_ENTRY_SIZE fields.
  */
 //void sendValues(int packetlength, byte portNum)
-void generateLiveValues(uint16_t offset, uint16_t packetLength)
-{  
+/* Refreshes the realtime data block for a request from the tuning/logging SW */
+static void refreshLiveValues(void)
+{
   if(requestCount == 0) { currentStatus.secl = 0; }
   requestCount++;
 
   currentStatus.spark ^= (-currentStatus.hasSync ^ currentStatus.spark) & (1U << BIT_SPARK_SYNC); //Set the sync bit of the Spark variable to match the hasSync variable
 
-  serialPayload[0] = SERIAL_RC_OK;
-  for(byte x=0; x<packetLength; x++)
-  {
-    serialPayload[x+1] = getTSLogEntry(offset+x); 
-  }
+  updateOutputChannels();
   // Reset any flags that are being used to trigger page refreshes
   BIT_CLEAR(currentStatus.status3, BIT_STATUS3_VSS_REFRESH);
+}
+
+void generateLiveValues(uint16_t offset, uint16_t packetLength)
+{  
+  refreshLiveValues();
 
+  serialPayload[0] = SERIAL_RC_OK;
+  //Anything past the end of the block is sent as 0
+  uint16_t copyLength = 0;
+  if(offset < sizeof(outputChannels)) { copyLength = sizeof(outputChannels) - offset; }
+  if(copyLength > packetLength) { copyLength = packetLength; }
+  memcpy(&serialPayload[1], (const byte *)&outputChannels + offset, copyLength);
+  memset(&serialPayload[1 + copyLength], 0, packetLength - copyLength);
+}
+
+/** Writes the return code and a frame of the realtime values that have changed since the last frame (The 'o' command,
+ * see the delta format in output_channels.h) to serialPayload.
+ * @param allFields Send every value rather than just those that have changed
+ * @return The length of the frame, after the return code
+ */
+uint16_t generateLiveValuesDelta(bool allFields)
+{
+  refreshLiveValues();
+
+  serialPayload[0] = SERIAL_RC_OK;
+  return encodeOutputChannelsDelta(outputChannels, deltaOutputChannels, allFields, &serialPayload[1]);
 }
 
 namespace 
@@ -940,159 +992,145 @@ namespace
 
 }
 
-/** 
- * 
+/* Writes an entry of the ready tooth log buffer as it is sent: The tooth time (Or for the composite log, the time of the
+edge) big endian, then for the composite log the status byte. Returns the number of bytes written */
+static uint8_t writeToothLogEntry(uint8_t *pDest, uint8_t entry)
+{
+  uint16_t slot = toothLog_readStart(toothLog) + entry;
+  uint32_t value = toothHistory[slot];
+  pDest[0] = (uint8_t)(value >> 24);
+  pDest[1] = (uint8_t)(value >> 16);
+  pDest[2] = (uint8_t)(value >> 8);
+  pDest[3] = (uint8_t)value;
+  //The status byte indicates the trigger edge, whether it was a pri/sec pulse and the sync status
+  if(toothLogSendEntrySize == COMPOSITE_LOG_ENTRY_SIZE) { pDest[4] = compositeLogHistory[slot]; }
+  return toothLogSendEntrySize;
+}
+
+static void queueNextToothLogChunk(void);
+
+/*
+Copies as many of the remaining entries of the log being sent as fit into serialPayload (After the first length bytes)
+and queues them. The next chunk is queued once this one has been written to the port, as its completion callback, so
+the log goes out through the transmit queue without the main loop waiting for it. The buffer is handed back to the
+logger once all of its entries have been copied, and the CRC follows the last chunk
 */
-void sendToothLog(uint8_t startOffset)
+static void queueToothLogChunk(uint16_t length)
 {
-  //We need TOOTH_LOG_SIZE number of records to send to TunerStudio. If there aren't that many in the buffer then we just return and wait for the next call
-  if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) //Sanity check. Flagging system means this should always be true
+  while( (toothLogSendOffset < TOOTH_LOG_SIZE) && ((length + toothLogSendEntrySize) <= sizeof(serialPayload)) )
   {
-    uint32_t CRC32_val = 0;
-    if(startOffset == 0)
-    {
-      //Transmit the size of the packet
-      uint16_t totalPayloadLength = (TOOTH_LOG_SIZE * 4) + 1; //Size of the tooth log (uint32_t values) plus the return code
-      Serial.write(totalPayloadLength >> 8);
-      Serial.write(totalPayloadLength);
+    length += writeToothLogEntry(&serialPayload[length], toothLogSendOffset);
+    toothLogSendOffset++;
+  }
+
+  serialTxCallback onComplete = queueNextToothLogChunk;
+  if(toothLogSendOffset >= TOOTH_LOG_SIZE)
+  {
+    toothLog_release(toothLog);
+    compactToothLogOffset = 0;
+    BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
+    onComplete = NULL;
+  }
 
-      //Begin new CRC hash
-      const uint8_t returnCode = SERIAL_RC_OK;
-      CRC32_val = CRC32_serial.crc32(&returnCode, 1, false);
+#if CRC_STREAM_SUSPENDABLE
+  serialTx_queueBuffer(serialTx, serialPayload, length, &serialTxCRC, onComplete);
+#else
+  serialTx_queueBuffer(serialTx, serialPayload, length, NULL, onComplete);
+#endif
+  if(onComplete == NULL) { serialTx_queueCRC(serialTx, &serialTxCRC); }
+}
 
-      //Send the return code
-      Serial.write(returnCode);
-    }
-    
-    for (int x = startOffset; x < TOOTH_LOG_SIZE; x++)
-    {
-      //Check whether the tx buffer still has space
-      if(Serial.availableForWrite() < 4) 
-      { 
-        //tx buffer is full. Store the current state so it can be resumed later
-        inProgressOffset = x;
-        toothLogSendInProgress = true;
-        legacySerial = false;
-        return;
-      }
+static void queueNextToothLogChunk(void)
+{
+  queueToothLogChunk(0);
+}
 
-      //Transmit the tooth time
-      uint32_t tempToothHistory = toothHistory[x];
-      uint8_t toothHistory_1 = ((tempToothHistory >> 24) & 255);
-      uint8_t toothHistory_2 = ((tempToothHistory >> 16) & 255);
-      uint8_t toothHistory_3 = ((tempToothHistory >> 8) & 255);
-      uint8_t toothHistory_4 = ((tempToothHistory) & 255);
-      Serial.write(toothHistory_1);
-      Serial.write(toothHistory_2);
-      Serial.write(toothHistory_3);
-      Serial.write(toothHistory_4);
-
-      //Update the CRC
-      CRC32_val = CRC32_serial.crc32_upd(&toothHistory_1, 1, false);
-      CRC32_val = CRC32_serial.crc32_upd(&toothHistory_2, 1, false);
-      CRC32_val = CRC32_serial.crc32_upd(&toothHistory_3, 1, false);
-      CRC32_val = CRC32_serial.crc32_upd(&toothHistory_4, 1, false);
-    }
-    BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-    cmdPending = false;
-    toothLogSendInProgress = false;
-    toothHistoryIndex = 0;
-
-    //Apply the CRC reflection
-    CRC32_val = ~CRC32_val;
-
-    //Send the CRC
-    Serial.write( ((CRC32_val >> 24) & 255) );
-    Serial.write( ((CRC32_val >> 16) & 255) );
-    Serial.write( ((CRC32_val >> 8) & 255) );
-    Serial.write( (CRC32_val & 255) );
+/*
+Queues the response to a tooth or composite log request: The length, return code, (In streaming mode) the stream
+header and the entries of the ready buffer, which are sent a chunk at a time through serialPayload
+*/
+static void sendToothLogPayload(uint8_t entrySize)
+{
+  toothLogSendEntrySize = entrySize;
+  toothLogSendOffset = 0;
+  uint16_t totalPayloadLength = (TOOTH_LOG_SIZE * entrySize) + 1U; //Size of the log plus the return code
+
+  serialPayload[0] = SERIAL_RC_OK;
+  uint16_t length = 1;
+  if(toothLogStreaming == true)
+  {
+    //The number of this buffer and the number of entries dropped so far, so that gaps in the stream can be detected
+    uint16_t dropped = toothLog.dropped; //Written by the trigger interrupt
+    serialPayload[1] = highByte(toothLog.sequence);
+    serialPayload[2] = lowByte(toothLog.sequence);
+    serialPayload[3] = highByte(dropped);
+    serialPayload[4] = lowByte(dropped);
+    length += TOOTH_LOG_STREAM_HEADER_SIZE;
+    totalPayloadLength += TOOTH_LOG_STREAM_HEADER_SIZE;
   }
-  else 
-  { 
-    sendSerialReturnCode(SERIAL_RC_BUSY_ERR);
-    cmdPending = false; 
-    toothLogSendInProgress = false;
-  } 
+
+  const uint8_t header[2] = { highByte(totalPayloadLength), lowByte(totalPayloadLength) };
+  serialTx_queueBytes(serialTx, header, sizeof(header));
+  crcStream_begin(serialTxCRC);
+#if !CRC_STREAM_SUSPENDABLE
+  //The CRC hardware can't be left part way through between the chunks, so the CRC of the whole log is worked out now
+  crcStream_update(CRC32_serialTx, serialTxCRC, serialPayload, length);
+  uint8_t entry[COMPOSITE_LOG_ENTRY_SIZE];
+  for (uint8_t x = 0; x < TOOTH_LOG_SIZE; x++) { crcStream_update(CRC32_serialTx, serialTxCRC, entry, writeToothLogEntry(entry, x)); }
+#endif
+  queueToothLogChunk(length);
+  serialTx_service(serialTx);
 }
 
-void sendCompositeLog(uint8_t startOffset)
+/** Sends the next part of the buffer of the running tooth or composite logger in the compact format (See tooth_log.h).
+ * The response is the return code, the stream header (TOOTH_LOG_STREAM_HEADER_SIZE), then as many entries as fit in serialPayload.
+ * The buffer is handed back to the logger once all of its entries have been sent
+*/
+void sendCompactToothLog(void)
 {
-  if ( (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) || (compositeLogSendInProgress == true) ) //Sanity check. Flagging system means this should always be true
+  if (toothLog_isReady(toothLog) == false)
   {
-    BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-    uint32_t CRC32_val = 0;
-    if(startOffset == 0)
-    { 
-      inProgressCompositeTime = 0; 
-
-      //Transmit the size of the packet
-      uint16_t totalPayloadLength = (TOOTH_LOG_SIZE * 5) + 1; //Size of the tooth log (1x uint32_t + 1x uint8_t values) plus the return code
-      Serial.write(totalPayloadLength >> 8);
-      Serial.write(totalPayloadLength);
-
-      //Begin new CRC hash
-      const uint8_t returnCode = SERIAL_RC_OK;
-      CRC32_val = CRC32_serial.crc32(&returnCode, 1, false);
-
-      //Send the return code
-      Serial.write(returnCode);
-    }
-    for (int x = startOffset; x < TOOTH_LOG_SIZE; x++)
-    {
-      //Check whether the tx buffer still has space
-      if(Serial.availableForWrite() < 5) 
-      { 
-        //tx buffer is full. Store the current state so it can be resumed later
-        inProgressOffset = x;
-        compositeLogSendInProgress = true;
-        legacySerial = false;
-        return;
-      }
+    sendSerialReturnCode(SERIAL_RC_BUSY_ERR);
+    return;
+  }
 
-      inProgressCompositeTime = toothHistory[x]; //This combined runtime (in us) that the log was going for by this record
-      uint8_t inProgressCompositeTime_1 = (inProgressCompositeTime >> 24) & 255;
-      uint8_t inProgressCompositeTime_2 = (inProgressCompositeTime >> 16) & 255;
-      uint8_t inProgressCompositeTime_3 = (inProgressCompositeTime >> 8) & 255;
-      uint8_t inProgressCompositeTime_4 = (inProgressCompositeTime) & 255;
-
-      //Transmit the tooth time
-      Serial.write(inProgressCompositeTime_1);
-      Serial.write(inProgressCompositeTime_2);
-      Serial.write(inProgressCompositeTime_3);
-      Serial.write(inProgressCompositeTime_4);
-
-      //Update the CRC
-      CRC32_val = CRC32_serial.crc32_upd(&inProgressCompositeTime_1, 1, false);
-      CRC32_val = CRC32_serial.crc32_upd(&inProgressCompositeTime_2, 1, false);
-      CRC32_val = CRC32_serial.crc32_upd(&inProgressCompositeTime_3, 1, false);
-      CRC32_val = CRC32_serial.crc32_upd(&inProgressCompositeTime_4, 1, false);
-
-      //The status byte (Indicates the trigger edge, whether it was a pri/sec pulse, the sync status)
-      uint8_t statusByte = compositeLogHistory[x];
-      Serial.write(statusByte);
-
-      //Update the CRC with the status byte
-      CRC32_val = CRC32_serial.crc32_upd(&statusByte, 1, false);
-    }
+  uint16_t readStart = toothLog_readStart(toothLog);
+  uint16_t dropped = toothLog.dropped; //Written by the trigger interrupt
+  serialPayload[0] = SERIAL_RC_OK;
+  serialPayload[1] = highByte(toothLog.sequence);
+  serialPayload[2] = lowByte(toothLog.sequence);
+  serialPayload[3] = highByte(dropped);
+  serialPayload[4] = lowByte(dropped);
+
+  const uint16_t headerLength = TOOTH_LOG_STREAM_HEADER_SIZE + 1U;
+  const volatile uint8_t *pFlags = (currentStatus.compositeLogEnabled == true) ? &compositeLogHistory[readStart] : NULL;
+  uint16_t length;
+  compactToothLogOffset += toothLog_encodeCompact(&toothHistory[readStart], pFlags, compactToothLogOffset, &serialPayload[headerLength], sizeof(serialPayload) - headerLength, length);
+  if(compactToothLogOffset >= TOOTH_LOG_SIZE)
+  {
+    compactToothLogOffset = 0;
+    toothLog_release(toothLog);
     BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-    toothHistoryIndex = 0;
-    cmdPending = false;
-    compositeLogSendInProgress = false;
-    inProgressCompositeTime = 0;
-
-    //Apply the CRC reflection
-    CRC32_val = ~CRC32_val;
-
-    //Send the CRC
-    Serial.write( ((CRC32_val >> 24) & 255) );
-    Serial.write( ((CRC32_val >> 16) & 255) );
-    Serial.write( ((CRC32_val >> 8) & 255) );
-    Serial.write( (CRC32_val & 255) );
   }
-  else 
-  { 
-    sendSerialReturnCode(SERIAL_RC_BUSY_ERR);
-    cmdPending = false; 
-    compositeLogSendInProgress = false;
-  } 
+  sendSerialPayload(&serialPayload, headerLength + length);
+}
+
+/** Sends the full buffer of the tooth logger (See tooth_log.h), through the transmit queue.
+ * In streaming mode (The 'l' command) the entries are preceded by the stream header.
+*/
+void sendToothLog(void)
+{
+  if (toothLog_isReady(toothLog) == true) { sendToothLogPayload(TOOTH_LOG_ENTRY_SIZE); }
+  else { sendSerialReturnCode(SERIAL_RC_BUSY_ERR); }
+  cmdPending = false;
+}
+
+/** Sends the full buffer of the composite logger (See tooth_log.h), through the transmit queue.
+ * In streaming mode (The 'l' command) the entries are preceded by the stream header.
+*/
+void sendCompositeLog(void)
+{
+  if (toothLog_isReady(toothLog) == true) { sendToothLogPayload(COMPOSITE_LOG_ENTRY_SIZE); }
+  else { sendSerialReturnCode(SERIAL_RC_BUSY_ERR); }
+  cmdPending = false;
 }
@@ -48,6 +48,16 @@
 #define SERIAL_OVERHEAD_SIZE (SERIAL_LEN_SIZE + SERIAL_CRC_LENGTH) //The overhead for each serial command is 6 bytes. 2 bytes for the length and 4 bytes for the CRC
 #define SERIAL_TIMEOUT      3000 //ms
 
+/** The header of each tooth/composite log buffer sent by the 'l' (Stream log) command:
+ * - The sequence number of the buffer (2 bytes). Increments by 1 for each buffer
+ * - The number of entries dropped since the logger was started (2 bytes), because there was no free buffer (See tooth_log.h)
+ */
+#define TOOTH_LOG_STREAM_HEADER_SIZE  4
+#define TOOTH_LOG_ENTRY_SIZE          4 ///< The size of each entry of a tooth log response (The tooth time)
+#define COMPOSITE_LOG_ENTRY_SIZE      5 ///< The size of each entry of a composite log response (The time and the status byte)
+#define TOOTH_LOG_FORMAT_RAW          0 ///< The 'l' command sends the entries as for 'T'
+#define TOOTH_LOG_FORMAT_COMPACT      1 ///< The 'l' command sends the entries in the compact format (See tooth_log.h)
+
 #ifdef RTC_ENABLED
   #define SD_FILE_TRANSMIT_BUFFER_SIZE (2048 + 3)
   extern uint16_t SDcurrentDirChunk;
@@ -69,7 +79,6 @@
 #define SERIAL_RC_RANGE_ERR 0x84 //Incorrect range. TS will not retry command
 #define SERIAL_RC_BUSY_ERR  0x85 //TS will wait and retry
 
-extern bool serialWriteInProgress;
 extern bool serialReceivePending; /**< Whether or not a serial request has only been partially received. This occurs when a the length has been received in the serial buffer, but not all of the payload or CRC has yet been received. */
 
 
@@ -79,9 +88,11 @@ void sendSerialReturnCode(byte returnCode);
 void sendSerialPayload(void* payload, uint16_t payloadLength);
 
 void generateLiveValues(uint16_t offset, uint16_t packetLength);
+uint16_t generateLiveValuesDelta(bool allFields);
 void flushRXbuffer(void);
-void sendToothLog(uint8_t startOffset);
-void sendCompositeLog(uint8_t startOffset);
+void sendToothLog(void);
+void sendCompositeLog(void);
+void sendCompactToothLog(void);
 void continueSerialTransmission(void);
 
 #endif // COMMS_H
@@ -190,7 +190,7 @@ void legacySerialCommand(void)
       currentStatus.toothLogEnabled = true;
       currentStatus.compositeLogEnabled = false; //Safety first (Should never be required)
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-      toothHistoryIndex = 0;
+      toothLog_reset(toothLog);
 
       //Disconnect the standard interrupt and add the logger version
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -207,7 +207,7 @@ void legacySerialCommand(void)
 
       //Disconnect the logger interrupts and attach the normal ones
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-      attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+      attachInterrupt( digitalPinToInterrupt(pinTrigger), PRIMARY_TRIGGER_ISR, primaryTriggerEdge );
 
       detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
       attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );
@@ -217,7 +217,7 @@ void legacySerialCommand(void)
       currentStatus.compositeLogEnabled = true;
       currentStatus.toothLogEnabled = false; //Safety first (Should never be required)
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-      toothHistoryIndex = 0;
+      toothLog_reset(toothLog);
 
       //Disconnect the standard interrupt and add the logger version
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
@@ -234,7 +234,7 @@ void legacySerialCommand(void)
 
       //Disconnect the logger interrupts and attach the normal ones
       detachInterrupt( digitalPinToInterrupt(pinTrigger) );
-      attachInterrupt( digitalPinToInterrupt(pinTrigger), triggerHandler, primaryTriggerEdge );
+      attachInterrupt( digitalPinToInterrupt(pinTrigger), PRIMARY_TRIGGER_ISR, primaryTriggerEdge );
 
       detachInterrupt( digitalPinToInterrupt(pinTrigger2) );
       attachInterrupt( digitalPinToInterrupt(pinTrigger2), triggerSecondaryHandler, secondaryTriggerEdge );
@@ -321,7 +321,11 @@ void legacySerialCommand(void)
 
     case 'Q': // send code version
       //Serial.print(F("speeduino 202207"));
+#if defined(ISR_STATS)
+      Serial.print(F("speeduino 202210-dev-isr")); //The realtime data includes the ISR execution times
+#else
       Serial.print(F("speeduino 202210-dev"));
+#endif
       break;
 
     case 'r': //New format for the optimised OutputChannels
@@ -627,6 +631,8 @@ void sendValues(uint16_t offset, uint16_t packetLength, byte cmd, byte portNum)
   }
 
   currentStatus.spark ^= (-currentStatus.hasSync ^ currentStatus.spark) & (1U << BIT_SPARK_SYNC); //Set the sync bit of the Spark variable to match the hasSync variable
+  //A send that is resumed (See serialInProgress) continues from the same values
+  if(serialInProgress == false) { updateOutputChannels(); }
 
   for(byte x=0; x<packetLength; x++)
   {
@@ -1158,8 +1164,9 @@ void receiveCalibration(byte tableID)
 void sendToothLog_legacy(byte startOffset)
 {
   //We need TOOTH_LOG_SIZE number of records to send to TunerStudio. If there aren't that many in the buffer then we just return and wait for the next call
-  if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) //Sanity check. Flagging system means this should always be true
+  if (toothLog_isReady(toothLog) == true) //Sanity check. Flagging system means this should always be true
   {
+      uint16_t readStart = toothLog_readStart(toothLog);
       for (int x = startOffset; x < TOOTH_LOG_SIZE; x++)
       {
         //Check whether the tx buffer still has space
@@ -1174,15 +1181,16 @@ void sendToothLog_legacy(byte startOffset)
         */
 
 
-        Serial.write(toothHistory[x] >> 24);
-        Serial.write(toothHistory[x] >> 16);
-        Serial.write(toothHistory[x] >> 8);
-        Serial.write(toothHistory[x]);
+        uint32_t toothTime = toothHistory[readStart + x];
+        Serial.write(toothTime >> 24);
+        Serial.write(toothTime >> 16);
+        Serial.write(toothTime >> 8);
+        Serial.write(toothTime);
       }
+      toothLog_release(toothLog);
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
       cmdPending = false;
       toothLogSendInProgress = false;
-      toothHistoryIndex = 0;
   }
   else 
   { 
@@ -1197,9 +1205,10 @@ void sendToothLog_legacy(byte startOffset)
 
 void sendCompositeLog_legacy(byte startOffset)
 {
-  if (BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) //Sanity check. Flagging system means this should always be true
+  if (toothLog_isReady(toothLog) == true) //Sanity check. Flagging system means this should always be true
   {
       if(startOffset == 0) { inProgressCompositeTime = 0; }
+      uint16_t readStart = toothLog_readStart(toothLog);
       for (int x = startOffset; x < TOOTH_LOG_SIZE; x++)
       {
         //Check whether the tx buffer still has space
@@ -1211,17 +1220,17 @@ void sendCompositeLog_legacy(byte startOffset)
           return;
         }
 
-        inProgressCompositeTime = toothHistory[x]; //This combined runtime (in us) that the log was going for by this record)
+        inProgressCompositeTime = toothHistory[readStart + x]; //This combined runtime (in us) that the log was going for by this record)
         
         Serial.write(inProgressCompositeTime >> 24);
         Serial.write(inProgressCompositeTime >> 16);
         Serial.write(inProgressCompositeTime >> 8);
         Serial.write(inProgressCompositeTime);
 
-        Serial.write(compositeLogHistory[x]); //The status byte (Indicates the trigger edge, whether it was a pri/sec pulse, the sync status)
+        Serial.write(compositeLogHistory[readStart + x]); //The status byte (Indicates the trigger edge, whether it was a pri/sec pulse, the sync status)
       }
+      toothLog_release(toothLog);
       BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY);
-      toothHistoryIndex = 0;
       cmdPending = false;
       compositeLogSendInProgress = false;
       inProgressCompositeTime = 0;
@@ -1,7 +1,9 @@
 #ifndef CRANKMATHS_H
 #define CRANKMATHS_H
 
-#define CRANKMATH_METHOD_INTERVAL_DEFAULT  0
+#include "crank_prediction.h"
+
+#define CRANKMATH_METHOD_INTERVAL_DEFAULT  0 //The last interval, or one of the predictive methods if selected by configPage10.crankPrediction
 #define CRANKMATH_METHOD_INTERVAL_REV      1
 #define CRANKMATH_METHOD_INTERVAL_TOOTH    2
 #define CRANKMATH_METHOD_ALPHA_BETA        3
@@ -20,9 +22,11 @@
 unsigned long angleToTime(int16_t angle, byte method);
 uint16_t timeToAngle(unsigned long time, byte method);
 void doCrankSpeedCalcs(void);
+void crankPredictionTooth(void);
 
 extern volatile uint16_t timePerDegree;
 extern volatile uint16_t timePerDegreex16;
 extern volatile unsigned long degreesPeruSx32768;
+extern crankPrediction crankPredictionState;
 
 #endif
\ No newline at end of file
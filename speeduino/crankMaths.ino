@@ -9,17 +9,42 @@ volatile uint16_t timePerDegreex16;
 volatile uint16_t degreesPeruSx2048;
 volatile unsigned long degreesPeruSx32768;
 
+crankPrediction crankPredictionState; ///< The state of the predictive methods. Written by the trigger interrupt (See crankPredictionTooth())
+
 //These are only part of the experimental 2nd deriv calcs
 byte deltaToothCount = 0; //The last tooth that was used with the deltaV calc
 int rpmDelta;
 
+/*
+* The method used for CRANKMATH_METHOD_INTERVAL_DEFAULT, which is set by configPage10.crankPrediction
+*/
+static inline byte crankMathDefaultMethod(void)
+{
+  if(configPage10.crankPrediction == CRANK_PREDICTION_ALPHA_BETA) { return CRANKMATH_METHOD_ALPHA_BETA; }
+  if(configPage10.crankPrediction == CRANK_PREDICTION_2ND_DERIV) { return CRANKMATH_METHOD_2ND_DERIVATIVE; }
+  return CRANKMATH_METHOD_INTERVAL_REV;
+}
+
+/*
+* Called from the primary trigger interrupt after each new tooth when one of the predictive methods is in use (See triggerPriPredicted()).
+* The prediction is only based on teeth of a known angle, so starts again after any other (Eg. The missing tooth)
+*/
+void crankPredictionTooth(void)
+{
+  if( (BIT_CHECK(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT)) && (triggerToothAngle > 0) && (toothLastToothTime > toothLastMinusOneToothTime) )
+  {
+    crankPrediction_tooth(crankPredictionState, (toothLastToothTime - toothLastMinusOneToothTime), triggerToothAngle, configPage10.crankPrediction);
+  }
+  else { crankPrediction_reset(crankPredictionState); }
+}
+
 /*
 * Converts a crank angle into a time from or since that angle occurred.
 * Positive angles are assumed to be in the future, negative angles in the past:
 *   * Future angle calculations will use a predicted speed/acceleration
 *   * Past angle calculations will use the known speed
 * 
-* Currently 4 methods are planned and/or available:
+* There are 4 methods available (CRANKMATH_METHOD_INTERVAL_DEFAULT is whichever is set by configPage10.crankPrediction):
 * 1) Last interval based on a full revolution
 * 2) Last interval based on the time between the last 2 teeth (Crank Pattern dependent)
 * 3) Closed loop error correction (Alpha-beta filter) 
@@ -28,6 +53,7 @@ int rpmDelta;
 unsigned long angleToTime(int16_t angle, byte method)
 {
     unsigned long returnTime = 0;
+    if(method == CRANKMATH_METHOD_INTERVAL_DEFAULT) { method = crankMathDefaultMethod(); }
 
     if( (method == CRANKMATH_METHOD_INTERVAL_REV) || (method == CRANKMATH_METHOD_INTERVAL_DEFAULT) )
     {
@@ -48,13 +74,25 @@ unsigned long angleToTime(int16_t angle, byte method)
         }
         else { returnTime = angleToTime(angle, CRANKMATH_METHOD_INTERVAL_REV); } //Safety check. This can occur if the last tooth seen was outside the normal pattern etc
     }
+    else if( (method == CRANKMATH_METHOD_ALPHA_BETA) || (method == CRANKMATH_METHOD_2ND_DERIVATIVE) )
+    {
+        //Predicts the speed and acceleration over the coming angle from the recent teeth. Both methods share the same prediction, they only differ in how the trigger interrupt updates it
+        //Past angles use the known speed, as do the first few teeth after the prediction was reset
+        noInterrupts();
+        crankPrediction prediction = crankPredictionState;
+        interrupts();
+
+        uint32_t predictedTime;
+        if( (angle >= 0) && crankPrediction_angleToTime(prediction, (uint16_t)angle, predictedTime) ) { returnTime = predictedTime; }
+        else { returnTime = angleToTime(angle, CRANKMATH_METHOD_INTERVAL_REV); }
+    }
 
     return returnTime;
 }
 
 /*
 * Convert a time (uS) into an angle at current speed
-* Currently 4 methods are planned and/or available:
+* There are 4 methods available (CRANKMATH_METHOD_INTERVAL_DEFAULT is whichever is set by configPage10.crankPrediction):
 * 1) Last interval based on a full revolution
 * 2) Last interval based on the time between the last 2 teeth (Crank Pattern dependent)
 * 3) Closed loop error correction (Alpha-beta filter) 
@@ -63,6 +101,7 @@ unsigned long angleToTime(int16_t angle, byte method)
 uint16_t timeToAngle(unsigned long time, byte method)
 {
     uint16_t returnAngle = 0;
+    if(method == CRANKMATH_METHOD_INTERVAL_DEFAULT) { method = crankMathDefaultMethod(); }
 
     if( (method == CRANKMATH_METHOD_INTERVAL_REV) || (method == CRANKMATH_METHOD_INTERVAL_DEFAULT) )
     {
@@ -84,15 +123,14 @@ uint16_t timeToAngle(unsigned long time, byte method)
         }
         else { returnAngle = timeToAngle(time, CRANKMATH_METHOD_INTERVAL_REV); } //Safety check. This can occur if the last tooth seen was outside the normal pattern etc
     }
-    else if (method == CRANKMATH_METHOD_ALPHA_BETA)
+    else if( (method == CRANKMATH_METHOD_ALPHA_BETA) || (method == CRANKMATH_METHOD_2ND_DERIVATIVE) )
     {
-        //Not yet implemented. Default to Rev
-        returnAngle = timeToAngle(time, CRANKMATH_METHOD_INTERVAL_REV);
-    }
-    else if (method == CRANKMATH_METHOD_2ND_DERIVATIVE)
-    {
-        //Not yet implemented. Default to Rev
-        returnAngle = timeToAngle(time, CRANKMATH_METHOD_INTERVAL_REV);
+        //As for angleToTime()
+        noInterrupts();
+        crankPrediction prediction = crankPredictionState;
+        interrupts();
+
+        if(crankPrediction_timeToAngle(prediction, time, returnAngle) == false) { returnAngle = timeToAngle(time, CRANKMATH_METHOD_INTERVAL_REV); }
     }
 
    return returnAngle;
@@ -106,7 +144,7 @@ void doCrankSpeedCalcs(void)
       //We use a 1st Deriv acceleration prediction, but only when there is an even spacing between primary sensor teeth
       //Any decoder that has uneven spacing has its triggerToothAngle set to 0
       //THIS IS CURRENTLY DISABLED FOR ALL DECODERS! It needs more work. 
-      if( SECOND_DERIV_ENABLED && (BIT_CHECK(decoderState, BIT_DECODER_2ND_DERIV)) && (toothHistoryIndex >= 3) && (currentStatus.RPM < 2000) ) //toothHistoryIndex must be greater than or equal to 3 as we need the last 3 entries. Currently this mode only runs below 3000 rpm
+      if( SECOND_DERIV_ENABLED && (BIT_CHECK(decoderState, BIT_DECODER_2ND_DERIV)) && (toothLog.index >= 3) && (currentStatus.RPM < 2000) ) //toothLog.index must be greater than or equal to 3 as we need the last 3 entries. Currently this mode only runs below 3000 rpm
       {
         //Only recalculate deltaV if the tooth has changed since last time (DeltaV stays the same until the next tooth)
         //if (deltaToothCount != toothCurrentCount)
@@ -129,6 +167,7 @@ void doCrankSpeedCalcs(void)
           }
           else { angle1 = triggerToothAngle; angle2 = triggerToothAngle; }
 
+          uint16_t toothHistoryIndex = ((uint16_t)toothLog.writeBuffer * TOOTH_LOG_SIZE) + toothLog.index;
           uint32_t toothDeltaV = (1000000L * angle2 / toothHistory[toothHistoryIndex]) - (1000000L * angle1 / toothHistory[toothHistoryIndex-1]);
           uint32_t toothDeltaT = toothHistory[toothHistoryIndex];
           //long timeToLastTooth = micros() - toothLastToothTime;
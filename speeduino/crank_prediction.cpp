@@ -0,0 +1,136 @@
+/*
+Speeduino - Simple engine management for the Arduino Mega 2560 platform
+Copyright (C) Josh Stewart
+A full copy of the license may be found in the projects root directory
+*/
+/** @file
+ * The predictive crank speed estimators. See crank_prediction.h
+ */
+#include "crank_prediction.h"
+
+/*
+value * multiplier / divisor, without value * multiplier overflowing.
+The multiplier and divisor are angles (At most 720), so the remainder part can't overflow either
+*/
+static inline int32_t mulDivAngle(int32_t value, uint16_t multiplier, uint16_t divisor)
+{
+  return ((value / divisor) * multiplier) + (((value % divisor) * multiplier) / divisor);
+}
+
+/** Forgets the teeth seen so far (Eg. After a tooth of unknown angle or a loss of sync) */
+void crankPrediction_reset(crankPrediction &state)
+{
+  state.teeth = 0;
+  state.trendx16 = 0;
+}
+
+/** Updates the estimate with the latest tooth gap. Called from the trigger interrupt.
+ * @param gap The time (uS) since the previous tooth
+ * @param toothAngle The crank angle between the previous tooth and this one
+ * @param method CRANK_PREDICTION_ALPHA_BETA or CRANK_PREDICTION_2ND_DERIV. The 2nd derivative is only taken as measured on
+ * teeth of CRANK_PREDICTION_COARSE_ANGLE or more, finer teeth are filtered as with CRANK_PREDICTION_ALPHA_BETA
+ */
+void crankPrediction_tooth(crankPrediction &state, uint32_t gap, uint16_t toothAngle, uint8_t method)
+{
+  if(gap > CRANK_PREDICTION_MAX_GAP) { gap = CRANK_PREDICTION_MAX_GAP; }
+  int32_t measured = (int32_t)(gap << 4);
+
+  if( (state.teeth > 0U) && (toothAngle != state.toothAngle) )
+  {
+    //Scale the estimate to the angle of this gap, so the 2 can be compared
+    state.gapx16 = (uint32_t)mulDivAngle((int32_t)state.gapx16, toothAngle, state.toothAngle);
+    state.trendx16 = mulDivAngle(state.trendx16, toothAngle, state.toothAngle);
+  }
+  state.toothAngle = toothAngle;
+
+  if(state.teeth == 0U)
+  {
+    state.gapx16 = (uint32_t)measured;
+    state.trendx16 = 0;
+  }
+  else if( (method == CRANK_PREDICTION_2ND_DERIV) && (toothAngle >= CRANK_PREDICTION_COARSE_ANGLE) )
+  {
+    state.trendx16 = measured - (int32_t)state.gapx16;
+    state.gapx16 = (uint32_t)measured;
+  }
+  else
+  {
+    int32_t predicted = (int32_t)state.gapx16 + state.trendx16;
+    if(predicted <= 0) { predicted = measured; state.trendx16 = 0; } //Decelerating to a stop. Start again from this gap
+    int32_t error = measured - predicted;
+    if(toothAngle >= CRANK_PREDICTION_COARSE_ANGLE)
+    {
+      state.gapx16 = (uint32_t)(predicted + (error >> CRANK_PREDICTION_ALPHA_SHIFT_COARSE));
+      state.trendx16 += (error >> CRANK_PREDICTION_BETA_SHIFT_COARSE);
+    }
+    else
+    {
+      state.gapx16 = (uint32_t)(predicted + (error >> CRANK_PREDICTION_ALPHA_SHIFT));
+      state.trendx16 += (error >> CRANK_PREDICTION_BETA_SHIFT);
+    }
+  }
+
+  if(state.teeth < CRANK_PREDICTION_MIN_TEETH) { state.teeth++; }
+}
+
+/*
+The time (uS x16) to travel the given angle past the latest tooth.
+The time per degree is taken to change steadily, by trendx16 over each toothAngle. Over the next gap it then averages
+(gapx16 + trendx16) / toothAngle, so at the latest tooth it is (gapx16 + trendx16/2) / toothAngle.
+Returns 0 if there is no valid prediction
+*/
+static int32_t predictedTimex16(const crankPrediction &state, uint16_t angle)
+{
+  if( (state.teeth < CRANK_PREDICTION_MIN_TEETH) || (state.toothAngle == 0U) ) { return 0; }
+  int32_t startGapx16 = (int32_t)state.gapx16 + (state.trendx16 >> 1);
+  if(startGapx16 <= 0) { return 0; }
+
+  int32_t steadyTime = mulDivAngle(startGapx16, angle, state.toothAngle);
+  int32_t accelTime = mulDivAngle(mulDivAngle(state.trendx16, angle, state.toothAngle), angle, state.toothAngle) >> 1;
+  int32_t time = steadyTime + accelTime;
+  return (time > 0) ? time : 0;
+}
+
+/** The predicted time (uS) for the crank to travel the given angle from the latest tooth.
+ * @return false if there have not yet been enough consecutive teeth for a prediction
+ */
+bool crankPrediction_angleToTime(const crankPrediction &state, uint16_t angle, uint32_t &time)
+{
+  int32_t timex16 = predictedTimex16(state, angle);
+  if(timex16 <= 0) { return false; }
+  time = (uint32_t)timex16 >> 4;
+  return true;
+}
+
+/** The predicted angle the crank will travel in the given time (uS) from the latest tooth.
+ * This inverts the angleToTime() prediction, starting from a first order estimate at the starting speed and refining
+ * it with a couple of Newton steps (Enough to be within a degree even with the large trends of low resolution wheels).
+ * @return false if there have not yet been enough consecutive teeth for a prediction
+ */
+bool crankPrediction_timeToAngle(const crankPrediction &state, uint32_t time, uint16_t &angle)
+{
+  if( (state.teeth < CRANK_PREDICTION_MIN_TEETH) || (state.toothAngle == 0U) || (time > CRANK_PREDICTION_MAX_GAP) ) { return false; }
+  int32_t startGapx16 = (int32_t)state.gapx16 + (state.trendx16 >> 1);
+  if(startGapx16 <= 0) { return false; }
+
+  //uS x16 per degree, rounded
+  int32_t degreeTimex16 = (startGapx16 + (int32_t)(state.toothAngle >> 1)) / (int32_t)state.toothAngle;
+  if(degreeTimex16 == 0) { degreeTimex16 = 1; }
+  int32_t timex16 = (int32_t)(time << 4);
+
+  int32_t estimate = (timex16 + (degreeTimex16 >> 1)) / degreeTimex16;
+  for(uint8_t step = 0; step < CRANK_PREDICTION_NEWTON_STEPS; step++)
+  {
+    if(estimate > 720) { estimate = 720; }
+    //The time per degree at the estimated angle
+    int32_t slope = degreeTimex16 + (mulDivAngle(state.trendx16, (uint16_t)estimate, state.toothAngle) / (int32_t)state.toothAngle);
+    if(slope <= 0) { break; }
+    int32_t error = predictedTimex16(state, (uint16_t)estimate) - timex16;
+    estimate = estimate - ((error + ((error >= 0) ? (slope >> 1) : -(slope >> 1))) / slope);
+    if(estimate < 0) { estimate = 0; }
+  }
+  if(estimate > 720) { estimate = 720; }
+
+  angle = (uint16_t)estimate;
+  return true;
+}
@@ -0,0 +1,50 @@
+/*
+The predictive crank speed estimators, used by angleToTime() and timeToAngle() (See crankMaths.ino) for
+CRANKMATH_METHOD_ALPHA_BETA and CRANKMATH_METHOD_2ND_DERIVATIVE.
+
+Both track the time taken by each tooth gap and how much that changes from one tooth to the next, which gives
+the expected speed and acceleration over the coming gap:
+- 2nd derivative: The last 2 gaps as measured. Responds immediately, but passes on any tooth to tooth jitter. The trend
+  is extrapolated over the whole prediction, so on fine wheels (Where that is many teeth) the jitter of a single pair of
+  gaps is amplified far beyond that of the last interval. It is therefore only used on teeth of
+  CRANK_PREDICTION_COARSE_ANGLE or more, and finer teeth have the trend filtered over several teeth by the alpha-beta filter
+- Alpha-beta: A filtered gap time and trend, corrected by a fraction of the error of each new gap against its
+  prediction (CRANK_PREDICTION_ALPHA_SHIFT and CRANK_PREDICTION_BETA_SHIFT). Smooths out jitter, at the cost of
+  settling over several teeth. On coarse wheels the trend changes too much from one tooth to the next for that, so
+  teeth of CRANK_PREDICTION_COARSE_ANGLE or more use much larger corrections
+
+The update is called from the trigger interrupt for every tooth, so only uses multiplies and shifts, except when the
+tooth angle changes (Eg. On a wheel with uneven teeth). The predictions are calculated in the main loop.
+*/
+#ifndef CRANK_PREDICTION_H
+#define CRANK_PREDICTION_H
+
+#include <Arduino.h>
+
+#define CRANK_PREDICTION_ALPHA_SHIFT  2 ///< The gap time is corrected by 1/4 of the prediction error
+#define CRANK_PREDICTION_BETA_SHIFT   4 ///< The trend is corrected by 1/16 of the prediction error
+#define CRANK_PREDICTION_COARSE_ANGLE 45 ///< Teeth at least this far apart use the _COARSE corrections below
+#define CRANK_PREDICTION_ALPHA_SHIFT_COARSE 0 ///< The gap time is taken as measured
+#define CRANK_PREDICTION_BETA_SHIFT_COARSE  1 ///< The trend is corrected by 1/2 of the prediction error
+#define CRANK_PREDICTION_MIN_TEETH    2 ///< The number of consecutive teeth needed before there is a prediction
+#define CRANK_PREDICTION_NEWTON_STEPS 2 ///< The number of refinements made by crankPrediction_timeToAngle()
+#define CRANK_PREDICTION_MAX_GAP      0x07FFFFFFUL //Longer gaps (uS) are clamped to this, so the x16 values can't overflow
+
+/** The values of configPage10.crankPrediction */
+#define CRANK_PREDICTION_OFF          0 ///< The last interval (CRANKMATH_METHOD_INTERVAL_REV)
+#define CRANK_PREDICTION_ALPHA_BETA   1
+#define CRANK_PREDICTION_2ND_DERIV    2
+
+struct crankPrediction {
+  uint32_t gapx16;     ///< The time (uS x16) of the latest gap, either as measured or filtered
+  int32_t trendx16;    ///< The change in gapx16 from one tooth to the next
+  uint16_t toothAngle; ///< The angle of the latest gap. gapx16 and trendx16 are for a gap of this angle
+  uint8_t teeth;       ///< The number of consecutive teeth seen, up to CRANK_PREDICTION_MIN_TEETH
+};
+
+void crankPrediction_reset(crankPrediction &state);
+void crankPrediction_tooth(crankPrediction &state, uint32_t gap, uint16_t toothAngle, uint8_t method);
+bool crankPrediction_angleToTime(const crankPrediction &state, uint16_t angle, uint32_t &time);
+bool crankPrediction_timeToAngle(const crankPrediction &state, uint32_t time, uint16_t &angle);
+
+#endif // CRANK_PREDICTION_H
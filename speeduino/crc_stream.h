@@ -0,0 +1,61 @@
+/*
+Calculates a CRC32 (As FastCRC32::crc32()) over data that arrives in several parts, such as a serial message that is
+sent a chunk at a time (See sendSerialPayload() in comms.cpp). Each part is added as it is sent, so the CRC is ready as
+soon as the last part is, rather than needing a second pass over the whole message.
+
+FastCRC32 uses the CRC hardware where the board has it (Teensy 3.x, see FastCRChw.cpp) and tables otherwise. The 2
+differ in how a CRC is continued:
+- Software: The running value is kept in the FastCRC32 instance, before the final inversion. So the first part must
+  not be inverted, and the result is inverted at the end
+- Hardware: The running value is kept in the CRC unit, and the final inversion is applied as it is read. It must be
+  configured by the first part
+The hardware unit is shared by every FastCRC32 instance, so a CRC can only be left part way through (Eg. Between main
+loop iterations) with the software version. CRC_STREAM_SUSPENDABLE tells whether that is possible.
+*/
+#ifndef CRC_STREAM_H
+#define CRC_STREAM_H
+
+#include <stdint.h>
+#include "src/FastCRC/FastCRC.h"
+
+#if CRC_SW
+  #define CRC_STREAM_SUSPENDABLE  1
+#else
+  #define CRC_STREAM_SUSPENDABLE  0
+#endif
+
+struct crcStream {
+  uint32_t value; ///< The CRC so far, as returned by FastCRC32. Only valid once started
+  bool started;   ///< Whether any data has been added
+};
+
+static inline void crcStream_begin(crcStream &stream)
+{
+  stream.started = false;
+}
+
+/** Adds the next part of the data. Parts of 0 length are allowed */
+static inline void crcStream_update(FastCRC32 &crc, crcStream &stream, const uint8_t *pData, uint16_t length)
+{
+  if(length == 0U) { return; }
+  if(stream.started == false)
+  {
+    //Starts a new CRC. The hardware applies the final inversion as the result is read, the software must not apply it yet
+    stream.value = crc.crc32(pData, length, (CRC_SW == 0));
+    stream.started = true;
+  }
+  else { stream.value = crc.crc32_upd(pData, length, false); }
+}
+
+/** The CRC of all of the data added since crcStream_begin() */
+static inline uint32_t crcStream_end(const crcStream &stream)
+{
+  if(stream.started == false) { return 0; } //The CRC of no data
+#if CRC_SW
+  return ~stream.value;
+#else
+  return stream.value;
+#endif
+}
+
+#endif // CRC_STREAM_H
@@ -2,6 +2,7 @@
 #define DECODERS_H
 
 #include "globals.h"
+#include "crank_prediction.h"
 
 #if defined(CORE_AVR)
   #define READ_PRI_TRIGGER() ((*triggerPri_pin_port & triggerPri_pin_mask) ? true : false)
@@ -35,10 +36,11 @@
 #define DECODER_DRZ400            21
 #define DECODER_NGC               22
 #define DECODER_VMAX              23
+#define DECODER_GENERIC           24
 
 #define BIT_DECODER_2ND_DERIV           0 //The use of the 2nd derivative calculation is limited to certain decoders. This is set to either true or false in each decoders setup routine
 #define BIT_DECODER_IS_SEQUENTIAL       1 //Whether or not the decoder supports sequential operation
-#define BIT_DECODER_UNUSED1             2 
+#define BIT_DECODER_PER_TOOTH_INJ       2 //Whether or not the decoder sets the fuel schedules from each tooth when per tooth injection is enabled (See checkPerToothInjection())
 #define BIT_DECODER_HAS_SECONDARY       3 //Whether or not the decoder supports fixed cranking timing
 #define BIT_DECODER_HAS_FIXED_CRANKING  4
 #define BIT_DECODER_VALID_TRIGGER       5 //Is set true when the last trigger (Primary or secondary) was valid (ie passed filters)
@@ -217,10 +219,27 @@ void triggerSec_NGC68(void);
 uint16_t getRPM_NGC(void);
 void triggerSetEndTeeth_NGC(void);
 
+void triggerSetup_Generic(void);
+void triggerPri_Generic(void);
+void triggerSec_Generic(void);
+uint16_t getRPM_Generic(void);
+int getCrankAngle_Generic(void);
+void triggerSetEndTeeth_Generic(void);
+
 extern void (*triggerHandler)(void); //Pointer for the trigger function (Gets pointed to the relevant decoder)
 extern void (*triggerSecondaryHandler)(void); //Pointer for the secondary trigger function (Gets pointed to the relevant decoder)
 extern void (*triggerTertiaryHandler)(void); //Pointer for the tertiary trigger function (Gets pointed to the relevant decoder)
 
+//The function attached to the primary trigger interrupt. When the ISR statistics are enabled, this times the decoder function.
+//When a predictive crank angle method is selected, the prediction is updated after the decoder function
+void triggerPriPredicted(void);
+#if defined(ISR_STATS)
+  void triggerPriISRStats(void);
+  #define PRIMARY_TRIGGER_ISR triggerPriISRStats
+#else
+  #define PRIMARY_TRIGGER_ISR ( (configPage10.crankPrediction != CRANK_PREDICTION_OFF) ? triggerPriPredicted : triggerHandler )
+#endif
+
 extern uint16_t (*getRPM)(void); //Pointer to the getRPM function (Gets pointed to the relevant decoder)
 extern int (*getCrankAngle)(void); //Pointer to the getCrank Angle function (Gets pointed to the relevant decoder)
 extern void (*triggerSetEndTeeth)(void); //Pointer to the triggerSetEndTeeth function of each decoder
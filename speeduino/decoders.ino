@@ -39,6 +39,8 @@ A full copy of the license may be found in the projects root directory
 #include "scheduler.h"
 #include "crankMaths.h"
 #include "timers.h"
+#include "isr_stats.h"
+#include "trigger_pattern.h"
 
 void (*triggerHandler)(void); ///Pointer for the trigger function (Gets pointed to the relevant decoder)
 void (*triggerSecondaryHandler)(void); ///Pointer for the secondary trigger function (Gets pointed to the relevant decoder)
@@ -110,48 +112,67 @@ int16_t toothAngles[24]; //An array for storing fixed tooth angles. Currently si
 
 /** Add tooth log entry to toothHistory (array).
  * Enabled by (either) currentStatus.toothLogEnabled and currentStatus.compositeLogEnabled.
+ * The entries go into the write buffer of @ref toothLog, so logging carries on while the other buffer is being sent (See tooth_log.h)
  * @param toothTime - Tooth Time
  * @param whichTooth - 0 for Primary (Crank), 1 for Secondary (Cam)
  */
 static inline void addToothLogEntry(unsigned long toothTime, bool whichTooth)
 {
-  if(BIT_CHECK(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY)) { return; }
   //High speed tooth logging history
   if( (currentStatus.toothLogEnabled == true) || (currentStatus.compositeLogEnabled == true) ) 
   {
-    bool valueLogged = false;
-    if(currentStatus.toothLogEnabled == true)
-    {
-      //Tooth log only works on the Crank tooth
-      if(whichTooth == TOOTH_CRANK)
-      { 
-        toothHistory[toothHistoryIndex] = toothTime; //Set the value in the log. 
-        valueLogged = true;
-      } 
-    }
-    else if(currentStatus.compositeLogEnabled == true)
-    {
-      compositeLogHistory[toothHistoryIndex] = 0;
-      if(READ_PRI_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_PRI); }
-      if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_SEC); }
-      if(whichTooth == TOOTH_CAM) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_TRIG); }
-      if(currentStatus.hasSync == true) { BIT_SET(compositeLogHistory[toothHistoryIndex], COMPOSITE_LOG_SYNC); }
-
-      toothHistory[toothHistoryIndex] = micros();
-      valueLogged = true;
-    }
+    //Tooth log only works on the Crank tooth
+    if( (currentStatus.toothLogEnabled == true) && (whichTooth != TOOTH_CRANK) ) { return; }
 
-    //If there has been a value logged above, update the indexes
-    if(valueLogged == true)
+    uint16_t slot = toothLog_reserve(toothLog);
+    if(slot != TOOTH_LOG_NO_SLOT)
     {
-     if(toothHistoryIndex < (TOOTH_LOG_SIZE-1)) { toothHistoryIndex++; BIT_CLEAR(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
-     else { BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
+      if(currentStatus.toothLogEnabled == true)
+      {
+        toothHistory[slot] = toothTime; //Set the value in the log. 
+      }
+      else
+      {
+        uint8_t compositeEntry = 0;
+        if(READ_PRI_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_PRI); }
+        if(READ_SEC_TRIGGER() == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_SEC); }
+        if(whichTooth == TOOTH_CAM) { BIT_SET(compositeEntry, COMPOSITE_LOG_TRIG); }
+        if(currentStatus.hasSync == true) { BIT_SET(compositeEntry, COMPOSITE_LOG_SYNC); }
+        compositeLogHistory[slot] = compositeEntry;
+
+        toothHistory[slot] = micros();
+      }
+      toothLog_commit(toothLog);
     }
 
-
+    //The buffer may also have been published by toothLog_reserve(), once the previous one was sent
+    if(toothLog_isReady(toothLog) == true) { BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
   } //Tooth/Composite log enabled
 }
 
+#if defined(ISR_STATS)
+/** Interrupt handler for primary trigger when the ISR statistics are enabled.
+* Records the time taken by the decoder function.
+*/
+void triggerPriISRStats(void)
+{
+  ISR_STATS_BEGIN();
+  if(configPage10.crankPrediction != CRANK_PREDICTION_OFF) { triggerPriPredicted(); }
+  else { triggerHandler(); }
+  ISR_STATS_END(ISR_STATS_TRIGGER);
+}
+#endif
+
+/** Interrupt handler for primary trigger when one of the predictive crank angle methods is selected (configPage10.crankPrediction).
+* Runs the decoder function, then passes any new tooth on to the prediction (See crankPredictionTooth()).
+*/
+void triggerPriPredicted(void)
+{
+  unsigned long lastToothTime = toothLastToothTime;
+  triggerHandler();
+  if(toothLastToothTime != lastToothTime) { crankPredictionTooth(); }
+}
+
 /** Interrupt handler for primary trigger.
 * This function is called on both the rising and falling edges of the primary trigger, when either the 
 * composite or tooth loggers are turned on. 
@@ -169,7 +190,7 @@ void loggerPrimaryISR(void)
   */
   if( ( (primaryTriggerEdge == RISING) && (READ_PRI_TRIGGER() == HIGH) ) || ( (primaryTriggerEdge == FALLING) && (READ_PRI_TRIGGER() == LOW) ) || (primaryTriggerEdge == CHANGE) )
   {
-    triggerHandler();
+    PRIMARY_TRIGGER_ISR();
     validEdge = true;
   }
   if( (currentStatus.toothLogEnabled == true) && (BIT_CHECK(decoderState, BIT_DECODER_VALID_TRIGGER)) )
@@ -289,54 +310,70 @@ static inline void checkPerToothTiming(int16_t crankAngle, uint16_t currentTooth
   {
     if ( (currentTooth == ignition1EndTooth) )
     {
-      if( (ignitionSchedule1.Status == RUNNING) ) { SET_COMPARE(IGN1_COMPARE, IGN1_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition1EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule1.Status == RUNNING) ) { SET_COMPARE(IGN1_COMPARE, limitIgnitionEndCompare(ignitionSchedule1, IGN1_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition1EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule1.endCompare = IGN1_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition1EndAngle - crankAngle) ) ) ); ignitionSchedule1.endScheduleSetByDecoder = true; }
     }
     else if ( (currentTooth == ignition2EndTooth) )
     {
-      if( (ignitionSchedule2.Status == RUNNING) ) { SET_COMPARE(IGN2_COMPARE, IGN2_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition2EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule2.Status == RUNNING) ) { SET_COMPARE(IGN2_COMPARE, limitIgnitionEndCompare(ignitionSchedule2, IGN2_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition2EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule2.endCompare = IGN2_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition2EndAngle - crankAngle) ) ) ); ignitionSchedule2.endScheduleSetByDecoder = true; }
     }
     else if ( (currentTooth == ignition3EndTooth) )
     {
-      if( (ignitionSchedule3.Status == RUNNING) ) { SET_COMPARE(IGN3_COMPARE, IGN3_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition3EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule3.Status == RUNNING) ) { SET_COMPARE(IGN3_COMPARE, limitIgnitionEndCompare(ignitionSchedule3, IGN3_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition3EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule3.endCompare = IGN3_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition3EndAngle - crankAngle) ) ) ); ignitionSchedule3.endScheduleSetByDecoder = true; }
     }
     else if ( (currentTooth == ignition4EndTooth) )
     {
-      if( (ignitionSchedule4.Status == RUNNING) ) { SET_COMPARE(IGN4_COMPARE, IGN4_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition4EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule4.Status == RUNNING) ) { SET_COMPARE(IGN4_COMPARE, limitIgnitionEndCompare(ignitionSchedule4, IGN4_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition4EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule4.endCompare = IGN4_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition4EndAngle - crankAngle) ) ) ); ignitionSchedule4.endScheduleSetByDecoder = true; }
     }
 #if IGN_CHANNELS >= 5
     else if ( (currentTooth == ignition5EndTooth) )
     {
-      if( (ignitionSchedule5.Status == RUNNING) ) { SET_COMPARE(IGN5_COMPARE, IGN5_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition5EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule5.Status == RUNNING) ) { SET_COMPARE(IGN5_COMPARE, limitIgnitionEndCompare(ignitionSchedule5, IGN5_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition5EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule5.endCompare = IGN5_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition5EndAngle - crankAngle) ) ) ); ignitionSchedule5.endScheduleSetByDecoder = true; }
     }
 #endif
 #if IGN_CHANNELS >= 6
     else if ( (currentTooth == ignition6EndTooth) )
     {
-      if( (ignitionSchedule6.Status == RUNNING) ) { SET_COMPARE(IGN6_COMPARE, IGN6_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition6EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule6.Status == RUNNING) ) { SET_COMPARE(IGN6_COMPARE, limitIgnitionEndCompare(ignitionSchedule6, IGN6_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition6EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule6.endCompare = IGN6_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition6EndAngle - crankAngle) ) ) ); ignitionSchedule6.endScheduleSetByDecoder = true; }
     }
 #endif
 #if IGN_CHANNELS >= 7
     else if ( (currentTooth == ignition7EndTooth) )
     {
-      if( (ignitionSchedule7.Status == RUNNING) ) { SET_COMPARE(IGN7_COMPARE, IGN7_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition7EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule7.Status == RUNNING) ) { SET_COMPARE(IGN7_COMPARE, limitIgnitionEndCompare(ignitionSchedule7, IGN7_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition7EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule7.endCompare = IGN7_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition7EndAngle - crankAngle) ) ) ); ignitionSchedule7.endScheduleSetByDecoder = true; }
     }
 #endif
 #if IGN_CHANNELS >= 8
     else if ( (currentTooth == ignition8EndTooth) )
     {
-      if( (ignitionSchedule8.Status == RUNNING) ) { SET_COMPARE(IGN8_COMPARE, IGN8_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition8EndAngle - crankAngle) ) ) ) ); }
+      if( (ignitionSchedule8.Status == RUNNING) ) { SET_COMPARE(IGN8_COMPARE, limitIgnitionEndCompare(ignitionSchedule8, IGN8_COUNTER, uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition8EndAngle - crankAngle) ) ) ) ) ); }
       else if(currentStatus.startRevolutions > MIN_CYCLES_FOR_ENDCOMPARE) { ignitionSchedule8.endCompare = IGN8_COUNTER + uS_TO_TIMER_COMPARE( fastDegreesToUS( ignitionLimits( (ignition8EndAngle - crankAngle) ) ) ); ignitionSchedule8.endScheduleSetByDecoder = true; }
     }
 #endif
   }
 }
+
+/**
+On decoders that support per tooth injection (BIT_DECODER_PER_TOOTH_INJ), this passes the angle of each tooth on to the fuel schedules, which are then set from the last tooth before each injection. See setFuelSchedulesFromTooth()
+@param crankAngle The angle of the current tooth in the same terms as getCrankAngle() (But without the time since the tooth being added)
+@param angleToNextTooth The number of crank degrees between the current tooth and the next one
+*/
+static inline void checkPerToothInjection(int16_t crankAngle, uint16_t angleToNextTooth)
+{
+  if( currentStatus.hasSync || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC) )
+  {
+    while(crankAngle >= CRANK_ANGLE_MAX_INJ) { crankAngle -= CRANK_ANGLE_MAX_INJ; }
+    if(crankAngle < 0) { crankAngle += CRANK_ANGLE_MAX_INJ; }
+    setFuelSchedulesFromTooth(crankAngle, angleToNextTooth);
+  }
+}
+
 /** @} */
   
 /** A (single) multi-tooth wheel with one of more 'missing' teeth.
@@ -366,6 +403,7 @@ void triggerSetup_missingTooth(void)
     triggerSecFilterTime = (1000000 / (MAX_RPM / 60));
   }
   BIT_CLEAR(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_PER_TOOTH_INJ);
   checkSyncToothCount = (configPage4.triggerTeeth) >> 1; //50% of the total teeth.
   toothLastMinusOneToothTime = 0;
   toothCurrentCount = 0;
@@ -488,6 +526,16 @@ void triggerPri_missingTooth(void)
         }
         else{ crankAngle = ignitionLimits(crankAngle); checkPerToothTiming(crankAngle, toothCurrentCount); }
       }
+
+      //Per tooth injection
+      if(configPage10.perToothInj == true)
+      {
+        int16_t crankAngle = ( (toothCurrentCount-1) * triggerToothAngle ) + configPage4.triggerAngle;
+        if( (revolutionOne == true) && (configPage4.TrigSpeed == CRANK_SPEED) ) { crankAngle += 360; }
+        //The last tooth before the gap is followed by the missing tooth/teeth
+        if(toothCurrentCount == triggerActualTeeth) { checkPerToothInjection(crankAngle, (triggerToothAngle * (configPage4.triggerMissingTeeth + 1))); }
+        else { checkPerToothInjection(crankAngle, triggerToothAngle); }
+      }
    }
 }
 
@@ -596,7 +644,7 @@ int getCrankAngle_missingTooth(void)
 
     lastCrankAngleCalc = micros();
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     else if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -827,7 +875,7 @@ int getCrankAngle_DualWheel(void)
     int crankAngle = ((tempToothCurrentCount - 1) * triggerToothAngle) + configPage4.triggerAngle; //Number of teeth that have passed since tooth 1, multiplied by the angle each tooth represents, plus the angle that tooth 1 is ATDC. This gives accuracy only to the nearest tooth.
 
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     //Sequential check (simply sets whether we're on the first or 2nd revolution of the cycle)
     if (tempRevolutionOne) { crankAngle += 360; }
@@ -1160,7 +1208,7 @@ int getCrankAngle_GM7X(void)
 
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -1729,7 +1777,7 @@ int getCrankAngle_24X(void)
 
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     //Sequential check (simply sets whether we're on the first or 2nd revolution of the cycle)
     if (tempRevolutionOne == 1) { crankAngle += 360; }
@@ -1841,7 +1889,7 @@ int getCrankAngle_Jeep2000(void)
 
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -1960,7 +2008,7 @@ int getCrankAngle_Audi135(void)
     
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     //Sequential check (simply sets whether we're on the first or 2nd revolution of the cycle)
     if (tempRevolutionOne) { crankAngle += 360; }
@@ -2061,7 +2109,7 @@ int getCrankAngle_HondaD17(void)
 
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -2286,7 +2334,7 @@ int getCrankAngle_Miata9905(void)
 
       //Estimate the number of degrees travelled since the last tooth}
       elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-      crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+      crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
       if (crankAngle >= 720) { crankAngle -= 720; }
       if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -2486,7 +2534,7 @@ int getCrankAngle_MazdaAU(void)
 
       //Estimate the number of degrees travelled since the last tooth}
       elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-      crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+      crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
       if (crankAngle >= 720) { crankAngle -= 720; }
       if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -2561,7 +2609,7 @@ int getCrankAngle_non360(void)
 
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -3206,7 +3254,7 @@ int getCrankAngle_Daihatsu(void)
 
     //Estimate the number of degrees travelled since the last tooth}
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -3344,7 +3392,7 @@ int getCrankAngle_Harley(void)
 
   //Estimate the number of degrees travelled since the last tooth}
   elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
   if (crankAngle >= 720) { crankAngle -= 720; }
   if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -3833,7 +3881,7 @@ int getCrankAngle_420a(void)
 
   //Estimate the number of degrees travelled since the last tooth}
   elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
   if (crankAngle >= 720) { crankAngle -= 720; }
   if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -4085,7 +4133,7 @@ int getCrankAngle_FordST170(void)
 
     lastCrankAngleCalc = micros();
     elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+    crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
     if (crankAngle >= 720) { crankAngle -= 720; }
     else if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -4744,7 +4792,7 @@ int getCrankAngle_Vmax(void)
   
   //Estimate the number of degrees travelled since the last tooth}
   elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
-  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_REV);
+  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
 
   if (crankAngle >= 720) { crankAngle -= 720; }
   if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
@@ -4759,3 +4807,233 @@ void triggerSetEndTeeth_Vmax(void)
 }
 
 /** @} */
+
+/** Generic, table driven decoder.
+* The wheel is described by the angle of each tooth (See trigger_pattern.h) rather than by code, and the pattern is selected with configPage10.genericTrigPattern.
+* Sync comes from matching the ratios of the tooth gaps against the pattern, so the cost of each tooth is bounded regardless of the pattern. Once synced, each tooth only has to match the next one in the pattern.
+* Crank wheels (360 degree patterns) can use a single cam tooth on the secondary input for sequential operation, which works as per the missing tooth decoder.
+* @defgroup dec_generic Generic table driven decoder
+* @{
+*/
+static triggerPatternState genericPatternState;
+
+void triggerSetup_Generic(void)
+{
+  const triggerPattern *pattern = getTriggerPattern(configPage10.genericTrigPattern);
+  //Finding the sync tooth is relatively slow, so is only done when the pattern changes. This is called again each time the engine stalls
+  if(genericPatternState.pattern != pattern) { triggerPattern_begin(genericPatternState, pattern); }
+  else { triggerPattern_reset(genericPatternState); }
+
+  triggerActualTeeth = pattern->teeth;
+  triggerToothAngle = genericPatternState.minGapAngle;
+  triggerFilterTime = ((unsigned long)genericPatternState.minGapAngle * 1000000UL) / (MAX_RPM / 60UL * 360UL); //The shortest time (in uS) between any 2 teeth at max RPM
+  triggerSecFilterTime = (1000000 / (MAX_RPM / 60));
+  if(pattern->cycleAngle == 720) { BIT_SET(decoderState, BIT_DECODER_IS_SEQUENTIAL); }
+  else { BIT_CLEAR(decoderState, BIT_DECODER_IS_SEQUENTIAL); }
+  BIT_CLEAR(decoderState, BIT_DECODER_2ND_DERIV);
+  BIT_SET(decoderState, BIT_DECODER_PER_TOOTH_INJ);
+  toothLastMinusOneToothTime = 0;
+  toothCurrentCount = 0;
+  secondaryToothCount = 0;
+  toothOneTime = 0;
+  toothOneMinusOneTime = 0;
+  MAX_STALL_TIME = (3333UL * genericPatternState.maxGapAngle); //Minimum 50rpm. (3333uS is the time per degree at 50rpm)
+}
+
+void triggerPri_Generic(void)
+{
+  curTime = micros();
+  curGap = curTime - toothLastToothTime;
+  if ( curGap >= triggerFilterTime )
+  {
+    BIT_SET(decoderState, BIT_DECODER_VALID_TRIGGER); //Flag this pulse as being a valid trigger (ie that it passed filters)
+    const triggerPattern *pattern = genericPatternState.pattern;
+
+    uint8_t match = TRIGGER_PATTERN_NO_SYNC;
+    if(toothLastToothTime > 0) { match = triggerPattern_tooth(genericPatternState, curGap); }
+    else { triggerPattern_reset(genericPatternState); } //First tooth after a stall, so there is no gap yet
+    toothLastMinusOneToothTime = toothLastToothTime;
+    toothLastToothTime = curTime;
+
+    if( (match == TRIGGER_PATTERN_SYNCED) || (match == TRIGGER_PATTERN_TOOTH) )
+    {
+      toothCurrentCount = genericPatternState.tooth + 1U;
+      triggerToothAngle = triggerPattern_gapAngle(pattern, genericPatternState.tooth); //The angle of the gap just measured, for the tooth based crank maths
+      BIT_SET(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
+
+      if( (toothCurrentCount == 1U) || (match == TRIGGER_PATTERN_SYNCED) )
+      {
+        if(toothCurrentCount == 1U)
+        {
+          if( (currentStatus.hasSync == true) || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC) )
+          {
+            currentStatus.startRevolutions++;
+            if(pattern->cycleAngle == 720) { currentStatus.startRevolutions++; } //Add an extra revolution count if the pattern is on the cam
+          }
+          else { currentStatus.startRevolutions = 0; }
+          revolutionOne = !revolutionOne;
+          toothOneMinusOneTime = toothOneTime;
+          toothOneTime = curTime;
+        }
+
+        //If either fuel or ignition is sequential, a crank pattern only has full sync once the cam tooth has been seen
+        if( ( (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) || (configPage2.injLayout == INJ_SEQUENTIAL) ) && (pattern->cycleAngle != 720) )
+        {
+          if(secondaryToothCount > 0)
+          {
+            currentStatus.hasSync = true;
+            BIT_CLEAR(currentStatus.status3, BIT_STATUS3_HALFSYNC);
+            secondaryToothCount = 0; //Reset the secondary tooth counter to prevent it overflowing
+          }
+          else if(currentStatus.hasSync != true) { BIT_SET(currentStatus.status3, BIT_STATUS3_HALFSYNC); }
+        }
+        else { currentStatus.hasSync = true; BIT_CLEAR(currentStatus.status3, BIT_STATUS3_HALFSYNC); }
+      }
+
+      //The filter is based on the expected length of the next gap, which may not be the same as this one
+      setFilter( triggerPattern_nextGap(genericPatternState, curGap) );
+
+      int16_t crankAngle = triggerPattern_toothAngle(pattern, genericPatternState.tooth) + configPage4.triggerAngle;
+      bool isSecondRevolution = (revolutionOne == true) && (pattern->cycleAngle == 360);
+      if( (configPage2.perToothIgn == true) && (!BIT_CHECK(currentStatus.engine, BIT_ENGINE_CRANK)) )
+      {
+        //The second revolution is numbered on from the nominal number of teeth, as per the missing tooth decoder
+        if( (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) && (isSecondRevolution == true) ) { checkPerToothTiming(ignitionLimits(crankAngle + 360), toothCurrentCount + (360U / genericPatternState.minGapAngle)); }
+        else { checkPerToothTiming(ignitionLimits(crankAngle), toothCurrentCount); }
+      }
+
+      if(isSecondRevolution == true) { crankAngle += 360; }
+      if(configPage10.perToothInj == true) { checkPerToothInjection(crankAngle, triggerPattern_gapAngle(pattern, triggerPattern_nextTooth(pattern, genericPatternState.tooth))); }
+    }
+    else
+    {
+      if( (match == TRIGGER_PATTERN_SYNC_LOST) && ( (currentStatus.hasSync == true) || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC) ) )
+      {
+        currentStatus.hasSync = false;
+        BIT_CLEAR(currentStatus.status3, BIT_STATUS3_HALFSYNC);
+        currentStatus.syncLossCounter++;
+      }
+      toothCurrentCount = 0;
+      triggerFilterTime = 0; //The length of the next gap isn't known without sync
+      BIT_CLEAR(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
+    }
+  }
+}
+
+void triggerSec_Generic(void)
+{
+  curTime2 = micros();
+  curGap2 = curTime2 - toothLastSecToothTime;
+
+  //Safety check for initial startup
+  if( (toothLastSecToothTime == 0) )
+  {
+    curGap2 = 0;
+    toothLastSecToothTime = curTime2;
+  }
+
+  if ( curGap2 >= triggerSecFilterTime )
+  {
+    revolutionOne = 1; //Sequential revolution reset
+    secondaryToothCount++;
+    triggerSecFilterTime = curGap2 >> 1; //Next secondary filter is half the current gap
+    toothLastSecToothTime = curTime2;
+  }
+}
+
+uint16_t getRPM_Generic(void)
+{
+  uint16_t tempRPM = 0;
+  const uint16_t cycleAngle = genericPatternState.pattern->cycleAngle;
+  if( currentStatus.RPM < currentStatus.crankRPM )
+  {
+    //The teeth aren't evenly spaced, so the per tooth RPM is based on the angle of the last gap
+    if( (currentStatus.startRevolutions >= configPage4.StgCycles) && ((currentStatus.hasSync == true) || BIT_CHECK(currentStatus.status3, BIT_STATUS3_HALFSYNC)) )
+    {
+      noInterrupts();
+      unsigned long toothTime = toothLastToothTime - toothLastMinusOneToothTime;
+      uint16_t toothAngle = triggerToothAngle;
+      bool toothAngleCorrect = BIT_CHECK(decoderState, BIT_DECODER_TOOTH_ANG_CORRECT);
+      interrupts();
+      if( (toothLastMinusOneToothTime > 0) && (toothAngleCorrect == true) && (toothAngle > 0) )
+      {
+        revolutionTime = (toothTime * 360UL) / toothAngle;
+        tempRPM = (US_IN_MINUTE / revolutionTime);
+        if( tempRPM >= MAX_RPM ) { tempRPM = currentStatus.RPM; } //Sanity check
+      }
+    }
+  }
+  else { tempRPM = stdGetRPM(cycleAngle); }
+  return tempRPM;
+}
+
+int getCrankAngle_Generic(void)
+{
+  //Grab some variables that are used in the trigger code and assign them to temp variables.
+  noInterrupts();
+  uint16_t tempToothCurrentCount = toothCurrentCount;
+  bool tempRevolutionOne = revolutionOne;
+  unsigned long tempToothLastToothTime = toothLastToothTime;
+  interrupts();
+
+  const triggerPattern *pattern = genericPatternState.pattern;
+  int crankAngle = configPage4.triggerAngle;
+  if(tempToothCurrentCount > 0) { crankAngle += triggerPattern_toothAngle(pattern, tempToothCurrentCount - 1U); } //The angle of the last tooth. This gives accuracy only to the nearest tooth
+  if( (tempRevolutionOne == true) && (pattern->cycleAngle == 360) ) { crankAngle += 360; }
+
+  lastCrankAngleCalc = micros();
+  elapsedTime = (lastCrankAngleCalc - tempToothLastToothTime);
+  crankAngle += timeToAngle(elapsedTime, CRANKMATH_METHOD_INTERVAL_DEFAULT);
+
+  if (crankAngle >= 720) { crankAngle -= 720; }
+  else if (crankAngle > CRANK_ANGLE_MAX) { crankAngle -= CRANK_ANGLE_MAX; }
+  if (crankAngle < 0) { crankAngle += CRANK_ANGLE_MAX; }
+
+  return crankAngle;
+}
+
+/*
+Returns the tooth number (As passed to checkPerToothTiming()) that the spark at endAngle is refreshed from. This is the last tooth at least
+2 of the shortest tooth gaps before the end angle, which for an evenly spaced missing tooth wheel is the same tooth as triggerSetEndTeeth_missingTooth() uses
+*/
+static uint16_t genericEndTooth(int endAngle)
+{
+  const triggerPattern *pattern = genericPatternState.pattern;
+  int cycleAngle = pattern->cycleAngle;
+  if( (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) && (cycleAngle == 360) ) { cycleAngle = 720; }
+
+  int angle = endAngle - configPage4.triggerAngle - (2 * (int)genericPatternState.minGapAngle);
+  while(angle < 0) { angle += cycleAngle; }
+  while(angle >= cycleAngle) { angle -= cycleAngle; }
+
+  uint16_t toothAdder = 0;
+  if(angle >= (int)pattern->cycleAngle)
+  {
+    angle -= pattern->cycleAngle;
+    toothAdder = (360U / genericPatternState.minGapAngle);
+  }
+  return triggerPattern_toothAtAngle(pattern, angle) + 1U + toothAdder;
+}
+
+void triggerSetEndTeeth_Generic(void)
+{
+  ignition1EndTooth = genericEndTooth(ignition1EndAngle);
+  ignition2EndTooth = genericEndTooth(ignition2EndAngle);
+  ignition3EndTooth = genericEndTooth(ignition3EndAngle);
+  ignition4EndTooth = genericEndTooth(ignition4EndAngle);
+#if IGN_CHANNELS >= 5
+  ignition5EndTooth = genericEndTooth(ignition5EndAngle);
+#endif
+#if IGN_CHANNELS >= 6
+  ignition6EndTooth = genericEndTooth(ignition6EndAngle);
+#endif
+#if IGN_CHANNELS >= 7
+  ignition7EndTooth = genericEndTooth(ignition7EndAngle);
+#endif
+#if IGN_CHANNELS >= 8
+  ignition8EndTooth = genericEndTooth(ignition8EndAngle);
+#endif
+
+  lastToothCalcAdvance = currentStatus.advance;
+}
+/** @} */
@@ -29,6 +29,7 @@
 #include "table3d.h"
 #include <assert.h>
 #include "logger.h"
+#include "tooth_log.h"
 #include "src/FastCRC/FastCRC.h"
 
 #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__)
@@ -143,6 +144,15 @@
   #define CORE_SAM
   #define INJ_CHANNELS 8
   #define IGN_CHANNELS 8
+#elif defined(NATIVE_BOARD)
+  //Host (Linux) build of the complete firmware. Pin numbering follows the Mega 2560
+  #define BOARD_MAX_DIGITAL_PINS 54 //digital pins +1
+  #define BOARD_MAX_IO_PINS 70 //digital pins + analog channels + 1
+  #define BOARD_MAX_ADC_PINS  15 //Number of analog pins
+  #define BOARD_H "board_native.h"
+  #define CORE_NATIVE
+  #define INJ_CHANNELS 8
+  #define IGN_CHANNELS 8
 #else
   #error Incorrect board selected. Please select the correct board (Usually Mega 2560) and upload again
 #endif
@@ -242,12 +252,6 @@
 #define VALID_MAP_MAX 1022 //The largest ADC value that is valid for the MAP sensor
 #define VALID_MAP_MIN 2 //The smallest ADC value that is valid for the MAP sensor
 
-#ifndef UNIT_TEST 
-#define TOOTH_LOG_SIZE      127
-#else
-#define TOOTH_LOG_SIZE      1
-#endif
-
 #define O2_CALIBRATION_PAGE   2
 #define IAT_CALIBRATION_PAGE  1
 #define CLT_CALIBRATION_PAGE  0
@@ -475,34 +479,37 @@ extern trimTable3d trim6Table; //6x6 Fuel trim 6 map
 extern trimTable3d trim7Table; //6x6 Fuel trim 7 map
 extern trimTable3d trim8Table; //6x6 Fuel trim 8 map
 
+extern struct table3DLookupContext fuelLookupContext; //Fuel load & RPM position on the 16x16 fuel map axes. Shared by the 16x16 maps with the same axes
+extern struct table3DLookupContext trimLookupContext; //Fuel load & RPM position on the fuel trim 1 map axes. Shared by the fuel trim maps with the same axes
+
 extern struct table3d4RpmLoad dwellTable; //4x4 Dwell map
-extern struct table2D taeTable; //4 bin TPS Acceleration Enrichment map (2D)
-extern struct table2D maeTable;
-extern struct table2D WUETable; //10 bin Warm Up Enrichment map (2D)
-extern struct table2D ASETable; //4 bin After Start Enrichment map (2D)
-extern struct table2D ASECountTable; //4 bin After Start duration map (2D)
-extern struct table2D PrimingPulseTable; //4 bin Priming pulsewidth map (2D)
-extern struct table2D crankingEnrichTable; //4 bin cranking Enrichment map (2D)
-extern struct table2D dwellVCorrectionTable; //6 bin dwell voltage correction (2D)
-extern struct table2D injectorVCorrectionTable; //6 bin injector voltage correction (2D)
-extern struct table2D injectorAngleTable; //4 bin injector timing curve (2D)
-extern struct table2D IATDensityCorrectionTable; //9 bin inlet air temperature density correction (2D)
-extern struct table2D baroFuelTable; //8 bin baro correction curve (2D)
-extern struct table2D IATRetardTable; //6 bin ignition adjustment based on inlet air temperature  (2D)
-extern struct table2D idleTargetTable; //10 bin idle target table for idle timing (2D)
-extern struct table2D idleAdvanceTable; //6 bin idle advance adjustment table based on RPM difference  (2D)
-extern struct table2D CLTAdvanceTable; //6 bin ignition adjustment based on coolant temperature  (2D)
-extern struct table2D rotarySplitTable; //8 bin ignition split curve for rotary leading/trailing  (2D)
-extern struct table2D flexFuelTable;  //6 bin flex fuel correction table for fuel adjustments (2D)
-extern struct table2D flexAdvTable;   //6 bin flex fuel correction table for timing advance (2D)
-extern struct table2D flexBoostTable; //6 bin flex fuel correction table for boost adjustments (2D)
-extern struct table2D fuelTempTable;  //6 bin fuel temperature correction table for fuel adjustments (2D)
-extern struct table2D knockWindowStartTable;
-extern struct table2D knockWindowDurationTable;
-extern struct table2D oilPressureProtectTable;
-extern struct table2D wmiAdvTable; //6 bin wmi correction table for timing advance (2D)
-extern struct table2D coolantProtectTable; //6 bin coolant temperature protection table for engine protection (2D)
-extern struct table2D fanPWMTable;
+extern table2D_u8_u8 taeTable; //4 bin TPS Acceleration Enrichment map (2D)
+extern table2D_u8_u8 maeTable;
+extern table2D_u8_u8 WUETable; //10 bin Warm Up Enrichment map (2D)
+extern table2D_u8_u8 ASETable; //4 bin After Start Enrichment map (2D)
+extern table2D_u8_u8 ASECountTable; //4 bin After Start duration map (2D)
+extern table2D_u8_u8 PrimingPulseTable; //4 bin Priming pulsewidth map (2D)
+extern table2D_u8_u8 crankingEnrichTable; //4 bin cranking Enrichment map (2D)
+extern table2D_u8_u8 dwellVCorrectionTable; //6 bin dwell voltage correction (2D)
+extern table2D_u8_u8 injectorVCorrectionTable; //6 bin injector voltage correction (2D)
+extern table2D_u8_u16 injectorAngleTable; //4 bin injector timing curve (2D)
+extern table2D_u8_u8 IATDensityCorrectionTable; //9 bin inlet air temperature density correction (2D)
+extern table2D_u8_u8 baroFuelTable; //8 bin baro correction curve (2D)
+extern table2D_u8_u8 IATRetardTable; //6 bin ignition adjustment based on inlet air temperature  (2D)
+extern table2D_u8_u8 idleTargetTable; //10 bin idle target table for idle timing (2D)
+extern table2D_u8_u8 idleAdvanceTable; //6 bin idle advance adjustment table based on RPM difference  (2D)
+extern table2D_u8_u8 CLTAdvanceTable; //6 bin ignition adjustment based on coolant temperature  (2D)
+extern table2D_u8_u8 rotarySplitTable; //8 bin ignition split curve for rotary leading/trailing  (2D)
+extern table2D_u8_u8 flexFuelTable;  //6 bin flex fuel correction table for fuel adjustments (2D)
+extern table2D_u8_u8 flexAdvTable;   //6 bin flex fuel correction table for timing advance (2D)
+extern table2D_u8_s16 flexBoostTable; //6 bin flex fuel correction table for boost adjustments (2D)
+extern table2D_u8_u8 fuelTempTable;  //6 bin fuel temperature correction table for fuel adjustments (2D)
+extern table2D_u8_u8 knockWindowStartTable;
+extern table2D_u8_u8 knockWindowDurationTable;
+extern table2D_u8_u8 oilPressureProtectTable;
+extern table2D_u8_u8 wmiAdvTable; //6 bin wmi correction table for timing advance (2D)
+extern table2D_u8_u8 coolantProtectTable; //6 bin coolant temperature protection table for engine protection (2D)
+extern table2D_u8_u8 fanPWMTable;
 
 //These are for the direct port manipulation of the injectors, coils and aux outputs
 extern volatile PORT_TYPE *inj1_pin_port;
@@ -587,11 +594,11 @@ extern volatile unsigned long ms_counter; //A counter that increments once per m
 extern uint16_t fixedCrankingOverride;
 extern bool clutchTrigger;
 extern bool previousClutchTrigger;
-extern volatile uint32_t toothHistory[TOOTH_LOG_SIZE];
-extern volatile uint8_t compositeLogHistory[TOOTH_LOG_SIZE];
+extern volatile uint32_t toothHistory[TOOTH_LOG_BUFFERS * TOOTH_LOG_SIZE];
+extern volatile uint8_t compositeLogHistory[TOOTH_LOG_BUFFERS * TOOTH_LOG_SIZE];
+extern toothLogRing toothLog;
 extern volatile bool fpPrimed; //Tracks whether or not the fuel pump priming has been completed yet
 extern volatile bool injPrimed; //Tracks whether or not the injector priming has been completed yet
-extern volatile unsigned int toothHistoryIndex;
 extern unsigned long currentLoopTime; /**< The time (in uS) that the current mainloop started */
 extern volatile uint16_t ignitionCount; /**< The count of ignition events that have taken place since the engine started */
 //The below shouldn't be needed and probably should be cleaned up, but the Atmel SAM (ARM) boards use a specific type for the trigger edge values rather than a simple byte/int
@@ -1371,7 +1378,10 @@ struct config10 {
 
   byte oilPressureProtTime;
 
-  byte unused11_191_191; //Bytes 187-191
+  byte perToothInj : 1; ///< Set the fuel schedules from the trigger teeth rather than from the main loop (See setFuelSchedulesFromTooth() in scheduler.ino)
+  byte genericTrigPattern : 3; ///< The pattern used by the generic decoder (DECODER_GENERIC). See getTriggerPattern() in trigger_pattern.cpp
+  byte crankPrediction : 2; ///< The method used to predict the crank speed between teeth (CRANK_PREDICTION_*). See crank_prediction.h
+  byte unused11_191 : 2;
 
 #if defined(CORE_AVR)
   };
@@ -1593,9 +1603,9 @@ extern uint16_t iatCalibration_bins[32];
 extern uint16_t iatCalibration_values[32];
 extern uint16_t o2Calibration_bins[32];
 extern uint8_t  o2Calibration_values[32]; // Note 8-bit values
-extern struct table2D cltCalibrationTable; /**< A 32 bin array containing the coolant temperature sensor calibration values */
-extern struct table2D iatCalibrationTable; /**< A 32 bin array containing the inlet air temperature sensor calibration values */
-extern struct table2D o2CalibrationTable; /**< A 32 bin array containing the O2 sensor calibration values */
+extern table2D_u16_u16 cltCalibrationTable; /**< A 32 bin array containing the coolant temperature sensor calibration values */
+extern table2D_u16_u16 iatCalibrationTable; /**< A 32 bin array containing the inlet air temperature sensor calibration values */
+extern table2D_u16_u8 o2CalibrationTable; /**< A 32 bin array containing the O2 sensor calibration values */
 
 bool pinIsOutput(byte pin);
 bool pinIsUsed(byte pin);
@@ -35,11 +35,11 @@ struct StepperIdle
   byte moreAirDirection;
 };
 
-struct table2D iacPWMTable;
-struct table2D iacStepTable;
+table2D_u8_u8 iacPWMTable;
+table2D_u8_u8 iacStepTable;
 //Open loop tables specifically for cranking
-struct table2D iacCrankStepsTable;
-struct table2D iacCrankDutyTable;
+table2D_u8_u8 iacCrankStepsTable;
+table2D_u8_u8 iacCrankDutyTable;
 
 struct StepperIdle idleStepper;
 bool idleOn; //Simply tracks whether idle was on last time around
@@ -18,6 +18,7 @@
 #include "idle.h"
 #include "table2d.h"
 #include "acc_mc33810.h"
+#include "isr_stats.h"
 #include BOARD_H //Note that this is not a real file, it is defined in globals.h. 
 #include EEPROM_LIB_H
 #ifdef SD_LOGGING
@@ -103,6 +104,9 @@ void initialiseAll(void)
     
     initBoard(); //This calls the current individual boards init function. See the board_xxx.ino files for these.
     initialiseTimers();
+  #ifdef ISR_STATS
+    initialiseISRStats();
+  #endif
   #ifdef SD_LOGGING
     initRTC();
     initSD();
@@ -114,164 +118,104 @@ void initialiseAll(void)
     #endif
 
     //Repoint the 2D table structs to the config pages that were just loaded
-    taeTable.valueSize = SIZE_BYTE; //Set this table to use byte values
-    taeTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     taeTable.xSize = 4;
     taeTable.values = configPage4.taeValues;
     taeTable.axisX = configPage4.taeBins;
-    maeTable.valueSize = SIZE_BYTE; //Set this table to use byte values
-    maeTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     maeTable.xSize = 4;
     maeTable.values = configPage4.maeRates;
     maeTable.axisX = configPage4.maeBins;
-    WUETable.valueSize = SIZE_BYTE; //Set this table to use byte values
-    WUETable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     WUETable.xSize = 10;
     WUETable.values = configPage2.wueValues;
     WUETable.axisX = configPage4.wueBins;
-    ASETable.valueSize = SIZE_BYTE;
-    ASETable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     ASETable.xSize = 4;
     ASETable.values = configPage2.asePct;
     ASETable.axisX = configPage2.aseBins;
-    ASECountTable.valueSize = SIZE_BYTE;
-    ASECountTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     ASECountTable.xSize = 4;
     ASECountTable.values = configPage2.aseCount;
     ASECountTable.axisX = configPage2.aseBins;
-    PrimingPulseTable.valueSize = SIZE_BYTE;
-    PrimingPulseTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     PrimingPulseTable.xSize = 4;
     PrimingPulseTable.values = configPage2.primePulse;
     PrimingPulseTable.axisX = configPage2.primeBins;
-    crankingEnrichTable.valueSize = SIZE_BYTE;
-    crankingEnrichTable.axisSize = SIZE_BYTE;
     crankingEnrichTable.xSize = 4;
     crankingEnrichTable.values = configPage10.crankingEnrichValues;
     crankingEnrichTable.axisX = configPage10.crankingEnrichBins;
 
-    dwellVCorrectionTable.valueSize = SIZE_BYTE;
-    dwellVCorrectionTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     dwellVCorrectionTable.xSize = 6;
     dwellVCorrectionTable.values = configPage4.dwellCorrectionValues;
     dwellVCorrectionTable.axisX = configPage6.voltageCorrectionBins;
-    injectorVCorrectionTable.valueSize = SIZE_BYTE;
-    injectorVCorrectionTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     injectorVCorrectionTable.xSize = 6;
     injectorVCorrectionTable.values = configPage6.injVoltageCorrectionValues;
     injectorVCorrectionTable.axisX = configPage6.voltageCorrectionBins;
-    injectorAngleTable.valueSize = SIZE_INT;
-    injectorAngleTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     injectorAngleTable.xSize = 4;
     injectorAngleTable.values = configPage2.injAng;
     injectorAngleTable.axisX = configPage2.injAngRPM;
-    IATDensityCorrectionTable.valueSize = SIZE_BYTE;
-    IATDensityCorrectionTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     IATDensityCorrectionTable.xSize = 9;
     IATDensityCorrectionTable.values = configPage6.airDenRates;
     IATDensityCorrectionTable.axisX = configPage6.airDenBins;
-    baroFuelTable.valueSize = SIZE_BYTE;
-    baroFuelTable.axisSize = SIZE_BYTE;
     baroFuelTable.xSize = 8;
     baroFuelTable.values = configPage4.baroFuelValues;
     baroFuelTable.axisX = configPage4.baroFuelBins;
-    IATRetardTable.valueSize = SIZE_BYTE;
-    IATRetardTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     IATRetardTable.xSize = 6;
     IATRetardTable.values = configPage4.iatRetValues;
     IATRetardTable.axisX = configPage4.iatRetBins;
-    CLTAdvanceTable.valueSize = SIZE_BYTE;
-    CLTAdvanceTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     CLTAdvanceTable.xSize = 6;
-    CLTAdvanceTable.values = (byte*)configPage4.cltAdvValues;
+    CLTAdvanceTable.values = configPage4.cltAdvValues;
     CLTAdvanceTable.axisX = configPage4.cltAdvBins;
-    idleTargetTable.valueSize = SIZE_BYTE;
-    idleTargetTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     idleTargetTable.xSize = 10;
     idleTargetTable.values = configPage6.iacCLValues;
     idleTargetTable.axisX = configPage6.iacBins;
-    idleAdvanceTable.valueSize = SIZE_BYTE;
-    idleAdvanceTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     idleAdvanceTable.xSize = 6;
-    idleAdvanceTable.values = (byte*)configPage4.idleAdvValues;
+    idleAdvanceTable.values = configPage4.idleAdvValues;
     idleAdvanceTable.axisX = configPage4.idleAdvBins;
-    rotarySplitTable.valueSize = SIZE_BYTE;
-    rotarySplitTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     rotarySplitTable.xSize = 8;
     rotarySplitTable.values = configPage10.rotarySplitValues;
     rotarySplitTable.axisX = configPage10.rotarySplitBins;
 
-    flexFuelTable.valueSize = SIZE_BYTE;
-    flexFuelTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     flexFuelTable.xSize = 6;
     flexFuelTable.values = configPage10.flexFuelAdj;
     flexFuelTable.axisX = configPage10.flexFuelBins;
-    flexAdvTable.valueSize = SIZE_BYTE;
-    flexAdvTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     flexAdvTable.xSize = 6;
     flexAdvTable.values = configPage10.flexAdvAdj;
     flexAdvTable.axisX = configPage10.flexAdvBins;
-    flexBoostTable.valueSize = SIZE_INT;
-    flexBoostTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins (NOTE THIS IS DIFFERENT TO THE VALUES!!)
     flexBoostTable.xSize = 6;
     flexBoostTable.values = configPage10.flexBoostAdj;
     flexBoostTable.axisX = configPage10.flexBoostBins;
-    fuelTempTable.valueSize = SIZE_BYTE;
-    fuelTempTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     fuelTempTable.xSize = 6;
     fuelTempTable.values = configPage10.fuelTempValues;
     fuelTempTable.axisX = configPage10.fuelTempBins;
 
-    knockWindowStartTable.valueSize = SIZE_BYTE;
-    knockWindowStartTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     knockWindowStartTable.xSize = 6;
     knockWindowStartTable.values = configPage10.knock_window_angle;
     knockWindowStartTable.axisX = configPage10.knock_window_rpms;
-    knockWindowDurationTable.valueSize = SIZE_BYTE;
-    knockWindowDurationTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     knockWindowDurationTable.xSize = 6;
     knockWindowDurationTable.values = configPage10.knock_window_dur;
     knockWindowDurationTable.axisX = configPage10.knock_window_rpms;
 
-    oilPressureProtectTable.valueSize = SIZE_BYTE;
-    oilPressureProtectTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     oilPressureProtectTable.xSize = 4;
     oilPressureProtectTable.values = configPage10.oilPressureProtMins;
     oilPressureProtectTable.axisX = configPage10.oilPressureProtRPM;
 
-    coolantProtectTable.valueSize = SIZE_BYTE;
-    coolantProtectTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     coolantProtectTable.xSize = 6;
     coolantProtectTable.values = configPage9.coolantProtRPM;
     coolantProtectTable.axisX = configPage9.coolantProtTemp;
 
 
-    fanPWMTable.valueSize = SIZE_BYTE;
-    fanPWMTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     fanPWMTable.xSize = 4;
     fanPWMTable.values = configPage9.PWMFanDuty;
     fanPWMTable.axisX = configPage6.fanPWMBins;
 
-    wmiAdvTable.valueSize = SIZE_BYTE;
-    wmiAdvTable.axisSize = SIZE_BYTE; //Set this table to use byte axis bins
     wmiAdvTable.xSize = 6;
     wmiAdvTable.values = configPage10.wmiAdvAdj;
     wmiAdvTable.axisX = configPage10.wmiAdvBins;
 
-    cltCalibrationTable.valueSize = SIZE_INT;
-    cltCalibrationTable.axisSize = SIZE_INT;
     cltCalibrationTable.xSize = 32;
     cltCalibrationTable.values = cltCalibration_values;
     cltCalibrationTable.axisX = cltCalibration_bins;
 
-    iatCalibrationTable.valueSize = SIZE_INT;
-    iatCalibrationTable.axisSize = SIZE_INT;
     iatCalibrationTable.xSize = 32;
     iatCalibrationTable.values = iatCalibration_values;
     iatCalibrationTable.axisX = iatCalibration_bins;
 
-    o2CalibrationTable.valueSize = SIZE_BYTE;
-    o2CalibrationTable.axisSize = SIZE_INT;
     o2CalibrationTable.xSize = 32;
     o2CalibrationTable.values = o2Calibration_values;
     o2CalibrationTable.axisX = o2Calibration_bins;
@@ -294,6 +238,9 @@ void initialiseAll(void)
     {
       //First time running on this board
       resetConfigPages(); 
+      #if defined(CORE_NATIVE)
+        nativeDefaultConfig();
+      #endif
       setPinMapping(3); //Force board to v0.4
     }
     else { setPinMapping(configPage2.pinMapping); }
@@ -412,7 +359,7 @@ void initialiseAll(void)
     ms_counter = 0;
     fixedCrankingOverride = 0;
     timer5_overflow_count = 0;
-    toothHistoryIndex = 0;
+    toothLog_reset(toothLog);
     toothLastToothTime = 0;
 
     //Lookup the current MAP reading for barometric pressure
@@ -2994,6 +2941,9 @@ void initialiseTriggers(void)
   secondaryTriggerEdge = 0; //This is optional and may not be changed below, depending on the decoder in use
   tertiaryTriggerEdge = 0; //This is even more optional and may not be changed below, depending on the decoder in use
 
+  BIT_CLEAR(decoderState, BIT_DECODER_PER_TOOTH_INJ); //Only set by the decoders that support it
+  crankPrediction_reset(crankPredictionState);
+
   //Set the trigger function based on the decoder in the config
   switch (configPage4.TrigPattern)
   {
@@ -3018,7 +2968,7 @@ void initialiseTriggers(void)
       if(configPage10.TrigEdgeThrd == 0) { tertiaryTriggerEdge = RISING; }
       else { tertiaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       //The secondary input can be used for VSS if nothing else requires it. Allows for the standard VR conditioner to be used for VSS.
       if( (configPage2.vssMode > 1) && (pinVSS == pinTrigger2) && !BIT_CHECK(decoderState, BIT_DECODER_HAS_SECONDARY) )
       {
@@ -3050,7 +3000,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case 2:
@@ -3067,7 +3017,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3078,13 +3028,13 @@ void initialiseTriggers(void)
       getCrankAngle = getCrankAngle_GM7X;
       triggerSetEndTeeth = triggerSetEndTeeth_GM7X;
 
-      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, triggerHandler, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
-      else { attachInterrupt(triggerInterrupt, triggerHandler, FALLING); }
+      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
+      else { attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, FALLING); }
 
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_4G63:
@@ -3099,7 +3049,7 @@ void initialiseTriggers(void)
       primaryTriggerEdge = CHANGE;
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3116,7 +3066,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE; //Secondary is always on every change
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3133,7 +3083,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3150,7 +3100,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = RISING; //always rising for this trigger
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3167,7 +3117,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3186,7 +3136,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3203,7 +3153,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3220,7 +3170,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3237,7 +3187,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = CHANGE;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3254,7 +3204,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING;
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3269,7 +3219,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
       else { primaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_HARLEY:
@@ -3281,7 +3231,7 @@ void initialiseTriggers(void)
       triggerSetEndTeeth = triggerSetEndTeeth_Harley;
 
       primaryTriggerEdge = RISING; //Always rising
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       break;
 
     case DECODER_36_2_2_2:
@@ -3299,7 +3249,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3321,7 +3271,7 @@ void initialiseTriggers(void)
       else { primaryTriggerEdge = FALLING; }
       secondaryTriggerEdge = FALLING; //Always falling edge
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3340,7 +3290,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3359,7 +3309,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
 
       break;
@@ -3378,7 +3328,7 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
       else { secondaryTriggerEdge = FALLING; }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3401,7 +3351,7 @@ void initialiseTriggers(void)
         secondaryTriggerEdge = FALLING;
       }
 
-      attachInterrupt(triggerInterrupt, triggerHandler, primaryTriggerEdge);
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
       attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge);
       break;
 
@@ -3415,7 +3365,30 @@ void initialiseTriggers(void)
       if(configPage4.TrigEdge == 0) { primaryTriggerEdge = true; } // set as boolean so we can directly use it in decoder.
       else { primaryTriggerEdge = false; }
       
-      attachInterrupt(triggerInterrupt, triggerHandler, CHANGE); //Hardcoded change, the primaryTriggerEdge will be used in the decoder to select if it`s an inverted or non-inverted signal.
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, CHANGE); //Hardcoded change, the primaryTriggerEdge will be used in the decoder to select if it`s an inverted or non-inverted signal.
+      break;
+
+    case DECODER_GENERIC:
+      triggerSetup_Generic();
+      triggerHandler = triggerPri_Generic;
+      triggerSecondaryHandler = triggerSec_Generic;
+
+      if( (configPage4.sparkMode == IGN_MODE_SEQUENTIAL) || (configPage2.injLayout == INJ_SEQUENTIAL) ) { BIT_SET(decoderState, BIT_DECODER_HAS_SECONDARY); }
+      else { BIT_CLEAR(decoderState, BIT_DECODER_HAS_SECONDARY); }
+
+      getRPM = getRPM_Generic;
+      getCrankAngle = getCrankAngle_Generic;
+      triggerSetEndTeeth = triggerSetEndTeeth_Generic;
+
+      if(configPage4.TrigEdge == 0) { primaryTriggerEdge = RISING; } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
+      else { primaryTriggerEdge = FALLING; }
+      if(configPage4.TrigEdgeSec == 0) { secondaryTriggerEdge = RISING; }
+      else { secondaryTriggerEdge = FALLING; }
+
+      attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, primaryTriggerEdge);
+      //The secondary input can be used for VSS if nothing else requires it
+      if( (configPage2.vssMode > 1) && (pinVSS == pinTrigger2) && !BIT_CHECK(decoderState, BIT_DECODER_HAS_SECONDARY) ) { attachInterrupt(digitalPinToInterrupt(pinVSS), vssPulse, RISING); }
+      else { attachInterrupt(triggerInterrupt2, triggerSecondaryHandler, secondaryTriggerEdge); }
       break;
 
     default:
@@ -3423,8 +3396,8 @@ void initialiseTriggers(void)
       getRPM = getRPM_missingTooth;
       getCrankAngle = getCrankAngle_missingTooth;
 
-      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, triggerHandler, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
-      else { attachInterrupt(triggerInterrupt, triggerHandler, FALLING); }
+      if(configPage4.TrigEdge == 0) { attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, RISING); } // Attach the crank trigger wheel interrupt (Hall sensor drags to ground when triggering)
+      else { attachInterrupt(triggerInterrupt, PRIMARY_TRIGGER_ISR, FALLING); }
       break;
   }
 }
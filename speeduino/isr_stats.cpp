@@ -0,0 +1,151 @@
+/*
+Speeduino - Simple engine management for the Arduino Mega 2560 platform
+Copyright (C) Josh Stewart
+A full copy of the license may be found in the projects root directory
+*/
+/** @file
+ * Collection and reporting of the interrupt handler execution time statistics. See isr_stats.h
+ */
+#include "globals.h"
+#include "isr_stats.h"
+
+#if defined(ISR_STATS)
+
+struct isrStatistics isrStats[ISR_STATS_COUNT];
+struct isrStatsLogValues isrStatsLog;
+
+/** Starts the cycle counter (If needed) and clears the statistics. */
+void initialiseISRStats(void)
+{
+#if defined(CORE_TEENSY)
+  ARM_DEMCR |= ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#elif defined(CORE_STM32) || defined(CORE_SAME51)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+  resetISRStats();
+}
+
+/** Clears the min and max of all handlers and starts a new window. */
+void resetISRStats(void)
+{
+  noInterrupts();
+  for(uint8_t isr = 0; isr < ISR_STATS_COUNT; isr++)
+  {
+    isrStats[isr].minCycles = UINT32_MAX;
+    isrStats[isr].maxCycles = 0;
+    isrStats[isr].windowCycles = 0;
+    isrStats[isr].windowCalls = 0;
+    isrStats[isr].meanCycles = 0;
+    isrStats[isr].callsPerSecond = 0;
+  }
+  interrupts();
+}
+
+//Converts a cycle count to the 0.1uS units used in the TunerStudio log, saturating at the maximum that will fit
+static uint16_t cyclesToLogValue(uint32_t cycles)
+{
+  uint32_t tenthsUS = UINT16_MAX;
+  if(cycles < (UINT32_MAX / 10UL)) { tenthsUS = (cycles * 10UL) / ISR_STATS_CYCLES_PER_US; }
+  if(tenthsUS > UINT16_MAX) { tenthsUS = UINT16_MAX; }
+  return (uint16_t)tenthsUS;
+}
+
+/** Summarises the statistics for a consecutive group of handlers (Eg. All of the fuel schedules) into the TunerStudio log values.
+ * @return The total cycles spent in the group over the last window
+ */
+static uint32_t summariseISRStats(uint8_t firstISR, uint8_t count, uint16_t &logMean, uint16_t &logMax)
+{
+  uint32_t totalCycles = 0;
+  uint32_t totalCalls = 0;
+  uint32_t maxCycles = 0;
+  for(uint8_t isr = firstISR; isr < (firstISR + count); isr++)
+  {
+    totalCycles += isrStats[isr].meanCycles * isrStats[isr].callsPerSecond;
+    totalCalls += isrStats[isr].callsPerSecond;
+    noInterrupts();
+    if(isrStats[isr].maxCycles > maxCycles) { maxCycles = isrStats[isr].maxCycles; }
+    interrupts();
+  }
+
+  logMean = (totalCalls > 0U) ? cyclesToLogValue(totalCycles / totalCalls) : 0U;
+  logMax = cyclesToLogValue(maxCycles);
+  return totalCycles;
+}
+
+/** Closes the current window, calculating the mean and calls per second of each handler and updating the TunerStudio log values.
+ * Must be called once per second from the main loop
+ */
+void updateISRStats(void)
+{
+  for(uint8_t isr = 0; isr < ISR_STATS_COUNT; isr++)
+  {
+    noInterrupts();
+    uint32_t windowCycles = isrStats[isr].windowCycles;
+    uint32_t windowCalls = isrStats[isr].windowCalls;
+    isrStats[isr].windowCycles = 0;
+    isrStats[isr].windowCalls = 0;
+    interrupts();
+
+    isrStats[isr].meanCycles = (windowCalls > 0U) ? (windowCycles / windowCalls) : 0U;
+    isrStats[isr].callsPerSecond = (windowCalls > UINT16_MAX) ? UINT16_MAX : (uint16_t)windowCalls;
+  }
+
+  uint32_t totalCycles = summariseISRStats(ISR_STATS_TRIGGER, 1, isrStatsLog.triggerMean, isrStatsLog.triggerMax);
+  totalCycles += summariseISRStats(ISR_STATS_FUEL1, INJ_CHANNELS, isrStatsLog.fuelMean, isrStatsLog.fuelMax);
+  totalCycles += summariseISRStats(ISR_STATS_IGN1, IGN_CHANNELS, isrStatsLog.ignitionMean, isrStatsLog.ignitionMax);
+  totalCycles += summariseISRStats(ISR_STATS_ONE_MS, 1, isrStatsLog.oneMSMean, isrStatsLog.oneMSMax);
+
+  //There are ISR_STATS_CYCLES_PER_US * 1000000 cycles per second
+  uint32_t load = totalCycles / (ISR_STATS_CYCLES_PER_US * 10000UL);
+  isrStatsLog.load = (load > 100U) ? 100U : (uint8_t)load;
+}
+
+static uint8_t *writeBigEndian32(uint8_t *buffer, uint32_t value)
+{
+  buffer[0] = (value >> 24) & 255;
+  buffer[1] = (value >> 16) & 255;
+  buffer[2] = (value >> 8) & 255;
+  buffer[3] = value & 255;
+  return buffer + 4;
+}
+
+/** Fills a serial payload with the full statistics of every handler.
+ * The format (All values big endian) is:
+ * - 2 bytes: Cycles per uS
+ * - 1 byte: The number of handlers (ISR_STATS_COUNT). Then for each handler, in ISR_STATS_* order:
+ *   - 2 bytes: Calls per second
+ *   - 4 bytes: Min cycles (0 if it hasn't been called since the last reset)
+ *   - 4 bytes: Max cycles
+ *   - 4 bytes: Mean cycles
+ * @param buffer The buffer to fill. Must be at least 3 + (14 * ISR_STATS_COUNT) bytes
+ * @return The number of bytes written
+ */
+uint16_t getISRStatsPayload(uint8_t *buffer)
+{
+  uint8_t *pNext = buffer;
+  *pNext++ = highByte((uint16_t)ISR_STATS_CYCLES_PER_US);
+  *pNext++ = lowByte((uint16_t)ISR_STATS_CYCLES_PER_US);
+  *pNext++ = ISR_STATS_COUNT;
+
+  for(uint8_t isr = 0; isr < ISR_STATS_COUNT; isr++)
+  {
+    noInterrupts();
+    uint32_t minCycles = isrStats[isr].minCycles;
+    uint32_t maxCycles = isrStats[isr].maxCycles;
+    interrupts();
+    if(minCycles == UINT32_MAX) { minCycles = 0; }
+
+    *pNext++ = highByte(isrStats[isr].callsPerSecond);
+    *pNext++ = lowByte(isrStats[isr].callsPerSecond);
+    pNext = writeBigEndian32(pNext, minCycles);
+    pNext = writeBigEndian32(pNext, maxCycles);
+    pNext = writeBigEndian32(pNext, isrStats[isr].meanCycles);
+  }
+
+  return (uint16_t)(pNext - buffer);
+}
+
+#endif // ISR_STATS
@@ -0,0 +1,106 @@
+/** \file isr_stats.h
+ * @brief Optional execution time statistics for the interrupt handlers
+ *
+ * When compiled with ISR_STATS defined (Eg. build_flags = -DISR_STATS), the primary trigger, fuel/ignition schedule and 1ms
+ * interrupt handlers record how many CPU cycles each call takes. Once per second the min, max and mean of each are made available
+ * to TunerStudio (Summarised by handler type) and, per handler, through the 'i' serial command.
+ * Without ISR_STATS the instrumentation macros are empty, so there is no overhead at all.
+ *
+ * The cycles are counted with:
+ * - ARM Cortex-M3/M4/M7: The DWT cycle counter
+ * - AVR: Timer3, which free runs at 250kHz for the fuel schedules. This gives a resolution of 64 cycles
+ * - Native: micros(), which follows the virtual clock when it is in use. 1 'cycle' is 1uS
+ *
+ * Note that the times include any interrupts that were nested within the handler (Eg. The 1ms interrupt on AVR is non-blocking)
+ */
+#ifndef ISR_STATS_H
+#define ISR_STATS_H
+
+#if defined(ISR_STATS)
+
+#include "globals.h"
+
+//The handlers that are timed. The fuel and ignition schedule handlers are each numbered consecutively from channel 1
+#define ISR_STATS_TRIGGER   0 ///< The primary trigger decoder (triggerPri_*)
+#define ISR_STATS_FUEL1     1 ///< fuelSchedule1Interrupt
+#define ISR_STATS_IGN1      (ISR_STATS_FUEL1 + INJ_CHANNELS) ///< ignitionSchedule1Interrupt
+#define ISR_STATS_ONE_MS    (ISR_STATS_IGN1 + IGN_CHANNELS) ///< oneMSInterval
+#define ISR_STATS_COUNT     (ISR_STATS_ONE_MS + 1)
+
+#if defined(CORE_AVR)
+  typedef uint16_t isrStatsCounter_t;
+  #define ISR_STATS_COUNTER()         TCNT3
+  #define ISR_STATS_CYCLES_PER_COUNT  64UL
+  #define ISR_STATS_CYCLES_PER_US     (F_CPU / 1000000UL)
+#elif defined(CORE_TEENSY)
+  typedef uint32_t isrStatsCounter_t;
+  #define ISR_STATS_COUNTER()         ARM_DWT_CYCCNT
+  #define ISR_STATS_CYCLES_PER_COUNT  1UL
+  #define ISR_STATS_CYCLES_PER_US     (F_CPU / 1000000UL)
+#elif defined(CORE_STM32) || defined(CORE_SAME51)
+  typedef uint32_t isrStatsCounter_t;
+  #define ISR_STATS_COUNTER()         (DWT->CYCCNT)
+  #define ISR_STATS_CYCLES_PER_COUNT  1UL
+  #define ISR_STATS_CYCLES_PER_US     (SystemCoreClock / 1000000UL)
+#else
+  //No cycle counter (Eg. Cortex-M0+ or native), so fall back to micros()
+  typedef uint32_t isrStatsCounter_t;
+  #define ISR_STATS_COUNTER()         micros()
+  #define ISR_STATS_CYCLES_PER_COUNT  1UL
+  #define ISR_STATS_CYCLES_PER_US     1UL
+#endif
+
+struct isrStatistics {
+  volatile uint32_t minCycles;    ///< Since the last reset. Updated by the handler
+  volatile uint32_t maxCycles;    ///< Since the last reset. Updated by the handler
+  volatile uint32_t windowCycles; ///< The total cycles of all calls in the current 1 second window. Updated by the handler
+  volatile uint32_t windowCalls;  ///< The number of calls in the current 1 second window. Updated by the handler
+  uint32_t meanCycles;            ///< The mean of the last full window. Updated by updateISRStats()
+  uint16_t callsPerSecond;        ///< The number of calls in the last full window. Updated by updateISRStats()
+};
+
+/** The per second summary sent to TunerStudio, in units of 0.1uS.
+ * The schedule figures are the worst max and the overall mean across all of the fuel or ignition channels.
+ */
+struct isrStatsLogValues {
+  uint16_t triggerMean;
+  uint16_t triggerMax;
+  uint16_t fuelMean;
+  uint16_t fuelMax;
+  uint16_t ignitionMean;
+  uint16_t ignitionMax;
+  uint16_t oneMSMean;
+  uint16_t oneMSMax;
+  uint8_t load; ///< The % of CPU time spent in the timed handlers
+};
+
+extern struct isrStatistics isrStats[ISR_STATS_COUNT];
+extern struct isrStatsLogValues isrStatsLog;
+
+void initialiseISRStats(void);
+void resetISRStats(void);
+void updateISRStats(void);
+uint16_t getISRStatsPayload(uint8_t *buffer);
+
+static inline void recordISRStats(uint8_t isr, uint32_t cycles)
+{
+  struct isrStatistics &stats = isrStats[isr];
+  if(cycles < stats.minCycles) { stats.minCycles = cycles; }
+  if(cycles > stats.maxCycles) { stats.maxCycles = cycles; }
+  stats.windowCycles += cycles;
+  stats.windowCalls++;
+}
+
+/** Marks the start of a timed handler. Declares the start count, so must be in the same scope as the ISR_STATS_END() */
+#define ISR_STATS_BEGIN() isrStatsCounter_t isrStatsStart = ISR_STATS_COUNTER()
+/** Marks the end of a timed handler and records its time against the given ISR_STATS_* handler */
+#define ISR_STATS_END(isr) recordISRStats((isr), (uint32_t)((isrStatsCounter_t)(ISR_STATS_COUNTER() - isrStatsStart)) * ISR_STATS_CYCLES_PER_COUNT)
+
+#else
+
+#define ISR_STATS_BEGIN()
+#define ISR_STATS_END(isr)
+
+#endif // ISR_STATS
+
+#endif // ISR_STATS_H
@@ -10,15 +10,24 @@
 #define LOGGER_H
 
 #include <assert.h>
+#include "output_channels.h"
 
 #ifndef UNIT_TEST // Scope guard for unit testing
-  #define LOG_ENTRY_SIZE      125 /**< The size of the live data packet. This MUST match ochBlockSize setting in the ini file */
+  #if defined(ISR_STATS)
+    #define LOG_ENTRY_SIZE    142 /**< The size of the live data packet, including the ISR execution times. This MUST match ochBlockSize setting in the ini file (With the ISR_STATS setting) */
+  #else
+    #define LOG_ENTRY_SIZE    125 /**< The size of the live data packet. This MUST match ochBlockSize setting in the ini file */
+  #endif
   #define SD_LOG_ENTRY_SIZE   125 /**< The size of the live data packet used by the SD card.*/
 #else
   #define LOG_ENTRY_SIZE      1 /**< The size of the live data packet. This MUST match ochBlockSize setting in the ini file */
   #define SD_LOG_ENTRY_SIZE   1 /**< The size of the live data packet used by the SD card.*/
 #endif
 
+#ifndef UNIT_TEST
+static_assert(sizeof(outputChannelBlock) == LOG_ENTRY_SIZE, "The output channel block must be LOG_ENTRY_SIZE bytes");
+#endif
+
 #define SD_LOG_NUM_FIELDS   90 /**< The number of fields that are in the log. This is always smaller than the entry size due to some fields being 2 bytes */
 
 byte getTSLogEntry(uint16_t byteNum);
@@ -31,7 +40,11 @@ bool is2ByteEntry(uint8_t key);
 // This array indicates which index values from the log are 2 byte values
 // This array MUST remain in ascending order
 // !!!! WARNING: If any value above 255 is required in this array, changes MUST be made to is2ByteEntry() function !!!!
+#if defined(ISR_STATS)
+const byte PROGMEM fsIntIndex[] = {4, 14, 17, 22, 26, 28, 33, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 76, 78, 80, 82, 86, 88, 90, 93, 95, 99, 104, 111, 121, 125, 127, 129, 131, 133, 135, 137, 139 };
+#else
 const byte PROGMEM fsIntIndex[] = {4, 14, 17, 22, 26, 28, 33, 42, 44, 46, 48, 50, 52, 54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 76, 78, 80, 82, 86, 88, 90, 93, 95, 99, 104, 111, 121 };
+#endif
 
 //List of logger field names. This must be in the same order and length as logger_updateLogdataCSV()
 const char header_0[] PROGMEM = "secl";
@@ -59,6 +59,16 @@ inline int32_t div100(int32_t n) {
 }
 #endif
 
+#if defined(CORE_NATIVE)
+//long is 64-bit on the host, so these are needed to resolve the overloads for unsigned long/long arguments
+inline uint64_t div100(uint64_t n) {
+    return n / (uint64_t)100U;
+}
+inline int64_t div100(int64_t n) {
+    return n / (int64_t)100;
+}
+#endif
+
 inline uint32_t div360(uint32_t n) {
 #ifdef USE_LIBDIVIDE
     return libdivide::libdivide_u32_do(n, &libdiv_u32_360);
@@ -0,0 +1,140 @@
+/*
+Speeduino - Simple engine management for the Arduino Mega 2560 platform
+Copyright (C) Josh Stewart
+A full copy of the license may be found in the projects root directory
+*/
+/** @file
+ * The realtime data block sent to TunerStudio. See output_channels.h
+ */
+#include "globals.h"
+#include "output_channels.h"
+#include "errors.h"
+#include "isr_stats.h"
+
+outputChannelBlock outputChannels;
+
+/** Refreshes outputChannels from currentStatus.
+ * Values have the offsets and shifts expected by TunerStudio. They will not all be a 'human readable value'
+ */
+void updateOutputChannels(void)
+{
+  if(currentStatus.loopsPerSecond > 60000U) { currentStatus.loopsPerSecond = 60000U; }
+  currentStatus.freeRAM = freeRam();
+
+  outputChannelBlock &block = outputChannels;
+  block.secl = currentStatus.secl;
+  block.status1 = currentStatus.status1;
+  block.engine = currentStatus.engine;
+  block.syncLossCounter = currentStatus.syncLossCounter;
+  block.MAP = (uint16_t)currentStatus.MAP;
+  block.IAT = (uint8_t)(currentStatus.IAT + CALIBRATION_TEMPERATURE_OFFSET);
+  block.coolant = (uint8_t)(currentStatus.coolant + CALIBRATION_TEMPERATURE_OFFSET);
+  block.batCorrection = currentStatus.batCorrection;
+  block.battery10 = currentStatus.battery10;
+  block.O2 = currentStatus.O2;
+  block.egoCorrection = currentStatus.egoCorrection;
+  block.iatCorrection = currentStatus.iatCorrection;
+  block.wueCorrection = currentStatus.wueCorrection;
+  block.RPM = currentStatus.RPM;
+  block.AEamount = (uint8_t)(currentStatus.AEamount >> 1);
+  block.corrections = currentStatus.corrections;
+  block.VE1 = currentStatus.VE1;
+  block.VE2 = currentStatus.VE2;
+  block.afrTarget = currentStatus.afrTarget;
+  block.tpsDOT = currentStatus.tpsDOT;
+  block.advance = currentStatus.advance;
+  block.TPS = currentStatus.TPS;
+  block.loopsPerSecond = (uint16_t)currentStatus.loopsPerSecond;
+  block.freeRAM = currentStatus.freeRAM;
+  block.boostTarget = (uint8_t)(currentStatus.boostTarget >> 1);
+  block.boostDuty = (uint8_t)(currentStatus.boostDuty / 100U);
+  block.spark = currentStatus.spark;
+  block.rpmDOT = (int16_t)currentStatus.rpmDOT;
+  block.ethanolPct = currentStatus.ethanolPct;
+  block.flexCorrection = currentStatus.flexCorrection;
+  block.flexIgnCorrection = currentStatus.flexIgnCorrection;
+  block.idleLoad = currentStatus.idleLoad;
+  block.testOutputs = currentStatus.testOutputs;
+  block.O2_2 = currentStatus.O2_2;
+  block.baro = currentStatus.baro;
+  memcpy(block.canin, currentStatus.canin, sizeof(block.canin));
+  block.tpsADC = currentStatus.tpsADC;
+  block.errors = getNextError();
+  block.PW1 = (uint16_t)currentStatus.PW1;
+  block.PW2 = (uint16_t)currentStatus.PW2;
+  block.PW3 = (uint16_t)currentStatus.PW3;
+  block.PW4 = (uint16_t)currentStatus.PW4;
+  block.status3 = currentStatus.status3;
+  block.engineProtectStatus = currentStatus.engineProtectStatus;
+  block.fuelLoad = currentStatus.fuelLoad;
+  block.ignLoad = currentStatus.ignLoad;
+  block.dwell = (int16_t)currentStatus.dwell;
+  block.CLIdleTarget = currentStatus.CLIdleTarget;
+  block.mapDOT = currentStatus.mapDOT;
+  block.vvt1Angle = currentStatus.vvt1Angle;
+  block.vvt1TargetAngle = currentStatus.vvt1TargetAngle;
+  block.vvt1Duty = (uint8_t)currentStatus.vvt1Duty;
+  block.flexBoostCorrection = currentStatus.flexBoostCorrection;
+  block.baroCorrection = currentStatus.baroCorrection;
+  block.VE = currentStatus.VE;
+  block.ASEValue = currentStatus.ASEValue;
+  block.vss = currentStatus.vss;
+  block.gear = currentStatus.gear;
+  block.fuelPressure = currentStatus.fuelPressure;
+  block.oilPressure = currentStatus.oilPressure;
+  block.wmiPW = currentStatus.wmiPW;
+  block.status4 = currentStatus.status4;
+  block.vvt2Angle = currentStatus.vvt2Angle;
+  block.vvt2TargetAngle = currentStatus.vvt2TargetAngle;
+  block.vvt2Duty = (uint8_t)currentStatus.vvt2Duty;
+  block.outputsStatus = currentStatus.outputsStatus;
+  block.fuelTemp = (uint8_t)(currentStatus.fuelTemp + CALIBRATION_TEMPERATURE_OFFSET);
+  block.fuelTempCorrection = currentStatus.fuelTempCorrection;
+  block.advance1 = currentStatus.advance1;
+  block.advance2 = currentStatus.advance2;
+  block.TS_SD_Status = currentStatus.TS_SD_Status;
+  block.EMAP = currentStatus.EMAP;
+  block.fanDuty = currentStatus.fanDuty;
+  block.airConStatus = currentStatus.airConStatus;
+#if defined(ISR_STATS)
+  block.isrTriggerMean = isrStatsLog.triggerMean;
+  block.isrTriggerMax = isrStatsLog.triggerMax;
+  block.isrFuelMean = isrStatsLog.fuelMean;
+  block.isrFuelMax = isrStatsLog.fuelMax;
+  block.isrIgnitionMean = isrStatsLog.ignitionMean;
+  block.isrIgnitionMax = isrStatsLog.ignitionMax;
+  block.isrOneMSMean = isrStatsLog.oneMSMean;
+  block.isrOneMSMax = isrStatsLog.oneMSMax;
+  block.isrLoad = isrStatsLog.load;
+#endif
+}
+
+/** Writes a frame in the delta format (See output_channels.h) of the fields of current that differ from previous, then
+ * updates previous to match. previous must be what the receiver holds, so is the block as of the last frame sent.
+ * @param allFields Include every field, such as for the first frame or after a frame has been lost
+ * @param pBuffer At least OUTPUT_CHANNEL_DELTA_MAX_SIZE bytes
+ * @return The number of bytes written
+ */
+uint16_t encodeOutputChannelsDelta(const outputChannelBlock &current, outputChannelBlock &previous, bool allFields, uint8_t *pBuffer)
+{
+  const uint8_t *pCurrent = (const uint8_t *)&current;
+  uint8_t *pPrevious = (uint8_t *)&previous;
+  uint8_t *pBitmap = pBuffer;
+  uint16_t length = OUTPUT_CHANNEL_BITMAP_SIZE;
+  memset(pBitmap, 0, OUTPUT_CHANNEL_BITMAP_SIZE);
+
+  for(uint8_t field = 0; field < OUTPUT_CHANNEL_FIELD_COUNT; field++)
+  {
+    uint8_t offset = pgm_read_byte(&outputChannelFields[field].offset);
+    uint8_t size = pgm_read_byte(&outputChannelFields[field].size);
+    if( (allFields == true) || (memcmp(&pCurrent[offset], &pPrevious[offset], size) != 0) )
+    {
+      pBitmap[field >> 3] |= (uint8_t)(1U << (field & 7U));
+      memcpy(&pBuffer[length], &pCurrent[offset], size);
+      length += size;
+    }
+  }
+  memcpy(pPrevious, pCurrent, sizeof(outputChannelBlock));
+
+  return length;
+}
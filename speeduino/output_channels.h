@@ -0,0 +1,180 @@
+/*
+The realtime data block sent to TunerStudio (The 'A' and 'r' commands, see generateLiveValues() in comms.cpp).
+
+Rather than working out each byte of the block when it is sent, the whole block is kept in outputChannels, in
+exactly the byte order TunerStudio expects (See the [OutputChannels] section of the ini file). updateOutputChannels()
+refreshes it from currentStatus, applying the offsets and scaling TunerStudio expects. It is refreshed on demand,
+once for each request that reads it, so sending any part of the block is then a copy.
+
+Multi-byte fields are little endian, as they are stored on all of the supported boards, so the block is a packed
+struct of the native types.
+
+outputChannelFields describes the layout field by field. It is checked against the struct at compile time, and
+lets code that works through the block a field at a time do so without repeating the layout.
+
+The delta format (The 'o' command, see encodeOutputChannelsDelta()) sends only the fields that have changed since the
+last frame sent, for slow links where most of each full poll is values that have not changed:
+- A bitmap of OUTPUT_CHANNEL_BITMAP_SIZE bytes. Bit (n % 8) of byte (n / 8) is set if field n of outputChannelFields
+  is included
+- The bytes of each included field, in order
+The receiver keeps its own copy of the block and writes each included field into it.
+*/
+#ifndef OUTPUT_CHANNELS_H
+#define OUTPUT_CHANNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Arduino.h>
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+  #error "The output channel block is sent as stored, so must be little endian"
+#endif
+
+struct outputChannelBlock {
+  uint8_t secl;                 ///< 0: Counter that increments each second. Used to track unexpected resets
+  uint8_t status1;              ///< 1: status1 bitfield
+  uint8_t engine;               ///< 2: Engine status bitfield
+  uint8_t syncLossCounter;      ///< 3
+  uint16_t MAP;                 ///< 4
+  uint8_t IAT;                  ///< 6: + CALIBRATION_TEMPERATURE_OFFSET
+  uint8_t coolant;              ///< 7: + CALIBRATION_TEMPERATURE_OFFSET
+  uint8_t batCorrection;        ///< 8: Battery voltage correction (%)
+  uint8_t battery10;            ///< 9
+  uint8_t O2;                   ///< 10
+  uint8_t egoCorrection;        ///< 11: Exhaust gas correction (%)
+  uint8_t iatCorrection;        ///< 12: Air temperature correction (%)
+  uint8_t wueCorrection;        ///< 13: Warmup enrichment (%)
+  uint16_t RPM;                 ///< 14
+  uint8_t AEamount;             ///< 16: Acceleration enrichment (%) divided by 2 (Can exceed 255)
+  uint16_t corrections;         ///< 17: Total GammaE (%)
+  uint8_t VE1;                  ///< 19
+  uint8_t VE2;                  ///< 20
+  uint8_t afrTarget;            ///< 21
+  int16_t tpsDOT;               ///< 22
+  int8_t advance;               ///< 24
+  uint8_t TPS;                  ///< 25
+  uint16_t loopsPerSecond;      ///< 26: Limited to 60000
+  uint16_t freeRAM;             ///< 28
+  uint8_t boostTarget;          ///< 30: Divided by 2 to fit in a byte
+  uint8_t boostDuty;            ///< 31: Divided by 100
+  uint8_t spark;                ///< 32: Spark related bitfield
+  int16_t rpmDOT;               ///< 33
+  uint8_t ethanolPct;           ///< 35: Flex sensor value (Or 0 if not used)
+  uint8_t flexCorrection;       ///< 36
+  int8_t flexIgnCorrection;     ///< 37
+  uint8_t idleLoad;             ///< 38
+  uint8_t testOutputs;          ///< 39
+  uint8_t O2_2;                 ///< 40
+  uint8_t baro;                 ///< 41
+  uint16_t canin[16];           ///< 42
+  uint8_t tpsADC;               ///< 74
+  uint8_t errors;               ///< 75: See getNextError()
+  uint16_t PW1;                 ///< 76
+  uint16_t PW2;                 ///< 78
+  uint16_t PW3;                 ///< 80
+  uint16_t PW4;                 ///< 82
+  uint8_t status3;              ///< 84
+  uint8_t engineProtectStatus;  ///< 85
+  int16_t fuelLoad;             ///< 86
+  int16_t ignLoad;              ///< 88
+  int16_t dwell;                ///< 90
+  uint8_t CLIdleTarget;         ///< 92
+  int16_t mapDOT;               ///< 93
+  int16_t vvt1Angle;            ///< 95
+  uint8_t vvt1TargetAngle;      ///< 97
+  uint8_t vvt1Duty;             ///< 98
+  int16_t flexBoostCorrection;  ///< 99
+  uint8_t baroCorrection;       ///< 101
+  uint8_t VE;                   ///< 102: Current VE (%)
+  uint8_t ASEValue;             ///< 103: Current ASE (%)
+  uint16_t vss;                 ///< 104
+  uint8_t gear;                 ///< 106
+  uint8_t fuelPressure;         ///< 107
+  uint8_t oilPressure;          ///< 108
+  uint8_t wmiPW;                ///< 109
+  uint8_t status4;              ///< 110
+  int16_t vvt2Angle;            ///< 111
+  uint8_t vvt2TargetAngle;      ///< 113
+  uint8_t vvt2Duty;             ///< 114
+  uint8_t outputsStatus;        ///< 115
+  uint8_t fuelTemp;             ///< 116: + CALIBRATION_TEMPERATURE_OFFSET
+  uint8_t fuelTempCorrection;   ///< 117
+  int8_t advance1;              ///< 118
+  int8_t advance2;              ///< 119
+  uint8_t TS_SD_Status;         ///< 120: SD card status
+  int16_t EMAP;                 ///< 121
+  uint8_t fanDuty;              ///< 123
+  uint8_t airConStatus;         ///< 124
+#if defined(ISR_STATS)
+  //ISR execution times (0.1uS) and load. Only in the block when the firmware is compiled with ISR_STATS
+  uint16_t isrTriggerMean;      ///< 125
+  uint16_t isrTriggerMax;       ///< 127
+  uint16_t isrFuelMean;         ///< 129
+  uint16_t isrFuelMax;          ///< 131
+  uint16_t isrIgnitionMean;     ///< 133
+  uint16_t isrIgnitionMax;      ///< 135
+  uint16_t isrOneMSMean;        ///< 137
+  uint16_t isrOneMSMax;         ///< 139
+  uint8_t isrLoad;              ///< 141
+#endif
+} __attribute__((packed));
+
+struct outputChannelField {
+  uint8_t offset; ///< The byte number of the first byte of the field
+  uint8_t size;   ///< 1 or 2 bytes
+};
+
+#define OUTPUT_CHANNEL_FIELD(field) { offsetof(outputChannelBlock, field), sizeof(outputChannelBlock::field) }
+
+/** The fields of outputChannelBlock, in order. Read with pgm_read_byte() */
+constexpr outputChannelField outputChannelFields[] PROGMEM = {
+  OUTPUT_CHANNEL_FIELD(secl), OUTPUT_CHANNEL_FIELD(status1), OUTPUT_CHANNEL_FIELD(engine), OUTPUT_CHANNEL_FIELD(syncLossCounter),
+  OUTPUT_CHANNEL_FIELD(MAP), OUTPUT_CHANNEL_FIELD(IAT), OUTPUT_CHANNEL_FIELD(coolant), OUTPUT_CHANNEL_FIELD(batCorrection),
+  OUTPUT_CHANNEL_FIELD(battery10), OUTPUT_CHANNEL_FIELD(O2), OUTPUT_CHANNEL_FIELD(egoCorrection), OUTPUT_CHANNEL_FIELD(iatCorrection),
+  OUTPUT_CHANNEL_FIELD(wueCorrection), OUTPUT_CHANNEL_FIELD(RPM), OUTPUT_CHANNEL_FIELD(AEamount), OUTPUT_CHANNEL_FIELD(corrections),
+  OUTPUT_CHANNEL_FIELD(VE1), OUTPUT_CHANNEL_FIELD(VE2), OUTPUT_CHANNEL_FIELD(afrTarget), OUTPUT_CHANNEL_FIELD(tpsDOT),
+  OUTPUT_CHANNEL_FIELD(advance), OUTPUT_CHANNEL_FIELD(TPS), OUTPUT_CHANNEL_FIELD(loopsPerSecond), OUTPUT_CHANNEL_FIELD(freeRAM),
+  OUTPUT_CHANNEL_FIELD(boostTarget), OUTPUT_CHANNEL_FIELD(boostDuty), OUTPUT_CHANNEL_FIELD(spark), OUTPUT_CHANNEL_FIELD(rpmDOT),
+  OUTPUT_CHANNEL_FIELD(ethanolPct), OUTPUT_CHANNEL_FIELD(flexCorrection), OUTPUT_CHANNEL_FIELD(flexIgnCorrection), OUTPUT_CHANNEL_FIELD(idleLoad),
+  OUTPUT_CHANNEL_FIELD(testOutputs), OUTPUT_CHANNEL_FIELD(O2_2), OUTPUT_CHANNEL_FIELD(baro),
+  OUTPUT_CHANNEL_FIELD(canin[0]), OUTPUT_CHANNEL_FIELD(canin[1]), OUTPUT_CHANNEL_FIELD(canin[2]), OUTPUT_CHANNEL_FIELD(canin[3]),
+  OUTPUT_CHANNEL_FIELD(canin[4]), OUTPUT_CHANNEL_FIELD(canin[5]), OUTPUT_CHANNEL_FIELD(canin[6]), OUTPUT_CHANNEL_FIELD(canin[7]),
+  OUTPUT_CHANNEL_FIELD(canin[8]), OUTPUT_CHANNEL_FIELD(canin[9]), OUTPUT_CHANNEL_FIELD(canin[10]), OUTPUT_CHANNEL_FIELD(canin[11]),
+  OUTPUT_CHANNEL_FIELD(canin[12]), OUTPUT_CHANNEL_FIELD(canin[13]), OUTPUT_CHANNEL_FIELD(canin[14]), OUTPUT_CHANNEL_FIELD(canin[15]),
+  OUTPUT_CHANNEL_FIELD(tpsADC), OUTPUT_CHANNEL_FIELD(errors), OUTPUT_CHANNEL_FIELD(PW1), OUTPUT_CHANNEL_FIELD(PW2),
+  OUTPUT_CHANNEL_FIELD(PW3), OUTPUT_CHANNEL_FIELD(PW4), OUTPUT_CHANNEL_FIELD(status3), OUTPUT_CHANNEL_FIELD(engineProtectStatus),
+  OUTPUT_CHANNEL_FIELD(fuelLoad), OUTPUT_CHANNEL_FIELD(ignLoad), OUTPUT_CHANNEL_FIELD(dwell), OUTPUT_CHANNEL_FIELD(CLIdleTarget),
+  OUTPUT_CHANNEL_FIELD(mapDOT), OUTPUT_CHANNEL_FIELD(vvt1Angle), OUTPUT_CHANNEL_FIELD(vvt1TargetAngle), OUTPUT_CHANNEL_FIELD(vvt1Duty),
+  OUTPUT_CHANNEL_FIELD(flexBoostCorrection), OUTPUT_CHANNEL_FIELD(baroCorrection), OUTPUT_CHANNEL_FIELD(VE), OUTPUT_CHANNEL_FIELD(ASEValue),
+  OUTPUT_CHANNEL_FIELD(vss), OUTPUT_CHANNEL_FIELD(gear), OUTPUT_CHANNEL_FIELD(fuelPressure), OUTPUT_CHANNEL_FIELD(oilPressure),
+  OUTPUT_CHANNEL_FIELD(wmiPW), OUTPUT_CHANNEL_FIELD(status4), OUTPUT_CHANNEL_FIELD(vvt2Angle), OUTPUT_CHANNEL_FIELD(vvt2TargetAngle),
+  OUTPUT_CHANNEL_FIELD(vvt2Duty), OUTPUT_CHANNEL_FIELD(outputsStatus), OUTPUT_CHANNEL_FIELD(fuelTemp), OUTPUT_CHANNEL_FIELD(fuelTempCorrection),
+  OUTPUT_CHANNEL_FIELD(advance1), OUTPUT_CHANNEL_FIELD(advance2), OUTPUT_CHANNEL_FIELD(TS_SD_Status), OUTPUT_CHANNEL_FIELD(EMAP),
+  OUTPUT_CHANNEL_FIELD(fanDuty), OUTPUT_CHANNEL_FIELD(airConStatus),
+#if defined(ISR_STATS)
+  OUTPUT_CHANNEL_FIELD(isrTriggerMean), OUTPUT_CHANNEL_FIELD(isrTriggerMax), OUTPUT_CHANNEL_FIELD(isrFuelMean), OUTPUT_CHANNEL_FIELD(isrFuelMax),
+  OUTPUT_CHANNEL_FIELD(isrIgnitionMean), OUTPUT_CHANNEL_FIELD(isrIgnitionMax), OUTPUT_CHANNEL_FIELD(isrOneMSMean), OUTPUT_CHANNEL_FIELD(isrOneMSMax),
+  OUTPUT_CHANNEL_FIELD(isrLoad),
+#endif
+};
+
+#define OUTPUT_CHANNEL_FIELD_COUNT (sizeof(outputChannelFields) / sizeof(outputChannelFields[0]))
+
+/* Whether fields from the given one on follow on from each other, with no gaps or overlaps, to the end of the block */
+constexpr bool outputChannelFieldsContiguous(uint8_t field, uint16_t offset)
+{
+  return (field == OUTPUT_CHANNEL_FIELD_COUNT) ? (offset == sizeof(outputChannelBlock))
+         : ( (outputChannelFields[field].offset == offset) && (outputChannelFields[field].size <= 2U)
+             && outputChannelFieldsContiguous(field + 1U, offset + outputChannelFields[field].size) );
+}
+static_assert(outputChannelFieldsContiguous(0, 0), "outputChannelFields must list every field of outputChannelBlock, in order");
+
+#define OUTPUT_CHANNEL_BITMAP_SIZE ((OUTPUT_CHANNEL_FIELD_COUNT + 7U) / 8U)
+#define OUTPUT_CHANNEL_DELTA_MAX_SIZE (OUTPUT_CHANNEL_BITMAP_SIZE + sizeof(outputChannelBlock)) ///< The size of a delta frame with every field included
+
+extern outputChannelBlock outputChannels;
+
+void updateOutputChannels(void);
+uint16_t encodeOutputChannelsDelta(const outputChannelBlock &current, outputChannelBlock &previous, bool allFields, uint8_t *pBuffer);
+
+#endif // OUTPUT_CHANNELS_H
@@ -32,14 +32,19 @@ static inline uint32_t compute_tableaxis_crc(table_axis_iterator it, uint32_t cr
 {
     const int16_byte *pConverter = table3d_axis_io::get_converter(it.get_domain());
 
-    byte values[32]; // Fingers crossed we don't have a table bigger than 32x32
-    byte *pValue = values;
+    // The axis is converted & added to the CRC in blocks, so there is no limit on the axis length
+    byte values[16];
     while (!it.at_end())
     {
-        *pValue++ = pConverter->to_byte(*it);
-        ++it;
+        byte *pValue = values;
+        while (!it.at_end() && pValue!=values+sizeof(values))
+        {
+            *pValue++ = pConverter->to_byte(*it);
+            ++it;
+        }
+        crc = CRC32.crc32_upd(values, pValue-values, false);
     }
-    return pValue-values==0 ? crc : CRC32.crc32_upd(values, pValue-values, false);
+    return crc;
 }
 
 static inline uint32_t compute_table_crc(page_iterator_t &entity, pCrcCalc calcFunc)
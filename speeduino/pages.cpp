@@ -33,7 +33,7 @@ constexpr const uint16_t PROGMEM ini_page_sizes[] = { 0, 128, 288, 288, 128, 288
 template <class table_t>
 inline constexpr uint16_t get_table_value_end()
 {
-  return table_t::xaxis_t::length*table_t::yaxis_t::length;
+  return table_t::xaxis_t::length*table_t::yaxis_t::length*sizeof(typename table_t::value_t::value_type);
 }
 template <class table_t>
 inline constexpr uint16_t get_table_axisx_end()
@@ -94,17 +94,19 @@ public:
     {
       case table_location_values:
         get_value_value() = new_value;
+        invalidate_cache(&_pTable->get_value_cache);
         break;
 
       case table_location_xaxis:
         get_xaxis_value() = table3d_axis_io::from_byte(table_t::xaxis_t::domain, new_value);
+        invalidate_axis_cache(&_pTable->get_value_cache);
         break;
 
       case table_location_yaxis:
       default:
         get_yaxis_value() = table3d_axis_io::from_byte(table_t::yaxis_t::domain, new_value);
+        invalidate_axis_cache(&_pTable->get_value_cache);
     }
-    invalidate_cache(&_pTable->get_value_cache);
     return *this;
   }  
 
@@ -112,7 +114,7 @@ private:
 
   inline byte& get_value_value() const
   {
-    return _pTable->values.value_at((uint8_t)_table_offset);
+    return _pTable->values.value_byte_at(_table_offset);
   }
 
   inline table3d_axis_t& get_xaxis_value() const
@@ -185,6 +187,8 @@ inline void set_value(page_iterator_t &entity, byte value, uint16_t offset)
   if (Raw==entity.type)
   {
     get_raw_location(entity, offset) = value;
+    // Raw entities hold the 2D table data
+    table2D_invalidateAllCaches();
   }
   else if (Table==entity.type)
   {
@@ -0,0 +1,98 @@
+/*
+A small, fixed size FIFO of the events waiting to run on a single schedule channel.
+This allows eg. several injection pulses per cycle (Split injection) or several sparks
+(Multi-spark) to be set up in one go, rather than re-arming the schedule from the main
+loop after each event.
+
+The queue is written by the main loop and read by the channel ISR. It is a single
+producer/single consumer ring buffer: the head index is only written by the consumer
+and the tail index only by the producer. Both are free running 8-bit counters (So each
+is updated with a single, atomic, write) and are masked when indexing the buffer.
+*/
+#ifndef SCHEDULE_QUEUE_H
+#define SCHEDULE_QUEUE_H
+
+#include <stdint.h>
+
+#ifndef SCHEDULE_QUEUE_SIZE
+#define SCHEDULE_QUEUE_SIZE 4 ///< The number of events each queue can hold. Must be a power of 2
+#endif
+
+static_assert((SCHEDULE_QUEUE_SIZE & (SCHEDULE_QUEUE_SIZE-1)) == 0, "SCHEDULE_QUEUE_SIZE must be a power of 2");
+static_assert(SCHEDULE_QUEUE_SIZE <= 128, "SCHEDULE_QUEUE_SIZE must fit in the 8-bit queue indices");
+
+#define SCHEDULE_QUEUE_MASK (SCHEDULE_QUEUE_SIZE-1)
+
+/*
+The events are stored as parallel arrays, rather than an array of structs, so that
+each field can be individually volatile.
+*/
+template <typename compare_t>
+struct scheduleQueue {
+  typedef compare_t compare_type;
+
+  volatile compare_t startCompare[SCHEDULE_QUEUE_SIZE]; ///< The timer counter value at which each event starts
+  volatile unsigned long duration[SCHEDULE_QUEUE_SIZE]; ///< The duration (uS) of each event
+  volatile uint8_t head = 0; ///< Index of the oldest event. Only written by the consumer
+  volatile uint8_t tail = 0; ///< Index one past the newest event. Only written by the producer
+};
+
+template <typename compare_t>
+static inline uint8_t scheduleQueue_count(const scheduleQueue<compare_t> *pQueue)
+{
+  return (uint8_t)(pQueue->tail - pQueue->head);
+}
+
+template <typename compare_t>
+static inline bool scheduleQueue_isEmpty(const scheduleQueue<compare_t> *pQueue)
+{
+  return pQueue->tail == pQueue->head;
+}
+
+/**
+ * @brief Adds an event to the back of the queue
+ *
+ * @return false if the queue is full. The event is dropped and the queue is unchanged
+ */
+template <typename compare_t>
+static inline bool scheduleQueue_push(scheduleQueue<compare_t> *pQueue, typename scheduleQueue<compare_t>::compare_type startCompare, unsigned long duration)
+{
+  uint8_t tail = pQueue->tail;
+  if ((uint8_t)(tail - pQueue->head) >= SCHEDULE_QUEUE_SIZE) { return false; }
+
+  pQueue->startCompare[tail & SCHEDULE_QUEUE_MASK] = startCompare;
+  pQueue->duration[tail & SCHEDULE_QUEUE_MASK] = duration;
+  //The event must be fully written before it is published to the consumer
+  pQueue->tail = tail + 1U;
+  return true;
+}
+
+/**
+ * @brief Removes the event at the front of the queue
+ *
+ * @return false if the queue is empty. The output parameters are not changed
+ */
+template <typename compare_t>
+static inline bool scheduleQueue_pop(scheduleQueue<compare_t> *pQueue, compare_t *pStartCompare, unsigned long *pDuration)
+{
+  uint8_t head = pQueue->head;
+  if (head == pQueue->tail) { return false; }
+
+  *pStartCompare = pQueue->startCompare[head & SCHEDULE_QUEUE_MASK];
+  *pDuration = pQueue->duration[head & SCHEDULE_QUEUE_MASK];
+  pQueue->head = head + 1U;
+  return true;
+}
+
+/**
+ * @brief Discards all queued events.
+ *
+ * This writes the head index, so from the main loop it must be called with interrupts disabled.
+ */
+template <typename compare_t>
+static inline void scheduleQueue_clear(scheduleQueue<compare_t> *pQueue)
+{
+  pQueue->head = pQueue->tail;
+}
+
+#endif // SCHEDULE_QUEUE_H
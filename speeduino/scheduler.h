@@ -43,6 +43,11 @@ See page 136 of the processors datasheet: http://www.atmel.com/Images/doc2549.pd
 
 #include "globals.h"
 
+#if defined(CORE_AVR)
+  #define SCHEDULE_QUEUE_SIZE 2 //RAM is limited on the AVR
+#endif
+#include "schedule_queue.h"
+
 #define USE_IGN_REFRESH
 #define IGNITION_REFRESH_THRESHOLD  30 //Time in uS that the refresh functions will check to ensure there is enough time before changing the end compare
 
@@ -92,7 +97,6 @@ void setFuelSchedule1(unsigned long timeout, unsigned long duration);
 void setFuelSchedule2(unsigned long timeout, unsigned long duration);
 void setFuelSchedule3(unsigned long timeout, unsigned long duration);
 void setFuelSchedule4(unsigned long timeout, unsigned long duration);
-//void setFuelSchedule5(void (*startCallback)(), unsigned long timeout, unsigned long duration, void(*endCallback)()); //Schedule 5 remains a special case for now due to the way it's implemented 
 void setFuelSchedule5(unsigned long timeout, unsigned long duration);
 void setFuelSchedule6(unsigned long timeout, unsigned long duration);
 void setFuelSchedule7(unsigned long timeout, unsigned long duration);
@@ -106,10 +110,41 @@ void setIgnitionSchedule6(void (*startCallback)(), unsigned long timeout, unsign
 void setIgnitionSchedule7(void (*startCallback)(), unsigned long timeout, unsigned long duration, void(*endCallback)());
 void setIgnitionSchedule8(void (*startCallback)(), unsigned long timeout, unsigned long duration, void(*endCallback)());
 
-inline void refreshIgnitionSchedule1(unsigned long timeToEnd) __attribute__((always_inline));
+/*
+Moves the end (ie the spark) of an ignition schedule that is already running to timeToEnd uS from now. The channel is the schedule index (Channel 1 is index 0).
+This is ignored if the schedule isn't running, or if timeToEnd is longer than the scheduled duration or too short to be set safely (IGNITION_REFRESH_THRESHOLD).
+*/
+void refreshIgnitionSchedule(uint8_t channel, unsigned long timeToEnd);
+
+/*
+Sets the maximum time (In uS) that any coil can be charging for, or 0 to turn the limit off.
+The limit is armed on each ignition channel as the coil starts charging, by bringing the end of the schedule forward if
+it would be later than this. The overdwell cut off is therefore just the normal end (spark) interrupt, rather than a check
+in the 1ms interrupt.
+*/
+void setIgnitionDwellLimit(unsigned long dwellLimit);
+
+/*
+Add an event to the back of a channel's queue, to be run after the events already 
+scheduled on that channel. The channel is the schedule index (Channel 1 is index 0).
+If the channel is OFF, the event starts immediately (As per setFuelSchedule*() / setIgnitionSchedule*()).
+The caller must ensure the event starts after the end of the previously queued event.
+For ignition, the callbacks are only used if the channel is OFF. Otherwise the event uses the current callbacks.
+Returns false if the queue is full (The event is dropped), the timeout is too long or the channel does not exist.
+*/
+bool queueFuelSchedule(uint8_t channel, unsigned long timeout, unsigned long duration);
+bool queueIgnitionSchedule(uint8_t channel, void (*startCallback)(), unsigned long timeout, unsigned long duration, void(*endCallback)());
+/*
+Angle domain (Per tooth) injection. Rather than the main loop converting the angle until each injection to a time, it
+leaves the start angle of each channel with setFuelScheduleAngle() and the decoder calls setFuelSchedulesFromTooth() on every tooth.
+Each schedule is then set from the last tooth before its start angle, so the time being predicted is always less than
+one tooth gap and is barely affected by the engine accelerating. See configPage10.perToothInj
+*/
+void setFuelScheduleAngle(uint8_t channel, uint16_t startAngle, unsigned long duration, bool enabled);
+void setFuelSchedulesFromTooth(uint16_t toothAngle, uint16_t angleToNextTooth);
 
 //The ARM cores use separate functions for their ISRs
-#if defined(ARDUINO_ARCH_STM32) || defined(CORE_TEENSY)
+#if defined(ARDUINO_ARCH_STM32) || defined(CORE_TEENSY) || defined(CORE_NATIVE)
   static inline void fuelSchedule1Interrupt(void);
   static inline void fuelSchedule2Interrupt(void);
   static inline void fuelSchedule3Interrupt(void);
@@ -167,17 +202,14 @@ struct Schedule {
   volatile byte schedulesSet;     ///< A counter of how many times the schedule has been set
   void (*StartCallback)();        ///< Start Callback function for schedule
   void (*EndCallback)();          ///< End Callback function for schedule
-  volatile unsigned long startTime; /**< The system time (in uS) that the schedule started, used by the overdwell protection in timers.ino */
-  volatile COMPARE_TYPE startCompare; ///< The counter value of the timer when this will start
+  volatile COMPARE_TYPE startCompare; ///< The counter value of the timer when this will start. Once running, the counter value when it did start (Used by the dwell limit)
   volatile COMPARE_TYPE endCompare;   ///< The counter value of the timer when this will end
 
-  COMPARE_TYPE nextStartCompare;      ///< Planned start of next schedule (when current schedule is RUNNING)
-  COMPARE_TYPE nextEndCompare;        ///< Planned end of next schedule (when current schedule is RUNNING)
-  volatile bool hasNextSchedule = false; ///< Enable flag for planned next schedule (when current schedule is RUNNING)
+  scheduleQueue<COMPARE_TYPE> queue; ///< The events to run after the current one (See schedule_queue.h)
   volatile bool endScheduleSetByDecoder = false;
 };
 /** Fuel injection schedule.
-* Fuel schedules don't use the callback pointers, or the startTime/endScheduleSetByDecoder variables.
+* Fuel schedules don't use the callback pointers, or the endScheduleSetByDecoder variable.
 * They are removed in this struct to save RAM.
 */
 struct FuelSchedule {
@@ -187,104 +219,68 @@ struct FuelSchedule {
   volatile COMPARE_TYPE startCompare; ///< The counter value of the timer when this will start
   volatile COMPARE_TYPE endCompare;   ///< The counter value of the timer when this will end
 
-  COMPARE_TYPE nextStartCompare;
-  COMPARE_TYPE nextEndCompare;
-  volatile bool hasNextSchedule = false;
+  scheduleQueue<COMPARE_TYPE> queue; ///< The events to run after the current one (See schedule_queue.h)
 };
 
-//volatile Schedule *timer3Aqueue[4];
-//Schedule *timer3Bqueue[4];
-//Schedule *timer3Cqueue[4];
-
-extern FuelSchedule fuelSchedule1;
-extern FuelSchedule fuelSchedule2;
-extern FuelSchedule fuelSchedule3;
-extern FuelSchedule fuelSchedule4;
-extern FuelSchedule fuelSchedule5;
-extern FuelSchedule fuelSchedule6;
-extern FuelSchedule fuelSchedule7;
-extern FuelSchedule fuelSchedule8;
-
-extern Schedule ignitionSchedule1;
-extern Schedule ignitionSchedule2;
-extern Schedule ignitionSchedule3;
-extern Schedule ignitionSchedule4;
-extern Schedule ignitionSchedule5;
-extern Schedule ignitionSchedule6;
-extern Schedule ignitionSchedule7;
-extern Schedule ignitionSchedule8;
-
-//IgnitionSchedule nullSchedule; //This is placed at the end of the queue. It's status will always be set to OFF and hence will never perform any action within an ISR
-
-static inline COMPARE_TYPE setQueue(volatile Schedule *queue[], Schedule *schedule1, Schedule *schedule2, unsigned int CNT)
-{
-  //Create an array of all the upcoming targets, relative to the current count on the timer
-  unsigned int tmpQueue[4];
+#define SCHEDULE_CHANNELS 8 ///< The number of fuel and of ignition schedules
 
-  //Set the initial queue state. This order matches the tmpQueue order
-  if(schedule1->Status == OFF)
-  {
-    queue[0] = schedule2;
-    queue[1] = schedule2;
-    tmpQueue[0] = schedule2->startCompare - CNT;
-    tmpQueue[1] = schedule2->endCompare - CNT;
-  }
-  else
-  {
-    queue[0] = schedule1;
-    queue[1] = schedule1;
-    tmpQueue[0] = schedule1->startCompare - CNT;
-    tmpQueue[1] = schedule1->endCompare - CNT;
-  }
-
-  if(schedule2->Status == OFF)
-  {
-    queue[2] = schedule1;
-    queue[3] = schedule1;
-    tmpQueue[2] = schedule1->startCompare - CNT;
-    tmpQueue[3] = schedule1->endCompare - CNT;
-  }
-  else
-  {
-    queue[2] = schedule2;
-    queue[3] = schedule2;
-    tmpQueue[2] = schedule2->startCompare - CNT;
-    tmpQueue[3] = schedule2->endCompare - CNT;
-  }
+/** Angle domain fuel schedule. The request from the main loop for a channel when per tooth injection is in use. See setFuelScheduleAngle()
+*/
+struct FuelAngleSchedule {
+  volatile uint16_t startAngle;     ///< The crank angle (0 to CRANK_ANGLE_MAX_INJ) the injector should open at
+  volatile unsigned long duration;  ///< Scheduled duration (uS)
+  volatile bool enabled;            ///< Whether the channel should be injecting at all (Eg. It is false during fuel cut)
+  uint32_t lastSetAngle;            ///< The value of fuelAngleToothTotal (See scheduler.ino) when the schedule was last set. Only used by setFuelSchedulesFromTooth()
+};
 
+/** The schedules, indexed by channel (Channel 1 is index 0). */
+extern FuelSchedule fuelSchedules[SCHEDULE_CHANNELS];
+extern Schedule ignitionSchedules[SCHEDULE_CHANNELS];
+extern FuelAngleSchedule fuelAngleSchedules[INJ_CHANNELS];
 
-  //Sort the queues. Both queues are kept in sync.
-  //This implements a sorting networking based on the Bose-Nelson sorting network
-  //See: pages.ripco.net/~jgamble/nw.html
-  #define SWAP(x,y) if(tmpQueue[y] < tmpQueue[x]) { unsigned int tmp = tmpQueue[x]; tmpQueue[x] = tmpQueue[y]; tmpQueue[y] = tmp; volatile Schedule *tmpS = queue[x]; queue[x] = queue[y]; queue[y] = tmpS; }
-  /*SWAP(0, 1); */ //Likely not needed
-  /*SWAP(2, 3); */ //Likely not needed
-  SWAP(0, 2);
-  SWAP(1, 3);
-  SWAP(1, 2);
+/** @name ScheduleAliases
+ * Named aliases for each schedule. These are constant references, so resolve to 
+ * the array element at compile time with no runtime overhead.
+ * @{
+*/
+static constexpr FuelSchedule &fuelSchedule1 = fuelSchedules[0];
+static constexpr FuelSchedule &fuelSchedule2 = fuelSchedules[1];
+static constexpr FuelSchedule &fuelSchedule3 = fuelSchedules[2];
+static constexpr FuelSchedule &fuelSchedule4 = fuelSchedules[3];
+static constexpr FuelSchedule &fuelSchedule5 = fuelSchedules[4];
+static constexpr FuelSchedule &fuelSchedule6 = fuelSchedules[5];
+static constexpr FuelSchedule &fuelSchedule7 = fuelSchedules[6];
+static constexpr FuelSchedule &fuelSchedule8 = fuelSchedules[7];
+
+static constexpr Schedule &ignitionSchedule1 = ignitionSchedules[0];
+static constexpr Schedule &ignitionSchedule2 = ignitionSchedules[1];
+static constexpr Schedule &ignitionSchedule3 = ignitionSchedules[2];
+static constexpr Schedule &ignitionSchedule4 = ignitionSchedules[3];
+static constexpr Schedule &ignitionSchedule5 = ignitionSchedules[4];
+static constexpr Schedule &ignitionSchedule6 = ignitionSchedules[5];
+static constexpr Schedule &ignitionSchedule7 = ignitionSchedules[6];
+static constexpr Schedule &ignitionSchedule8 = ignitionSchedules[7];
+/** @} */
 
-  //Return the next compare time in the queue
-  return tmpQueue[0] + CNT; //Return the
-}
+extern volatile COMPARE_TYPE ignitionDwellLimitTicks; ///< The dwell limit in timer ticks, or 0 if it is off. See setIgnitionDwellLimit()
 
-/*
- * Moves all the Schedules in a queue forward one position.
- * The current item (0) is discarded
- * The final queue slot is set to nullSchedule to indicate that no action should be taken
+/** Returns the end compare for a running ignition schedule that should end ticksToEnd timer ticks after now (The current
+ * counter value). This is brought forward if needed so the coil isn't charged for longer than the dwell limit.
+ * Anything that moves the end of a running schedule must go through this.
+ * A coil that has already been charging for (close to) the limit would have its end brought forward to a count the
+ * timer is at or has already passed, where it would not be matched until the timer wraps around (Leaving the coil
+ * charging). That end is put IGNITION_REFRESH_THRESHOLD after now instead, so the spark happens straight away
  */
-static inline unsigned int popQueue(volatile Schedule *queue[])
+static inline COMPARE_TYPE limitIgnitionEndCompare(const Schedule &schedule, COMPARE_TYPE now, COMPARE_TYPE ticksToEnd)
 {
-  queue[0] = queue[1];
-  queue[1] = queue[2];
-  queue[2] = queue[3];
-  //queue[3] = &nullSchedule;
-
-  unsigned int returnCompare;
-  if( queue[0]->Status == PENDING ) { returnCompare = queue[0]->startCompare; }
-  else { returnCompare = queue[0]->endCompare; }
-
-  return returnCompare;
+  COMPARE_TYPE endCompare = now + ticksToEnd;
+  if( (ignitionDwellLimitTicks > 0U) && ((COMPARE_TYPE)(endCompare - schedule.startCompare) > ignitionDwellLimitTicks) )
+  {
+    const COMPARE_TYPE minimumTicks = uS_TO_TIMER_COMPARE(IGNITION_REFRESH_THRESHOLD);
+    if( (COMPARE_TYPE)(now - schedule.startCompare) >= (COMPARE_TYPE)(ignitionDwellLimitTicks - minimumTicks) ) { endCompare = now + minimumTicks; }
+    else { endCompare = schedule.startCompare + ignitionDwellLimitTicks; }
+  }
+  return endCompare;
 }
 
-
 #endif // SCHEDULER_H
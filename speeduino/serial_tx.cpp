@@ -0,0 +1,110 @@
+/*
+Speeduino - Simple engine management for the Arduino Mega 2560 platform
+Copyright (C) Josh Stewart
+A full copy of the license may be found in the projects root directory
+*/
+/** @file
+ * The non-blocking serial transmit queue. See serial_tx.h
+ */
+#include <string.h>
+#include "serial_tx.h"
+
+void serialTx_init(serialTxQueue &queue, const serialTxPort *pPort, FastCRC32 *pCRCEngine)
+{
+  queue.pPort = pPort;
+  queue.pCRCEngine = pCRCEngine;
+  queue.sent = 0;
+  queue.head = 0;
+  queue.tail = 0;
+}
+
+/* The next free entry, with everything but the data cleared. NULL if the queue is full */
+static serialTxEntry *nextEntry(serialTxQueue &queue, uint8_t type, uint16_t length)
+{
+  if(serialTx_available(queue) == 0U) { return NULL; }
+  serialTxEntry *pEntry = &queue.entries[queue.tail & SERIAL_TX_QUEUE_MASK];
+  pEntry->pData = NULL;
+  pEntry->pCRC = NULL;
+  pEntry->onComplete = NULL;
+  pEntry->length = length;
+  pEntry->type = type;
+  return pEntry;
+}
+
+/** Queues a buffer to be sent. The buffer must not change until onComplete is called.
+ * @param pCRC The bytes are added to this CRC as they are sent. NULL if not needed
+ * @param onComplete Called (From serialTx_service()) once all of the buffer has been written. NULL if not needed
+ * @return false if the queue is full
+ */
+bool serialTx_queueBuffer(serialTxQueue &queue, const uint8_t *pData, uint16_t length, crcStream *pCRC, serialTxCallback onComplete)
+{
+  serialTxEntry *pEntry = nextEntry(queue, SERIAL_TX_BUFFER, length);
+  if(pEntry == NULL) { return false; }
+  pEntry->pData = pData;
+  pEntry->pCRC = pCRC;
+  pEntry->onComplete = onComplete;
+  queue.tail++;
+  return true;
+}
+
+/** Queues a copy of a few bytes (At most SERIAL_TX_INLINE_SIZE)
+ * @return false if the queue is full
+ */
+bool serialTx_queueBytes(serialTxQueue &queue, const uint8_t *pData, uint8_t length)
+{
+  if(length > SERIAL_TX_INLINE_SIZE) { return false; }
+  serialTxEntry *pEntry = nextEntry(queue, SERIAL_TX_BYTES, length);
+  if(pEntry == NULL) { return false; }
+  memcpy(pEntry->inlineData, pData, length);
+  queue.tail++;
+  return true;
+}
+
+/** Queues the result of a running CRC, which is worked out once everything queued before it has been sent
+ * @return false if the queue is full
+ */
+bool serialTx_queueCRC(serialTxQueue &queue, crcStream *pCRC)
+{
+  serialTxEntry *pEntry = nextEntry(queue, SERIAL_TX_CRC, 4);
+  if(pEntry == NULL) { return false; }
+  pEntry->pCRC = pCRC;
+  queue.tail++;
+  return true;
+}
+
+/** Writes as much of the queue as the port can take without blocking. Called from the main loop */
+void serialTx_service(serialTxQueue &queue)
+{
+  while(serialTx_isBusy(queue) == true)
+  {
+    serialTxEntry &entry = queue.entries[queue.head & SERIAL_TX_QUEUE_MASK];
+    if( (entry.type == SERIAL_TX_CRC) && (queue.sent == 0U) )
+    {
+      uint32_t crc = crcStream_end(*entry.pCRC);
+      entry.inlineData[0] = (uint8_t)(crc >> 24);
+      entry.inlineData[1] = (uint8_t)(crc >> 16);
+      entry.inlineData[2] = (uint8_t)(crc >> 8);
+      entry.inlineData[3] = (uint8_t)crc;
+    }
+
+    uint16_t length = entry.length - queue.sent;
+    if(length > 0U)
+    {
+      uint16_t space = queue.pPort->space();
+      if(space == 0U) { return; }
+      if(length > space) { length = space; }
+
+      const uint8_t *pData = (entry.type == SERIAL_TX_BUFFER) ? &entry.pData[queue.sent] : &entry.inlineData[queue.sent];
+      uint16_t written = queue.pPort->write(pData, length);
+      if( (entry.type == SERIAL_TX_BUFFER) && (entry.pCRC != NULL) ) { crcStream_update(*queue.pCRCEngine, *entry.pCRC, pData, written); }
+      queue.sent += written;
+      if(queue.sent < entry.length) { return; } //The port is full
+    }
+
+    //The entry is complete. It is removed before the callback, so that can queue more
+    serialTxCallback onComplete = entry.onComplete;
+    queue.sent = 0;
+    queue.head++;
+    if(onComplete != NULL) { onComplete(); }
+  }
+}
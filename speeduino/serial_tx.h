@@ -0,0 +1,81 @@
+/*
+A non-blocking transmit queue for the serial port, used by the serial protocol (See sendSerialPayload() in comms.cpp).
+
+Messages are queued as whole buffers rather than written a byte at a time. serialTx_service() (Called from the main
+loop) then hands the port as much of them as it can take without blocking, in as few writes as possible, and calls
+the completion callback of each buffer once all of it has been accepted. Each buffer is sent from where it is (It is
+not copied), so must not change until then.
+
+The port is a pair of functions (See serialTxPort), so the queue can drive anything that can report how much it can
+take: The serial driver's own ring buffer (Large on the ARM boards) or a DMA transfer. The tests use a port on the host.
+
+There are 3 kinds of entry:
+- Buffer: A buffer that is sent as it is. The bytes can also be added to a running CRC (See crc_stream.h) as they are sent
+- Bytes: Up to SERIAL_TX_INLINE_SIZE bytes that are copied into the queue (Eg. A length header)
+- CRC: The 4 byte (Big endian) result of a running CRC. This is worked out when the entry is reached, so can follow the
+  buffers that are added to it
+*/
+#ifndef SERIAL_TX_H
+#define SERIAL_TX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "crc_stream.h"
+
+#ifndef SERIAL_TX_QUEUE_SIZE
+  #define SERIAL_TX_QUEUE_SIZE  4 ///< The number of entries the queue can hold. Must be a power of 2
+#endif
+#define SERIAL_TX_QUEUE_MASK    (SERIAL_TX_QUEUE_SIZE - 1U)
+#define SERIAL_TX_INLINE_SIZE   4 ///< The most bytes that a bytes entry can hold
+
+static_assert((SERIAL_TX_QUEUE_SIZE & SERIAL_TX_QUEUE_MASK) == 0, "SERIAL_TX_QUEUE_SIZE must be a power of 2");
+static_assert(SERIAL_TX_QUEUE_SIZE <= 128, "SERIAL_TX_QUEUE_SIZE must fit in the 8-bit queue indices");
+
+#define SERIAL_TX_BUFFER        0
+#define SERIAL_TX_BYTES         1
+#define SERIAL_TX_CRC           2
+
+typedef void (*serialTxCallback)(void);
+
+struct serialTxPort {
+  uint16_t (*space)(void);                                  ///< The number of bytes that can be written without blocking
+  uint16_t (*write)(const uint8_t *pData, uint16_t length); ///< Writes at most space() bytes. Returns the number written
+};
+
+struct serialTxEntry {
+  const uint8_t *pData;         ///< Buffer entries: The bytes to send
+  crcStream *pCRC;              ///< Buffer entries: The CRC the bytes are added to (Or NULL). CRC entries: The CRC to send
+  serialTxCallback onComplete;  ///< Called once all of the entry has been written to the port (Or NULL)
+  uint16_t length;
+  uint8_t type;                 ///< SERIAL_TX_BUFFER, SERIAL_TX_BYTES or SERIAL_TX_CRC
+  uint8_t inlineData[SERIAL_TX_INLINE_SIZE]; ///< Bytes and CRC entries: The bytes to send
+};
+
+struct serialTxQueue {
+  const serialTxPort *pPort;
+  FastCRC32 *pCRCEngine;  ///< Used to add buffers to their running CRC
+  serialTxEntry entries[SERIAL_TX_QUEUE_SIZE];
+  uint16_t sent;          ///< The number of bytes of the first entry that have been written
+  uint8_t head;           ///< The first entry. Free running, masked when indexing entries
+  uint8_t tail;           ///< The next free entry. Free running, masked when indexing entries
+};
+
+void serialTx_init(serialTxQueue &queue, const serialTxPort *pPort, FastCRC32 *pCRCEngine);
+bool serialTx_queueBuffer(serialTxQueue &queue, const uint8_t *pData, uint16_t length, crcStream *pCRC, serialTxCallback onComplete);
+bool serialTx_queueBytes(serialTxQueue &queue, const uint8_t *pData, uint8_t length);
+bool serialTx_queueCRC(serialTxQueue &queue, crcStream *pCRC);
+void serialTx_service(serialTxQueue &queue);
+
+/** The number of entries that can be added */
+static inline uint8_t serialTx_available(const serialTxQueue &queue)
+{
+  return SERIAL_TX_QUEUE_SIZE - (uint8_t)(queue.tail - queue.head);
+}
+
+/** Whether there is anything still to be written to the port */
+static inline bool serialTx_isBusy(const serialTxQueue &queue)
+{
+  return queue.head != queue.tail;
+}
+
+#endif // SERIAL_TX_H
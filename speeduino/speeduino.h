@@ -31,6 +31,7 @@ void calculateIgnitionAngle6(int dwellAngle);
 void calculateIgnitionAngle7(int dwellAngle);
 void calculateIgnitionAngle8(int dwellAngle);
 void calculateIgnitionAngles(int dwellAngle);
+void refreshIgnitionEndAngle(uint8_t channel, int endAngle, int channelDegrees, int crankAngle);
 
 extern uint16_t req_fuel_uS; /**< The required fuel variable (As calculated by TunerStudio) in uS */
 extern uint16_t inj_opentime_uS; /**< The injector opening time. This is set within Tuner Studio, but stored here in uS rather than mS */
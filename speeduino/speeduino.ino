@@ -43,6 +43,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "secondaryTables.h"
 #include "canBroadcast.h"
 #include "SD_logger.h"
+#include "isr_stats.h"
 #include RTC_LIB_H //Defined in each boards .h file
 #include BOARD_H //Note that this is not a real file, it is defined in globals.h. 
 
@@ -93,7 +94,9 @@ void setup(void)
 
 inline uint16_t applyFuelTrimToPW(trimTable3d *pTrimTable, int16_t fuelLoad, int16_t RPM, uint16_t currentPW)
 {
-    unsigned long pw1percent = 100 + get3DTableValue(pTrimTable, fuelLoad, RPM) - OFFSET_FUELTRIM;
+    //All trim tables are looked up with the same inputs & usually have the same axes. Only the first call in each loop resolves the context
+    resolve3DTableLookup(&trimLookupContext, &trim1Table, fuelLoad, RPM);
+    unsigned long pw1percent = 100 + get3DTableValue(pTrimTable, &trimLookupContext, fuelLoad, RPM) - OFFSET_FUELTRIM;
     if (pw1percent != 100) { return div100(pw1percent * currentPW); }
     return currentPW;
 }
@@ -128,20 +131,14 @@ void loop(void)
       //Perform the same check for the tooth and composite logs
       if( toothLogSendInProgress == true)
       {
-        if(Serial.availableForWrite() > 16) 
-        { 
-          if(legacySerial == true) { sendToothLog_legacy(inProgressOffset); }
-          else { sendToothLog(inProgressOffset); }
-        }
+        if(Serial.availableForWrite() > 16) { sendToothLog_legacy(inProgressOffset); }
       }
       if( compositeLogSendInProgress == true)
       {
-        if(Serial.availableForWrite() > 16) { sendCompositeLog(inProgressOffset); }
-      }
-      if(serialWriteInProgress == true)
-      {
-        if(Serial.availableForWrite() > 16) { continueSerialTransmission(); }
+        if(Serial.availableForWrite() > 16) { sendCompositeLog_legacy(inProgressOffset); }
       }
+      //Write any more of the queued response (Including the tooth and composite logs) that the tx buffer can take
+      continueSerialTransmission();
 
       //Check for any new requests from serial.
       //if ( (Serial.available()) > 0) { command(); }
@@ -286,7 +283,7 @@ void loop(void)
       }
 
       //And check whether the tooth log buffer is ready
-      if(toothHistoryIndex > TOOTH_LOG_SIZE) { BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
+      if(toothLog_isReady(toothLog) == true) { BIT_SET(currentStatus.status1, BIT_STATUS1_TOOTHLOG1READY); }
 
       
 
@@ -420,6 +417,9 @@ void loop(void)
     {
       BIT_CLEAR(TIMER_mask, BIT_TIMER_1HZ);
       readBaro(); //Infrequent baro readings are not an issue.
+      #ifdef ISR_STATS
+        updateISRStats();
+      #endif
 
       if ( (configPage10.wmiEnabled > 0) && (configPage10.wmiIndicatorEnabled > 0) )
       {
@@ -795,7 +795,12 @@ void loop(void)
       }
       currentStatus.dwell = correctionsDwell(currentStatus.dwell);
 
-      int dwellAngle = timeToAngle(currentStatus.dwell, CRANKMATH_METHOD_INTERVAL_REV); //Convert the dwell time to dwell angle based on the current engine speed
+      //The dwell limit is armed by the scheduler as each coil starts charging
+      bool isCrankLocked = configPage4.ignCranklock && (currentStatus.RPM < currentStatus.crankRPM); //Dwell limiter is disabled during cranking on setups using the locked cranking timing. WE HAVE to do the RPM check here as relying on the engine cranking bit can be potentially too slow in updating
+      if( (configPage4.useDwellLim == true) && (isCrankLocked == false) ) { setIgnitionDwellLimit(dwellLimit_uS); }
+      else { setIgnitionDwellLimit(0); }
+
+      int dwellAngle = timeToAngle(currentStatus.dwell, CRANKMATH_METHOD_INTERVAL_DEFAULT); //Convert the dwell time to dwell angle based on the current engine speed
 
       calculateIgnitionAngles(dwellAngle);
 
@@ -885,8 +890,35 @@ void loop(void)
       } //Protection active check
       else { curRollingCut = 0; } //Disables the rolling hard cut
 
+      if( (configPage10.perToothInj == true) && BIT_CHECK(decoderState, BIT_DECODER_PER_TOOTH_INJ) )
+      {
+        //Per tooth injection. The decoder sets the schedules from the last tooth before each start angle (See setFuelSchedulesFromTooth()), so only the angles need to be passed on
+        bool fuelEnabled = fuelOn && !BIT_CHECK(currentStatus.status1, BIT_STATUS1_BOOSTCUT);
+        setFuelScheduleAngle(0, injector1StartAngle, currentStatus.PW1, fuelEnabled && (currentStatus.PW1 >= inj_opentime_uS));
+#if INJ_CHANNELS >= 2
+        setFuelScheduleAngle(1, injector2StartAngle, currentStatus.PW2, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ2_CMD_BIT) && (currentStatus.PW2 >= inj_opentime_uS));
+#endif
+#if INJ_CHANNELS >= 3
+        setFuelScheduleAngle(2, injector3StartAngle, currentStatus.PW3, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ3_CMD_BIT) && (currentStatus.PW3 >= inj_opentime_uS));
+#endif
+#if INJ_CHANNELS >= 4
+        setFuelScheduleAngle(3, injector4StartAngle, currentStatus.PW4, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ4_CMD_BIT) && (currentStatus.PW4 >= inj_opentime_uS));
+#endif
+#if INJ_CHANNELS >= 5
+        setFuelScheduleAngle(4, injector5StartAngle, currentStatus.PW5, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ5_CMD_BIT) && (currentStatus.PW5 >= inj_opentime_uS));
+#endif
+#if INJ_CHANNELS >= 6
+        setFuelScheduleAngle(5, injector6StartAngle, currentStatus.PW6, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ6_CMD_BIT) && (currentStatus.PW6 >= inj_opentime_uS));
+#endif
+#if INJ_CHANNELS >= 7
+        setFuelScheduleAngle(6, injector7StartAngle, currentStatus.PW7, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ7_CMD_BIT) && (currentStatus.PW7 >= inj_opentime_uS));
+#endif
+#if INJ_CHANNELS >= 8
+        setFuelScheduleAngle(7, injector8StartAngle, currentStatus.PW8, fuelEnabled && BIT_CHECK(channelInjEnabled, INJ8_CMD_BIT) && (currentStatus.PW8 >= inj_opentime_uS));
+#endif
+      }
 #if INJ_CHANNELS >= 1
-      if (fuelOn && !BIT_CHECK(currentStatus.status1, BIT_STATUS1_BOOSTCUT))
+      else if (fuelOn && !BIT_CHECK(currentStatus.status1, BIT_STATUS1_BOOSTCUT))
       {
         if(currentStatus.PW1 >= inj_opentime_uS)
         {
@@ -1083,33 +1115,13 @@ void loop(void)
           
           setIgnitionSchedule1(ign1StartFunction,
                     //((unsigned long)(ignition1StartAngle - crankAngle) * (unsigned long)timePerDegree),
-                    angleToTime((ignition1StartAngle - crankAngle), CRANKMATH_METHOD_INTERVAL_REV),
+                    angleToTime((ignition1StartAngle - crankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT),
                     currentStatus.dwell + fixedCrankingOverride, //((unsigned long)((unsigned long)currentStatus.dwell* currentStatus.RPM) / newRPM) + fixedCrankingOverride,
                     ign1EndFunction
                     );
         }
 #endif
 
-#if defined(USE_IGN_REFRESH)
-        if( (ignitionSchedule1.Status == RUNNING) && (ignition1EndAngle > crankAngle) && (configPage4.StgCycles == 0) && (configPage2.perToothIgn != true) )
-        {
-          unsigned long uSToEnd = 0;
-
-          crankAngle = getCrankAngle(); //Refresh with the latest crank angle
-          if (crankAngle > CRANK_ANGLE_MAX_IGN ) { crankAngle -= 360; }
-          
-          //ONLY ONE OF THE BELOW SHOULD BE USED (PROBABLY THE FIRST):
-          //*********
-          if(ignition1EndAngle > crankAngle) { uSToEnd = fastDegreesToUS( (ignition1EndAngle - crankAngle) ); }
-          else { uSToEnd = fastDegreesToUS( (360 + ignition1EndAngle - crankAngle) ); }
-          //*********
-          //uSToEnd = ((ignition1EndAngle - crankAngle) * (toothLastToothTime - toothLastMinusOneToothTime)) / triggerToothAngle;
-          //*********
-
-          refreshIgnitionSchedule1( uSToEnd + fixedCrankingOverride );
-        }
-  #endif
-        
 #if IGN_CHANNELS >= 2
         if (maxIgnOutputs >= 2)
         {
@@ -1120,7 +1132,7 @@ void loop(void)
 
             unsigned long ignition2StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule2.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition2StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition2StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition2StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition2StartTime = 0; }
 
@@ -1145,7 +1157,7 @@ void loop(void)
 
             unsigned long ignition3StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule3.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition3StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition3StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition3StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition3StartTime = 0; }
 
@@ -1170,7 +1182,7 @@ void loop(void)
 
             unsigned long ignition4StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule4.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition4StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition4StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition4StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition4StartTime = 0; }
 
@@ -1195,7 +1207,7 @@ void loop(void)
 
             unsigned long ignition5StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule5.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition5StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition5StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition5StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition5StartTime = 0; }
 
@@ -1220,7 +1232,7 @@ void loop(void)
 
             unsigned long ignition6StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule6.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition6StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition6StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition6StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition6StartTime = 0; }
 
@@ -1245,7 +1257,7 @@ void loop(void)
 
             unsigned long ignition7StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule7.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition7StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition7StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition7StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition7StartTime = 0; }
 
@@ -1270,7 +1282,7 @@ void loop(void)
 
             unsigned long ignition8StartTime = 0;
             if ( (tempStartAngle <= tempCrankAngle) && (ignitionSchedule8.Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_IGN; }
-            if(tempStartAngle > tempCrankAngle) { ignition8StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_REV); }
+            if(tempStartAngle > tempCrankAngle) { ignition8StartTime = angleToTime((tempStartAngle - tempCrankAngle), CRANKMATH_METHOD_INTERVAL_DEFAULT); }
             //else if (tempStartAngle < tempCrankAngle) { ignition8StartTime = ((long)(360 - tempCrankAngle + tempStartAngle) * (long)timePerDegree); }
             else { ignition8StartTime = 0; }
 
@@ -1285,6 +1297,38 @@ void loop(void)
         }
 #endif
 
+#if defined(USE_IGN_REFRESH)
+        //Correct the spark of any coils that are already charging for the latest crank speed. This isn't needed with the per tooth timing, as the decoder does it (See checkPerToothTiming())
+        if( (configPage4.StgCycles == 0) && (configPage2.perToothIgn != true) )
+        {
+          crankAngle = getCrankAngle(); //Refresh with the latest crank angle
+          while (crankAngle > CRANK_ANGLE_MAX_IGN ) { crankAngle -= CRANK_ANGLE_MAX_IGN; }
+
+          refreshIgnitionEndAngle(0, ignition1EndAngle, channel1IgnDegrees, crankAngle);
+#if IGN_CHANNELS >= 2
+          if (maxIgnOutputs >= 2) { refreshIgnitionEndAngle(1, ignition2EndAngle, channel2IgnDegrees, crankAngle); }
+#endif
+#if IGN_CHANNELS >= 3
+          if (maxIgnOutputs >= 3) { refreshIgnitionEndAngle(2, ignition3EndAngle, channel3IgnDegrees, crankAngle); }
+#endif
+#if IGN_CHANNELS >= 4
+          if (maxIgnOutputs >= 4) { refreshIgnitionEndAngle(3, ignition4EndAngle, channel4IgnDegrees, crankAngle); }
+#endif
+#if IGN_CHANNELS >= 5
+          if (maxIgnOutputs >= 5) { refreshIgnitionEndAngle(4, ignition5EndAngle, channel5IgnDegrees, crankAngle); }
+#endif
+#if IGN_CHANNELS >= 6
+          if (maxIgnOutputs >= 6) { refreshIgnitionEndAngle(5, ignition6EndAngle, channel6IgnDegrees, crankAngle); }
+#endif
+#if IGN_CHANNELS >= 7
+          if (maxIgnOutputs >= 7) { refreshIgnitionEndAngle(6, ignition7EndAngle, channel7IgnDegrees, crankAngle); }
+#endif
+#if IGN_CHANNELS >= 8
+          if (maxIgnOutputs >= 8) { refreshIgnitionEndAngle(7, ignition8EndAngle, channel8IgnDegrees, crankAngle); }
+#endif
+        }
+#endif
+
       } //Ignition schedules on
 
       if ( (!BIT_CHECK(currentStatus.status3, BIT_STATUS3_RESET_PREVENT)) && (resetControl == RESET_CONTROL_PREVENT_WHEN_RUNNING) ) 
@@ -1403,7 +1447,9 @@ byte getVE1(void)
     currentStatus.fuelLoad = (currentStatus.MAP * 100) / currentStatus.EMAP;
   }
   else { currentStatus.fuelLoad = currentStatus.MAP; } //Fallback position
-  tempVE = get3DTableValue(&fuelTable, currentStatus.fuelLoad, currentStatus.RPM); //Perform lookup into fuel map for RPM vs MAP value
+  //The other 16x16 maps looked up with the fuel load & RPM share this
+  resolve3DTableLookup(&fuelLookupContext, &fuelTable, currentStatus.fuelLoad, currentStatus.RPM);
+  tempVE = get3DTableValue(&fuelTable, &fuelLookupContext, currentStatus.fuelLoad, currentStatus.RPM); //Perform lookup into fuel map for RPM vs MAP value
 
   return tempVE;
 }
@@ -1432,7 +1478,7 @@ byte getAdvance1(void)
     //IMAP / EMAP
     currentStatus.ignLoad = (currentStatus.MAP * 100) / currentStatus.EMAP;
   }
-  tempAdvance = get3DTableValue(&ignitionTable, currentStatus.ignLoad, currentStatus.RPM) - OFFSET_IGNITION; //As above, but for ignition advance
+  tempAdvance = get3DTableValue(&ignitionTable, &fuelLookupContext, currentStatus.ignLoad, currentStatus.RPM) - OFFSET_IGNITION; //As above, but for ignition advance. Shares the fuel map lookup if the load and axes are the same
   tempAdvance = correctionsIgn(tempAdvance);
 
   return tempAdvance;
@@ -1448,6 +1494,26 @@ uint16_t calculateInjectorStartAngle(uint16_t PWdivTimerPerDegree, int16_t injCh
   return tempInjectorStartAngle;
 }
 
+/** Moves the spark of an ignition channel whose coil is already charging to match the current crank angle.
+ * The time until the spark is set when the coil starts charging, so without this any change in crank speed during the dwell would move the spark angle.
+ * @param channel The ignition channel (Channel 1 is index 0)
+ * @param endAngle The crank angle of the spark (ignitionNEndAngle)
+ * @param channelDegrees The number of crank degrees until the cylinder of this channel is at TDC (channelNIgnDegrees)
+ * @param crankAngle The current crank angle (0 to CRANK_ANGLE_MAX_IGN)
+ */
+void refreshIgnitionEndAngle(uint8_t channel, int endAngle, int channelDegrees, int crankAngle)
+{
+  //As when setting the schedules, the angles are realigned around the TDC of the channel so that the angle until the spark is always positive
+  int tempCrankAngle = crankAngle - channelDegrees;
+  if( tempCrankAngle < 0) { tempCrankAngle += CRANK_ANGLE_MAX_IGN; }
+  int tempEndAngle = endAngle - channelDegrees;
+  if( tempEndAngle < 0) { tempEndAngle += CRANK_ANGLE_MAX_IGN; }
+  if( tempEndAngle <= tempCrankAngle) { tempEndAngle += CRANK_ANGLE_MAX_IGN; }
+
+  //If the spark has already happened the time will be longer than the dwell, so the scheduler will ignore it
+  refreshIgnitionSchedule(channel, fastDegreesToUS( (tempEndAngle - tempCrankAngle) ) + fixedCrankingOverride);
+}
+
 void calculateIgnitionAngle1(int dwellAngle)
 {
   ignition1EndAngle = CRANK_ANGLE_MAX_IGN - currentStatus.advance;
@@ -0,0 +1,210 @@
+/** @file
+ * @brief Minimal Arduino core API for the native (host) board.
+ *
+ * Only the parts of the Arduino API that the firmware actually uses are provided.
+ * The implementation lives in NativeArduino.cpp and is backed by the simulated
+ * board state in board_native.ino (pins, timers, trigger wheel).
+ *
+ * This directory is only added to the include path by the native PlatformIO
+ * environment, so it never shadows a real Arduino core.
+ */
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+#include "pgmspace.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define NUM_DIGITAL_PINS 70
+#define NUM_ANALOG_INPUTS 16
+#define LED_BUILTIN 13
+#define NOT_AN_INTERRUPT -1
+
+//Analog pins follow the digital pins, as they do on the Mega 2560
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A4  58
+#define A5  59
+#define A6  60
+#define A7  61
+#define A8  62
+#define A9  63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitToggle(value, bit) ((value) ^= (1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+#define word(h, l) ((uint16_t)(((h) << 8) | (l)))
+#define sq(x) ((x)*(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+#ifdef __cplusplus
+template <typename T, typename U> static inline auto min(T a, U b) -> decltype(a<b ? a : b) { return (a<b) ? a : b; }
+template <typename T, typename U> static inline auto max(T a, U b) -> decltype(a>b ? a : b) { return (a>b) ? a : b; }
+#endif
+
+// ============================== Time ==========================
+
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Holds micros() at the given value until released. Used by the board to deliver an interrupt
+// at the time it should have occurred, rather than the (later) time the host got around to it.
+void nativeHoldMicros(uint32_t time);
+void nativeReleaseMicros(void);
+
+// Replaces the host clock with a virtual one, which is only moved by calling this function
+// (Or by delaying). Sets the virtual time in uS, then delivers any interrupts that became due.
+// To hit compare matches exactly, move the clock to each match in turn rather than past them.
+void nativeSetVirtualClock(uint32_t time);
+
+// ============================== Interrupts ==========================
+
+void interrupts(void);
+void noInterrupts(void);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+#define digitalPinToInterrupt(p) ((p) < NUM_DIGITAL_PINS ? (p) : NOT_AN_INTERRUPT)
+
+// The interrupt state, which is delivered by the board (See board_native.ino)
+struct native_pin_interrupt_t {
+  void (*handler)(void);
+  int mode;
+};
+extern native_pin_interrupt_t nativePinInterrupts[NUM_DIGITAL_PINS];
+extern volatile bool nativeInterruptsEnabled;
+
+// ============================== I/O ==========================
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+void analogReference(uint8_t mode);
+void analogReadResolution(int bits);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+// Every pin gets its own 8-bit "port" (As on the AVR) with a single bit set in the mask.
+// This keeps the direct port manipulation used by the scheduler outputs working.
+// Invalid pin numbers (E.g. from a blank config) all map to one extra, unused port.
+extern volatile uint8_t nativePortRegisters[NUM_DIGITAL_PINS + 1];
+#define digitalPinToPort(pin) ((pin) < NUM_DIGITAL_PINS ? (pin) : NUM_DIGITAL_PINS)
+#define digitalPinToBitMask(pin) (1U)
+#define portOutputRegister(port) (&nativePortRegisters[(port)])
+#define portInputRegister(port) (&nativePortRegisters[(port)])
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+char *itoa(int value, char *string, int radix);
+char *ltoa(long value, char *string, int radix);
+char *utoa(unsigned value, char *string, int radix);
+char *ultoa(unsigned long value, char *string, int radix);
+
+// ============================== Serial ==========================
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+/** @brief A host side stand in for HardwareSerial.
+ *
+ * If the SPEEDUINO_SERIAL environment variable names a device (E.g. a pty
+ * created with socat), the port is read from and written to that device.
+ * Otherwise reads return nothing and writes are discarded.
+ */
+class HardwareSerial
+{
+public:
+  explicit HardwareSerial(const char *envName) : _envName(envName), _fd(-1), _peek(-1) { }
+
+  void begin(unsigned long baud);
+  void end(void);
+  int available(void);
+  int availableForWrite(void);
+  int peek(void);
+  int read(void);
+  void flush(void) { }
+  size_t write(uint8_t value);
+  size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+  size_t readBytes(uint8_t *buffer, size_t length);
+  size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t *)buffer, length); }
+
+  size_t print(const __FlashStringHelper *str) { return write((const char*)str); }
+  size_t print(const char *str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+
+  size_t println(void) { return write("\r\n"); }
+  template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+  operator bool() const { return true; }
+
+private:
+  void open(void);
+  const char *_envName;
+  int _fd;
+  int _peek;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial3;
+
+// ============================== Sketch ==========================
+
+void setup(void);
+void loop(void);
+
+#endif // NATIVE_ARDUINO_H
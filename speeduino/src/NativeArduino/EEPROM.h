@@ -0,0 +1,39 @@
+/** @file
+ * @brief EEPROM emulation for the native (host) board.
+ *
+ * The EEPROM is a RAM buffer initialised to 0xFF (I.e. a blank chip).
+ * If the SPEEDUINO_EEPROM environment variable names a file, the buffer is
+ * loaded from that file at startup and every changed byte is written back to it,
+ * so tunes burnt from TunerStudio persist between runs.
+ */
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+#include <stdint.h>
+
+#define NATIVE_EEPROM_SIZE 4096 //Same as the ATmega2560
+
+class EEPROMClass {
+public:
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  void update(int address, uint8_t value) { if (read(address)!=value) { write(address, value); } }
+
+  template< typename T > T &get( int idx, T &t ){
+    uint8_t *ptr = (uint8_t*) &t;
+    for( int count = sizeof(T) ; count ; --count, ++idx )  { *ptr++ = read(idx); }
+    return t;
+  }
+
+  template< typename T > const T &put( int idx, const T &t ){
+    const uint8_t *ptr = (const uint8_t*) &t;
+    for( int count = sizeof(T) ; count ; --count, ++idx )  { update(idx, *ptr++); }
+    return t;
+  }
+
+  uint16_t length(void) { return NATIVE_EEPROM_SIZE; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // NATIVE_EEPROM_H
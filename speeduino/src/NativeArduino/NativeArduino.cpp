@@ -0,0 +1,376 @@
+/** @file
+ * @brief Implementation of the minimal Arduino core API for the native (host) board.
+ *
+ * Time comes from the host monotonic clock, so the firmware runs at full host speed.
+ * Alternatively, a test can switch to a virtual clock that only moves when told to (See nativeSetVirtualClock()).
+ * "Interrupts" are delivered by the board (see nativeServiceInterrupts() in board_native.ino)
+ * at well defined points: between main loop iterations, when interrupts are re-enabled,
+ * whenever the time is read and while delaying.
+ */
+#if defined(NATIVE_BOARD)
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "SPI.h"
+
+void nativeServiceInterrupts(void); //Implemented by the board, see board_native.ino
+void nativeBoardExit(void);         //Implemented by the board, see board_native.ino
+void nativeBoardBegin(void);        //Implemented by the board, see board_native.ino
+bool nativeBoardLoop(void);         //Implemented by the board, see board_native.ino
+
+// ============================== Time ==========================
+
+static struct timespec startTime;
+
+static void initTime(void)
+{
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+}
+
+static uint64_t elapsedMicros(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((uint64_t)(now.tv_sec - startTime.tv_sec) * 1000000ULL) + ((int64_t)now.tv_nsec - startTime.tv_nsec) / 1000;
+}
+
+static bool timeHeld = false;
+static uint32_t heldMicros;
+
+static bool virtualClock = false;
+static uint32_t virtualMicros;
+
+void nativeSetVirtualClock(uint32_t time)
+{
+  virtualMicros = time;
+  virtualClock = true;
+  nativeServiceInterrupts();
+}
+
+void nativeHoldMicros(uint32_t time)
+{
+  heldMicros = time;
+  timeHeld = true;
+}
+
+void nativeReleaseMicros(void)
+{
+  timeHeld = false;
+}
+
+unsigned long micros(void)
+{
+  if (timeHeld) { return heldMicros; }
+
+  //Reading the time is also a point at which pending interrupts are delivered. The firmware reads the time
+  //frequently, so this keeps the interrupt latency close to that of real hardware
+  nativeServiceInterrupts();
+  if (virtualClock) { return virtualMicros; }
+  //Wrap at 32-bits, as a real MCU does
+  return (uint32_t)elapsedMicros();
+}
+
+unsigned long millis(void)
+{
+  if (virtualClock) { return virtualMicros / 1000UL; }
+  return (uint32_t)(elapsedMicros() / 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  uint32_t start = micros();
+  while ((uint32_t)(micros() - start) < us)
+  {
+    //Nothing else moves a virtual clock while delaying
+    if (virtualClock) { nativeSetVirtualClock(virtualMicros + 1UL); }
+    else { nativeServiceInterrupts(); }
+  }
+}
+
+void delay(unsigned long ms)
+{
+  while (ms > 0UL)
+  {
+    delayMicroseconds(1000);
+    --ms;
+  }
+}
+
+// ============================== Interrupts ==========================
+
+volatile bool nativeInterruptsEnabled = true;
+
+void interrupts(void)
+{
+  nativeInterruptsEnabled = true;
+  nativeServiceInterrupts();
+}
+
+void noInterrupts(void)
+{
+  nativeInterruptsEnabled = false;
+}
+
+native_pin_interrupt_t nativePinInterrupts[NUM_DIGITAL_PINS];
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode)
+{
+  if (interruptNum < NUM_DIGITAL_PINS)
+  {
+    nativePinInterrupts[interruptNum].handler = userFunc;
+    nativePinInterrupts[interruptNum].mode = mode;
+  }
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+  if (interruptNum < NUM_DIGITAL_PINS)
+  {
+    nativePinInterrupts[interruptNum].handler = nullptr;
+  }
+}
+
+// ============================== I/O ==========================
+
+volatile uint8_t nativePortRegisters[NUM_DIGITAL_PINS + 1];
+uint16_t nativeAnalogValues[NUM_DIGITAL_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if ( (pin < NUM_DIGITAL_PINS) && (mode == INPUT_PULLUP) ) { nativePortRegisters[pin] = 1U; }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if (pin < NUM_DIGITAL_PINS) { nativePortRegisters[pin] = (val == LOW) ? 0U : 1U; }
+}
+
+int digitalRead(uint8_t pin)
+{
+  if (pin < NUM_DIGITAL_PINS) { return nativePortRegisters[pin] != 0U ? HIGH : LOW; }
+  return LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+  //Accept both channel numbers (0..15) and pin numbers (A0..A15)
+  if (pin < NUM_ANALOG_INPUTS) { pin = pin + A0; }
+  if (pin < NUM_DIGITAL_PINS) { return nativeAnalogValues[pin]; }
+  return 0;
+}
+
+void analogWrite(uint8_t pin, int val) { digitalWrite(pin, val > 127 ? HIGH : LOW); }
+void analogReference(uint8_t) { }
+void analogReadResolution(int) { }
+void tone(uint8_t, unsigned int, unsigned long) { }
+void noTone(uint8_t) { }
+
+long random(long howbig) { return howbig == 0 ? 0 : rand() % howbig; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+  if (in_max == in_min) { return out_min; } //Integer division by 0 gives 0 on ARM, rather than trapping
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+static char *format_radix(unsigned long value, bool negative, char *string, int radix)
+{
+  char buffer[sizeof(unsigned long)*CHAR_BIT + 2];
+  char *p = buffer + sizeof(buffer) - 1;
+  *p = '\0';
+  do
+  {
+    unsigned digit = (unsigned)(value % (unsigned)radix);
+    *--p = (char)(digit < 10U ? '0' + digit : 'a' + digit - 10U);
+    value = value / (unsigned)radix;
+  } while (value != 0UL);
+  if (negative) { *--p = '-'; }
+  return strcpy(string, p);
+}
+
+char *ltoa(long value, char *string, int radix) { return format_radix(value < 0 ? (unsigned long)(-value) : (unsigned long)value, value < 0 && radix == 10, string, radix); }
+char *itoa(int value, char *string, int radix) { return ltoa(value, string, radix); }
+char *ultoa(unsigned long value, char *string, int radix) { return format_radix(value, false, string, radix); }
+char *utoa(unsigned value, char *string, int radix) { return ultoa(value, string, radix); }
+
+// ============================== Serial ==========================
+
+HardwareSerial Serial("SPEEDUINO_SERIAL");
+HardwareSerial Serial3("SPEEDUINO_SERIAL3");
+
+void HardwareSerial::open(void)
+{
+  const char *path = getenv(_envName);
+  if ( (path != nullptr) && (_fd < 0) )
+  {
+    _fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (_fd < 0) { fprintf(stderr, "Unable to open %s (%s)\n", path, strerror(errno)); }
+  }
+}
+
+void HardwareSerial::begin(unsigned long) { open(); }
+
+void HardwareSerial::end(void)
+{
+  if (_fd >= 0) { ::close(_fd); }
+  _fd = -1;
+}
+
+int HardwareSerial::peek(void)
+{
+  if ( (_peek < 0) && (_fd >= 0) )
+  {
+    uint8_t value;
+    if (::read(_fd, &value, 1) == 1) { _peek = value; }
+  }
+  return _peek;
+}
+
+int HardwareSerial::available(void)
+{
+  if (peek() < 0) { return 0; }
+  //The peeked byte, plus whatever is still waiting in the device
+  int waiting = 0;
+  if (::ioctl(_fd, FIONREAD, &waiting) < 0) { waiting = 0; }
+  return 1 + waiting;
+}
+
+int HardwareSerial::read(void)
+{
+  int value = peek();
+  _peek = -1;
+  return value;
+}
+
+size_t HardwareSerial::readBytes(uint8_t *buffer, size_t length)
+{
+  size_t count = 0;
+  while ( (count < length) && (available() != 0) ) { buffer[count++] = (uint8_t)read(); }
+  return count;
+}
+
+int HardwareSerial::availableForWrite(void)
+{
+  return 64; //Same as the AVR TX buffer
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+  return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+  while ( (_fd >= 0) && (written < size) )
+  {
+    ssize_t result = ::write(_fd, buffer + written, size - written);
+    if (result > 0) { written += (size_t)result; }
+    else if ( (result < 0) && (errno != EAGAIN) ) { break; }
+  }
+  return size;
+}
+
+size_t HardwareSerial::print(long value, int base)
+{
+  char buffer[sizeof(long)*CHAR_BIT + 2];
+  return write(ltoa(value, buffer, base));
+}
+
+size_t HardwareSerial::print(unsigned long value, int base)
+{
+  char buffer[sizeof(long)*CHAR_BIT + 2];
+  return write(ultoa(value, buffer, base));
+}
+
+size_t HardwareSerial::print(double value, int digits)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return write(buffer);
+}
+
+SPIClass SPI;
+
+// ============================== EEPROM ==========================
+
+EEPROMClass EEPROM;
+static uint8_t eepromData[NATIVE_EEPROM_SIZE];
+static FILE *eepromFile = nullptr;
+
+static void initEEPROM(void)
+{
+  memset(eepromData, 0xFF, sizeof(eepromData));
+  const char *path = getenv("SPEEDUINO_EEPROM");
+  if (path != nullptr)
+  {
+    eepromFile = fopen(path, "r+b");
+    if (eepromFile == nullptr) { eepromFile = fopen(path, "w+b"); }
+    if (eepromFile != nullptr)
+    {
+      size_t count = fread(eepromData, 1, sizeof(eepromData), eepromFile);
+      if (count < sizeof(eepromData))
+      {
+        fseek(eepromFile, 0, SEEK_SET);
+        fwrite(eepromData, 1, sizeof(eepromData), eepromFile);
+        fflush(eepromFile);
+      }
+    }
+  }
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+  return (address >= 0) && (address < NATIVE_EEPROM_SIZE) ? eepromData[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+  if ( (address >= 0) && (address < NATIVE_EEPROM_SIZE) )
+  {
+    eepromData[address] = value;
+    if (eepromFile != nullptr)
+    {
+      fseek(eepromFile, address, SEEK_SET);
+      fputc(value, eepromFile);
+      fflush(eepromFile);
+    }
+  }
+}
+
+// ============================== Entry point ==========================
+
+/*
+Runs setup() once, then loop() until the optional loop count (first command line argument) is reached, or the board
+ends the program (E.g. when a trigger replay has finished, see board_native_replay.ino).
+A finite loop count allows a clean exit, which is required for gprof output.
+Unit tests provide their own entry point.
+*/
+#if !defined(UNIT_TEST)
+int main(int argc, char **argv)
+{
+  initTime();
+  initEEPROM();
+
+  unsigned long loopCount = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 0UL;
+
+  setup();
+  nativeBoardBegin();
+  for (unsigned long count = 0; (loopCount == 0UL) || (count < loopCount); ++count)
+  {
+    loop();
+    if (nativeBoardLoop() == false) { break; }
+  }
+  nativeBoardExit();
+
+  if (eepromFile != nullptr) { fclose(eepromFile); }
+  return 0;
+}
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+/** @file
+ * @brief SPI stub for the native (host) board.
+ *
+ * There are no SPI devices on the host, transfers simply return 0.
+ */
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+#include <stdint.h>
+
+#define SPI_HAS_TRANSACTION 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings {
+public:
+  SPISettings(uint32_t, uint8_t, uint8_t) { }
+  SPISettings(void) { }
+};
+
+class SPIClass {
+public:
+  void begin(void) { }
+  void end(void) { }
+  void beginTransaction(SPISettings) { }
+  void endTransaction(void) { }
+  uint8_t transfer(uint8_t) { return 0U; }
+  uint16_t transfer16(uint16_t) { return 0U; }
+};
+
+extern SPIClass SPI;
+
+#endif // NATIVE_SPI_H
@@ -0,0 +1,4 @@
+/** @file
+ * @brief AVR program memory compatibility for the native (host) board. See ../pgmspace.h
+ */
+#include "../pgmspace.h"
@@ -0,0 +1,30 @@
+/** @file
+ * @brief Program memory access for the native (host) board.
+ *
+ * The host has a single flat address space, so PROGMEM data is ordinary
+ * const data and the pgm_read_* functions are plain dereferences.
+ */
+#ifndef NATIVE_PGMSPACE_H
+#define NATIVE_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)   (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)   (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)  (*(const uint32_t *)(addr))
+#define pgm_read_float(addr)  (*(const float *)(addr))
+#define pgm_read_ptr(addr)    (*(const void * const *)(addr))
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+#define pgm_read_word_near(addr) pgm_read_word(addr)
+
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+
+#endif // NATIVE_PGMSPACE_H
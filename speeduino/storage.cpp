@@ -396,6 +396,7 @@ static inline eeprom_address_t load(table_axis_iterator it, eeprom_address_t add
 
 static inline eeprom_address_t loadTable(const void *pTable, table_type_t key, eeprom_address_t address)
 {
+  invalidate_table_axes(pTable, key);
   return load(y_rbegin(pTable, key),
                 load(x_begin(pTable, key), 
                   load(rows_begin(pTable, key), address)));
@@ -473,6 +474,8 @@ void loadConfig(void)
   loadTable(&boostTableLookupDuty, decltype(boostTableLookupDuty)::type_key, EEPROM_CONFIG15_MAP);
   load_range(EEPROM_CONFIG15_START, (byte *)&configPage15, (byte *)&configPage15+sizeof(configPage15));  
 
+  table2D_invalidateAllCaches();
+
   //*********************************************************************************************************************************************************************************
 }
 
@@ -492,6 +495,8 @@ void loadCalibration(void)
 
   EEPROM.get(EEPROM_CALIBRATION_CLT_BINS, cltCalibration_bins);
   EEPROM.get(EEPROM_CALIBRATION_CLT_VALUES, cltCalibration_values);
+
+  table2D_invalidateAllCaches();
 }
 
 /** Write calibration tables to EEPROM.
@@ -511,6 +516,9 @@ void writeCalibration(void)
 
   EEPROM.put(EEPROM_CALIBRATION_CLT_BINS, cltCalibration_bins);
   EEPROM.put(EEPROM_CALIBRATION_CLT_VALUES, cltCalibration_values);
+
+  //The calibration arrays are updated in place before being written, so the cached values are now stale
+  table2D_invalidateAllCaches();
 }
 
 void writeCalibrationPage(uint8_t pageNum)
@@ -530,6 +538,8 @@ void writeCalibrationPage(uint8_t pageNum)
     EEPROM.put(EEPROM_CALIBRATION_CLT_BINS, cltCalibration_bins);
     EEPROM.put(EEPROM_CALIBRATION_CLT_VALUES, cltCalibration_values);
   }
+
+  table2D_invalidateAllCaches();
 }
 
 static eeprom_address_t compute_crc_address(uint8_t pageNum)
@@ -4,38 +4,192 @@ This file is used for everything related to maps/tables including their definiti
 #ifndef TABLE_H
 #define TABLE_H
 
-#define SIZE_BYTE           8
-#define SIZE_INT            16
+#include <stdint.h>
 
 /*
-The 2D table can contain either 8-bit (byte) or 16-bit (int) values
-The valueSize variable should be set to either 8 or 16 to indicate this BEFORE the table is used
+The 2D table can contain either 8-bit or 16-bit (signed or unsigned) axis bins and values.
+The types are template parameters, so each lookup is specialised at compile time for
+the types of the table it is working on.
+The xSize, values and axisX members should be set BEFORE the table is used
 */
+template <typename axis_t, typename value_t>
 struct table2D {
-  //Used 5414 RAM with original version
-  byte valueSize;
-  byte axisSize;
-  byte xSize;
+  typedef axis_t axis_type;
+  typedef value_t value_type;
 
-  void *values;
-  void *axisX;
+  uint8_t xSize;
 
-  //int16_t *values16;
-  //int16_t *axisX16;
+  value_t *values;
+  axis_t *axisX;
 
   //Store the last X and Y coordinates in the table. This is used to make the next check faster
-  int16_t lastXMax;
-  int16_t lastXMin;
+  uint8_t lastXMax;
+  uint8_t lastXMin;
 
   //Store the last input and output for caching
   int16_t lastInput;
   int16_t lastOutput;
-  byte cacheTime; //Tracks when the last cache value was set so it can expire after x seconds. A timeout is required to pickup when a tuning value is changed, otherwise the old cached value will continue to be returned as the X value isn't changing. 
+  uint16_t cacheGeneration; //The value of table2D_cacheGeneration when lastOutput was calculated. The cache is only valid while the two match (See table2D_invalidateAllCaches())
 };
 
-int16_t table2D_getAxisValue(struct table2D *fromTable, byte X_in);
-int16_t table2D_getRawValue(struct table2D *fromTable, byte X_index);
+// The table types in use. Named <axis type>_<value type>
+typedef table2D<uint8_t, uint8_t> table2D_u8_u8;
+typedef table2D<uint8_t, uint16_t> table2D_u8_u16;
+typedef table2D<uint8_t, int16_t> table2D_u8_s16;
+typedef table2D<uint16_t, uint8_t> table2D_u16_u8;
+typedef table2D<uint16_t, uint16_t> table2D_u16_u16;
 
-int table2D_getValue(struct table2D *fromTable, int X_in);
+/*
+The 2D table data is held within the config pages (or the calibration arrays), so the
+code that writes it has no knowledge of which table(s) it belongs to. Instead, every
+table cache is tied to a global generation number: any write to the table data
+increments it, which invalidates the cache of every table at once.
+The generation is never 0, so a zero initialised table never has a valid cache.
+*/
+extern uint16_t table2D_cacheGeneration;
+
+/**
+ * @brief Invalidates the cached output of all 2D tables. Must be called whenever
+ * the axis or values of any 2D table are changed
+ */
+static inline void table2D_invalidateAllCaches(void)
+{
+  ++table2D_cacheGeneration;
+  if (table2D_cacheGeneration==0U) { table2D_cacheGeneration = 1; }
+}
+
+/**
+ * @brief Invalidates the cached output of a single 2D table
+ */
+template <typename axis_t, typename value_t>
+static inline void table2D_invalidateCache(table2D<axis_t, value_t> *pTable)
+{
+  pTable->cacheGeneration = 0;
+}
+
+/**
+ * @brief Returns an axis (bin) value from the 2D table
+ *
+ * @param fromTable
+ * @param X_in
+ * @return int16_t
+ */
+template <typename axis_t, typename value_t>
+static inline int16_t table2D_getAxisValue(const table2D<axis_t, value_t> *fromTable, uint8_t X_in)
+{
+  return fromTable->axisX[X_in];
+}
+
+/**
+ * @brief Returns an value from the 2D table given an index value. No interpolation is performed
+ *
+ * @param fromTable
+ * @param X_index
+ * @return int16_t
+ */
+template <typename axis_t, typename value_t>
+static inline int16_t table2D_getRawValue(const table2D<axis_t, value_t> *fromTable, uint8_t X_index)
+{
+  return fromTable->values[X_index];
+}
+
+/*
+This function pulls a 1D linear interpolated (ie averaged) value from a 2D table
+ie: Given a value on the X axis, it returns a Y value that corresponds to the point on the curve between the nearest two defined X values
+*/
+template <typename axis_t, typename value_t>
+int table2D_getValue(table2D<axis_t, value_t> *fromTable, int X_in)
+{
+  int returnValue = 0;
+  bool valueFound = false;
+
+  int X = X_in;
+  int xMinValue, xMaxValue;
+  uint8_t xMin = 0;
+  uint8_t xMax = fromTable->xSize-1;
+  const axis_t *pAxis = fromTable->axisX;
+  const value_t *pValues = fromTable->values;
+
+  //Check whether the X input is the same as last time this ran
+  if( (X_in == fromTable->lastInput) && (fromTable->cacheGeneration == table2D_cacheGeneration) )
+  {
+    returnValue = fromTable->lastOutput;
+    valueFound = true;
+  }
+  //If the requested X value is greater/small than the maximum/minimum bin, simply return that value
+  else if(X >= pAxis[xMax])
+  {
+    returnValue = pValues[xMax];
+    valueFound = true;
+  }
+  else if(X <= pAxis[xMin])
+  {
+    returnValue = pValues[xMin];
+    valueFound = true;
+  }
+  //Finally if none of that is found
+  else
+  {
+    //1st check is whether we're still in the same X bin as last time
+    xMaxValue = pAxis[fromTable->lastXMax];
+    xMinValue = pAxis[fromTable->lastXMin];
+    if ( (X <= xMaxValue) && (X > xMinValue) )
+    {
+      xMax = fromTable->lastXMax;
+      xMin = fromTable->lastXMin;
+    }
+    else
+    {
+      //If we're not in the same bin, loop through to find where we are
+      xMaxValue = pAxis[fromTable->xSize-1]; // init xMaxValue in preparation for loop.
+      for (uint8_t x = fromTable->xSize-1; x > 0; x--)
+      {
+        xMinValue = pAxis[x-1]; // fetch next Min
+
+        //Checks the case where the X value is exactly what was requested
+        if (X == xMaxValue)
+        {
+          returnValue = pValues[x]; //Simply return the corresponding value
+          valueFound = true;
+          break;
+        }
+        else if (X > xMinValue)
+        {
+          // Value is in the current bin
+          xMax = x;
+          fromTable->lastXMax = xMax;
+          xMin = x-1;
+          fromTable->lastXMin = xMin;
+          break;
+        }
+        // Otherwise, continue to next bin
+        xMaxValue = xMinValue; // for the next bin, our Min is their Max
+      }
+    }
+  } //X_in same as last time
+
+  if (valueFound == false)
+  {
+    int16_t m = X - xMinValue;
+    int16_t n = xMaxValue - xMinValue;
+
+    int16_t yMax = pValues[xMax];
+    int16_t yMin = pValues[xMin];
+
+    /* Float version (if m, yMax, yMin and n were float's)
+       int yVal = (m * (yMax - yMin)) / n;
+    */
+
+    //Non-Float version
+    int16_t yVal = ( ((int32_t) m) * (yMax-yMin) ) / n;
+    returnValue = yMin + yVal;
+  }
+
+  fromTable->lastInput = X_in;
+  fromTable->lastOutput = returnValue;
+  fromTable->cacheGeneration = table2D_cacheGeneration;
+
+  return returnValue;
+}
 
 #endif // TABLE_H
@@ -11,6 +11,13 @@ table_value_iterator rows_begin(const void *pTable, table_type_t key)
 }
 
 
+void invalidate_table_axes(const void *pTable, table_type_t key)
+{
+  #define CTA_INVALIDATE_AXES(size, xDomain, yDomain, pTable) \
+      invalidate_axis_cache(&((TABLE3D_TYPENAME_BASE(size, xDomain, yDomain)*)pTable)->get_value_cache); break;
+  CONCRETE_TABLE_ACTION(key, CTA_INVALIDATE_AXES, pTable);
+}
+
 /**
  * Convert page iterator to table x axis iterator.
  */
@@ -74,11 +74,11 @@ enum table_type_t {
 
 // Generate the 3D table types
 #define TABLE3D_GEN_TYPE(size, xDom, yDom) \
-    /** @brief A 3D table with size x size dimensions, xDom x-axis and yDom y-axis */ \
+    /** @brief A 3D table with size dimensions, xDom x-axis and yDom y-axis */ \
     struct TABLE3D_TYPENAME_BASE(size, xDom, yDom) \
     { \
-        typedef TABLE3D_TYPENAME_AXIS(size, xDom) xaxis_t; \
-        typedef TABLE3D_TYPENAME_AXIS(size, yDom) yaxis_t; \
+        typedef TABLE3D_TYPENAME_AXIS(TABLE3D_XSIZE(size), xDom) xaxis_t; \
+        typedef TABLE3D_TYPENAME_AXIS(TABLE3D_YSIZE(size), yDom) yaxis_t; \
         typedef TABLE3D_TYPENAME_VALUE(size, xDom, yDom) value_t; \
         /* This will take up zero space unless we take the address somewhere */ \
         static constexpr table_type_t type_key = TO_TYPE_KEY(size, xDom, yDom); \
@@ -92,10 +92,11 @@ TABLE3D_GENERATOR(TABLE3D_GEN_TYPE)
 
 // Generate get3DTableValue() functions
 #define TABLE3D_GEN_GET_TABLE_VALUE(size, xDom, yDom) \
-    static inline int get3DTableValue(TABLE3D_TYPENAME_BASE(size, xDom, yDom) *pTable, table3d_axis_t y, table3d_axis_t x) \
+    static inline TABLE3D_VALUE_TYPE(size) get3DTableValue(TABLE3D_TYPENAME_BASE(size, xDom, yDom) *pTable, table3d_axis_t y, table3d_axis_t x) \
     { \
       return get3DTableValue( &pTable->get_value_cache, \
                               TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::row_size, \
+                              TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::num_rows, \
                               pTable->values.values, \
                               pTable->axisX.axis, \
                               pTable->axisY.axis, \
@@ -103,6 +104,35 @@ TABLE3D_GENERATOR(TABLE3D_GEN_TYPE)
     } 
 TABLE3D_GENERATOR(TABLE3D_GEN_GET_TABLE_VALUE)
 
+// Generate resolve3DTableLookup() functions
+#define TABLE3D_GEN_RESOLVE_LOOKUP(size, xDom, yDom) \
+    static inline void resolve3DTableLookup(table3DLookupContext *pContext, TABLE3D_TYPENAME_BASE(size, xDom, yDom) *pTable, table3d_axis_t y, table3d_axis_t x) \
+    { \
+      resolve3DTableLookup( pContext, \
+                            &pTable->get_value_cache, \
+                            TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::row_size, \
+                            TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::num_rows, \
+                            pTable->axisX.axis, \
+                            pTable->axisY.axis, \
+                            y, x); \
+    } 
+TABLE3D_GENERATOR(TABLE3D_GEN_RESOLVE_LOOKUP)
+
+// Generate get3DTableValue() functions that use a lookup context
+#define TABLE3D_GEN_GET_TABLE_VALUE_CONTEXT(size, xDom, yDom) \
+    static inline TABLE3D_VALUE_TYPE(size) get3DTableValue(TABLE3D_TYPENAME_BASE(size, xDom, yDom) *pTable, const table3DLookupContext *pContext, table3d_axis_t y, table3d_axis_t x) \
+    { \
+      return get3DTableValue( pContext, \
+                              &pTable->get_value_cache, \
+                              TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::row_size, \
+                              TABLE3D_TYPENAME_BASE(size, xDom, yDom)::value_t::num_rows, \
+                              pTable->values.values, \
+                              pTable->axisX.axis, \
+                              pTable->axisY.axis, \
+                              y, x); \
+    } 
+TABLE3D_GENERATOR(TABLE3D_GEN_GET_TABLE_VALUE_CONTEXT)
+
 // =============================== Table function calls =========================
 
 // With no templates or inheritance we need some way to call functions
@@ -119,6 +149,13 @@ TABLE3D_GENERATOR(TABLE3D_GEN_GET_TABLE_VALUE)
 
 table_value_iterator rows_begin(const void *pTable, table_type_t key);
 
+/**
+ * @brief Notify the table that one or more axis values have changed.
+ * 
+ * Must be called after writing to an axis via the iterators below.
+ */
+void invalidate_table_axes(const void *pTable, table_type_t key);
+
 table_axis_iterator x_begin(const void *pTable, table_type_t key);
 
 table_axis_iterator x_rbegin(const void *pTable, table_type_t key);
@@ -78,10 +78,12 @@ private:
     const axis_domain _domain;
 };
 
-#define TABLE3D_TYPENAME_AXIS(size, domain) table3d ## size ## domain ## _axis
+#define TABLE3D_TYPENAME_AXIS_INNER(length, domain) table3d ## length ## domain ## _axis
+// Allows length to be a macro, E.g. TABLE3D_XSIZE(size)
+#define TABLE3D_TYPENAME_AXIS(length, domain) TABLE3D_TYPENAME_AXIS_INNER(length, domain)
 
 #define TABLE3D_GEN_AXIS(size, dom) \
-    /** @brief The dxis for a 3D table with size x size dimensions and domain 'domain' */ \
+    /** @brief The axis for a 3D table with a size long axis and domain 'domain' */ \
     struct TABLE3D_TYPENAME_AXIS(size, dom) { \
         /** @brief The length of the axis in elements */ \
         static constexpr table3d_dim_t length = (size); \
@@ -114,5 +116,8 @@ TABLE3D_GEN_AXIS(8, Load)
 TABLE3D_GEN_AXIS(8, Tps)
 TABLE3D_GEN_AXIS(16, Rpm)
 TABLE3D_GEN_AXIS(16, Load)
+TABLE3D_GEN_AXIS(24, Rpm)
+TABLE3D_GEN_AXIS(32, Rpm)
+TABLE3D_GEN_AXIS(32, Load)
 
 /** @} */
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "table3d_interpolate.h"
 
 
@@ -65,19 +66,31 @@ static inline table3d_dim_t find_bin_max(
     return minElement+stride;
   }
 
-  // No hits above, so run a linear search.
-  // We start at the maximum & work down, rather than looping from [0] up to [max]
-  // This is because the important tables (fuel and injection) will have the highest
-  // RPM at the top of the X axis, so starting there will mean the best case occurs 
-  // when the RPM is highest (and hence the CPU is needed most)
-  lastBinMax = maxElement;
-  pMax = pAxis + lastBinMax;
-  while (lastBinMax!=minBinIndex && !is_in_bin(value, *(pMax - stride), *pMax))
+  // No hits above, so run a binary search. This is the path taken on large 
+  // transients (E.g. a throttle blip), which tend to hit every table in the
+  // same loop - so the worst case matters more than the average case.
+  //
+  // Elements are addressed by their distance from maxElement, so the values
+  // decrease as the distance increases. We want the largest distance whose
+  // element is >= value: the element after it is then < value.
+  //
+  // The checks above guarantee pAxis[maxElement] > value > pAxis[minElement],
+  // which are the initial invariants.
+  table3d_dim_t lower = 0; // Distance of an element >= value
+  table3d_dim_t upper = stride>0 ? maxElement-minElement : minElement-maxElement; // Distance of an element < value
+  while (upper > (table3d_dim_t)(lower + 1U))
   {
-    lastBinMax -= stride;
-    pMax -= stride;
+    table3d_dim_t middle = (lower + upper) / 2U;
+    if (pAxis[maxElement - (stride*middle)] >= value)
+    {
+      lower = middle;
+    }
+    else
+    {
+      upper = middle;
+    }
   }
-  return lastBinMax;
+  return maxElement - (stride*lower);
 }
 
 table3d_dim_t find_xbin(table3d_axis_t &value, const table3d_axis_t *pAxis, table3d_dim_t size, table3d_dim_t lastBin)
@@ -127,31 +140,140 @@ inline QU1X8_t mulQU1X8(QU1X8_t a, QU1X8_t b)
 
 // ============================= Axis value to bin % =========================
 
-static inline QU1X8_t compute_bin_position(table3d_axis_t value, const table3d_dim_t &bin, int8_t stride, const table3d_axis_t *pAxis)
+// Bins wider than this have their reciprocal scaled down by 2^8, so that 
+// it fits in a table3d_bin_recip_t
+static constexpr uint16_t WIDE_BIN_WIDTH = 256U;
+
+static inline table3d_bin_recip_t compute_bin_reciprocal(uint16_t binWidth)
+{
+  // A 1 wide bin has no values that are strictly inside it. 0 is an empty
+  // bin, which the bin search never returns.
+  if (binWidth<2U) { return 0; }
+  if (binWidth>WIDE_BIN_WIDTH) { return (uint32_t)(1UL << 24) / binWidth; }
+  return (uint32_t)(1UL << 16) / binWidth;
+}
+
+// The reciprocal of the width of the bin with max index bin
+static inline table3d_bin_recip_t compute_bin_reciprocal(const table3d_axis_t *pAxis, table3d_dim_t bin)
+{
+  return compute_bin_reciprocal(pAxis[bin]-pAxis[bin+1U]);
+}
+
+static inline QU1X8_t compute_bin_position(table3d_axis_t value, const table3d_dim_t &bin, int8_t stride, const table3d_axis_t *pAxis, table3d_bin_recip_t recip)
 {
   table3d_axis_t binMinValue = pAxis[bin-stride];
   if (value==binMinValue) { return 0; }
   table3d_axis_t binMaxValue = pAxis[bin];
   if (value==binMaxValue) { return QU1X8_ONE; }
-  table3d_axis_t binWidth = binMaxValue-binMinValue;
+  uint16_t binWidth = binMaxValue-binMinValue;
+  uint16_t offset = value-binMinValue;
+
+  // We want (offset << 8) / binWidth. Multiplying by the reciprocal gives 
+  // that, but since the reciprocal is rounded down the estimate is either 
+  // exact or 1 too small. offset < binWidth, so the result is <1 and fits 
+  // in 1.8 (uint16_t).
+  QU1X8_t p = binWidth>WIDE_BIN_WIDTH ?
+                ((uint32_t)offset * recip) >> 16U :
+                ((uint32_t)offset * recip) >> (16U-QU1X8_INTEGER_SHIFT);
+  // A single multiply & compare will correct the estimate
+  if ((uint32_t)(p+1U) * binWidth <= ((uint32_t)offset << QU1X8_INTEGER_SHIFT))
+  {
+    ++p;
+  }
+  return p;
+}
+
+
+// Finds the bins the x & y values fall in, starting from the cached bins. 
+// The reciprocal of each bin's width is cached with it, so is only 
+// recomputed when the bin (or the axis) changes.
+static inline void find_bins(struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t &Y_in, table3d_axis_t &X_in)
+{
+  table3d_dim_t xBinMax = find_xbin(X_in, pXAxis, xSize, pValueCache->lastXBinMax);
+  table3d_dim_t yBinMax = find_ybin(Y_in, pYAxis, ySize, pValueCache->lastYBinMax);
+  if (!pValueCache->binRecipsValid || xBinMax!=pValueCache->lastXBinMax)
+  {
+    pValueCache->lastXBinRecip = compute_bin_reciprocal(pXAxis, xBinMax);
+  }
+  if (!pValueCache->binRecipsValid || yBinMax!=pValueCache->lastYBinMax)
+  {
+    pValueCache->lastYBinRecip = compute_bin_reciprocal(pYAxis, yBinMax);
+  }
+  pValueCache->binRecipsValid = true;
+  pValueCache->lastXBinMax = xBinMax;
+  pValueCache->lastYBinMax = yBinMax;
+}
+
+/*
+At this point we have the 4 corners of the map where the interpolated value will fall in
+Eg: (yMax,xMin)  (yMax,xMax)
 
-  // Since we can have bins of any width, we need to use 
-  // 24.8 fixed point to avoid overflow
-  uint32_t p = (uint32_t)(value - binMinValue) << QU1X8_INTEGER_SHIFT;
-  // But since we are computing the ratio (0 to 1), p is guaranteed to be
-  // less than binWidth and thus the division below will result in a value
-  // <=1. So we can reduce the data type from 24.8 (uint32_t) to 1.8 (uint16_t)
-  return p / binWidth;  
+    (yMin,xMin)  (yMin,xMax)
+
+In the following calculation the table values are referred to by the following variables:
+          A          B
+
+          C          D
+*/
+template <typename value_t>
+struct table3d_corners {
+  value_t A, B, C, D;
+};
+
+template <typename value_t>
+static inline table3d_corners<value_t> get_corners(const value_t *pValues, table3d_dim_t xSize, table3d_dim_t xBinMax, table3d_dim_t yBinMax)
+{
+  // Tables larger than 16x16 have more than 256 values, so the row offsets need 16-bits
+  uint16_t rowMax = (uint16_t)yBinMax * xSize;
+  uint16_t rowMin = rowMax + xSize;
+  table3d_dim_t colMax = xSize - xBinMax - 1;
+  table3d_dim_t colMin = colMax - 1;
+  return { pValues[rowMax + colMin], pValues[rowMax + colMax], pValues[rowMin + colMin], pValues[rowMin + colMax] };
+}
+
+//Check that all values aren't just the same (This regularly happens with things like the fuel trim maps)
+template <typename value_t>
+static inline bool is_flat(const table3d_corners<value_t> &corners)
+{
+  return (corners.A == corners.B) && (corners.A == corners.C) && (corners.A == corners.D);
 }
 
+// Compute the corner weights from the position of the (x, y) pair within the bins. 
+// p & q are essentially percentages (between 0 and 1) of where the desired value falls 
+// between the nearest bins on each axis
+static inline void compute_corner_weights(QU1X8_t p, QU1X8_t q, QU1X8_t *pWeights)
+{
+  pWeights[0] = mulQU1X8(QU1X8_ONE-p, q);
+  pWeights[1] = mulQU1X8(p, q);
+  pWeights[2] = mulQU1X8(QU1X8_ONE-p, QU1X8_ONE-q);
+  pWeights[3] = mulQU1X8(p, QU1X8_ONE-q);
+}
+
+static inline table3d_value_t interpolate_corners(const table3d_corners<table3d_value_t> &corners, const QU1X8_t *pWeights)
+{
+  return ( (corners.A * pWeights[0]) + (corners.B * pWeights[1]) + (corners.C * pWeights[2]) + (corners.D * pWeights[3]) ) >> QU1X8_INTEGER_SHIFT;
+}
+
+static inline table3d_value16_t interpolate_corners(const table3d_corners<table3d_value16_t> &corners, const QU1X8_t *pWeights)
+{
+  // The products need 24 bits. 
+  // The rounded weights can sum to slightly more than 1, so clamp rather than overflow
+  uint32_t value = ( ((uint32_t)corners.A * pWeights[0]) + ((uint32_t)corners.B * pWeights[1]) + ((uint32_t)corners.C * pWeights[2]) + ((uint32_t)corners.D * pWeights[3]) ) >> QU1X8_INTEGER_SHIFT;
+  return value>UINT16_MAX ? (table3d_value16_t)UINT16_MAX : (table3d_value16_t)value;
+}
 
 // ============================= End internal support functions =========================
 
 //This function pulls a value from a 3D table given a target for X and Y coordinates.
 //It performs a 2D linear interpolation as described in: www.megamanual.com/v22manual/ve_tuner.pdf
-table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
-                    table3d_dim_t axisSize,
-                    const table3d_value_t *pValues,
+template <typename value_t>
+static inline value_t lookup3DTableValue(struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const value_t *pValues,
                     const table3d_axis_t *pXAxis,
                     const table3d_axis_t *pYAxis,
                     table3d_axis_t Y_in, table3d_axis_t X_in)
@@ -162,7 +284,7 @@ table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache,
     if( X_in == pValueCache->last_lookup.x && 
         Y_in == pValueCache->last_lookup.y)
     {
-      return pValueCache->lastOutput;
+      return (value_t)pValueCache->lastOutput;
     }
 
     // Assign this here, as we might modify coords below.
@@ -170,44 +292,163 @@ table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache,
     pValueCache->last_lookup.y = Y_in;
 
     // Figure out where on the axes the incoming coord are
-    pValueCache->lastXBinMax = find_xbin(X_in, pXAxis, axisSize, pValueCache->lastXBinMax);
-    pValueCache->lastYBinMax = find_ybin(Y_in, pYAxis, axisSize, pValueCache->lastYBinMax);
-
-    /*
-    At this point we have the 4 corners of the map where the interpolated value will fall in
-    Eg: (yMax,xMin)  (yMax,xMax)
-
-        (yMin,xMin)  (yMin,xMax)
-
-    In the following calculation the table values are referred to by the following variables:
-              A          B
-
-              C          D
-    */
-    table3d_dim_t rowMax = pValueCache->lastYBinMax * axisSize;
-    table3d_dim_t rowMin = rowMax + axisSize;
-    table3d_dim_t colMax = axisSize - pValueCache->lastXBinMax - 1;
-    table3d_dim_t colMin = colMax - 1;
-    table3d_value_t A = pValues[rowMax + colMin];
-    table3d_value_t B = pValues[rowMax + colMax];
-    table3d_value_t C = pValues[rowMin + colMin];
-    table3d_value_t D = pValues[rowMin + colMax];
-
-    //Check that all values aren't just the same (This regularly happens with things like the fuel trim maps)
-    if( (A == B) && (A == C) && (A == D) ) { pValueCache->lastOutput = A; }
+    find_bins(pValueCache, xSize, ySize, pXAxis, pYAxis, Y_in, X_in);
+
+    const table3d_corners<value_t> corners = get_corners(pValues, xSize, pValueCache->lastXBinMax, pValueCache->lastYBinMax);
+
+    value_t result;
+    if( is_flat(corners) ) { result = corners.A; }
     else
     {
       //Create some normalised position values
-      //These are essentially percentages (between 0 and 1) of where the desired value falls between the nearest bins on each axis
-      const QU1X8_t p = compute_bin_position(X_in, pValueCache->lastXBinMax, -1, pXAxis);
-      const QU1X8_t q = compute_bin_position(Y_in, pValueCache->lastYBinMax, -1, pYAxis);
-
-      const QU1X8_t m = mulQU1X8(QU1X8_ONE-p, q);
-      const QU1X8_t n = mulQU1X8(p, q);
-      const QU1X8_t o = mulQU1X8(QU1X8_ONE-p, QU1X8_ONE-q);
-      const QU1X8_t r = mulQU1X8(p, QU1X8_ONE-q);
-      pValueCache->lastOutput = ( (A * m) + (B * n) + (C * o) + (D * r) ) >> QU1X8_INTEGER_SHIFT;
+      const QU1X8_t p = compute_bin_position(X_in, pValueCache->lastXBinMax, -1, pXAxis, pValueCache->lastXBinRecip);
+      const QU1X8_t q = compute_bin_position(Y_in, pValueCache->lastYBinMax, -1, pYAxis, pValueCache->lastYBinRecip);
+
+      QU1X8_t weights[4];
+      compute_corner_weights(p, q, weights);
+      result = interpolate_corners(corners, weights);
     }
 
-    return pValueCache->lastOutput;
+    pValueCache->lastOutput = result;
+    return result;
+}
+
+// ============================= Shared lookups =========================
+
+void resolve3DTableLookup(struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pSourceCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+    // Nothing has changed since the last call (E.g. the context is resolved
+    // again by each user in the same loop)
+    if( X_in == pContext->last_lookup.x && 
+        Y_in == pContext->last_lookup.y &&
+        pContext->axisGeneration == pSourceCache->axisGeneration &&
+        pContext->pXAxis == pXAxis)
+    {
+      return;
+    }
+
+    pContext->pXAxis = pXAxis;
+    pContext->pYAxis = pYAxis;
+    pContext->xSize = xSize;
+    pContext->ySize = ySize;
+    pContext->axisGeneration = pSourceCache->axisGeneration;
+    pContext->last_lookup.x = X_in;
+    pContext->last_lookup.y = Y_in;
+
+    // The source table's bin cache is used to speed up the search
+    find_bins(pSourceCache, xSize, ySize, pXAxis, pYAxis, Y_in, X_in);
+    pContext->xBinMax = pSourceCache->lastXBinMax;
+    pContext->yBinMax = pSourceCache->lastYBinMax;
+    pContext->xBinRecip = pSourceCache->lastXBinRecip;
+    pContext->yBinRecip = pSourceCache->lastYBinRecip;
+
+    const QU1X8_t p = compute_bin_position(X_in, pContext->xBinMax, -1, pXAxis, pSourceCache->lastXBinRecip);
+    const QU1X8_t q = compute_bin_position(Y_in, pContext->yBinMax, -1, pYAxis, pSourceCache->lastYBinRecip);
+    compute_corner_weights(p, q, pContext->cornerWeights);
+}
+
+static inline bool has_context_axes(const struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis)
+{
+  // Only compare the axes if either set has changed since the last comparison
+  if (pValueCache->sharedAxesGeneration != pContext->axisGeneration)
+  {
+    pValueCache->sharedAxes = (xSize == pContext->xSize)
+                            && (ySize == pContext->ySize)
+                            && (pContext->axisGeneration != 0U)
+                            && (memcmp(pXAxis, pContext->pXAxis, xSize * sizeof(table3d_axis_t)) == 0)
+                            && (memcmp(pYAxis, pContext->pYAxis, ySize * sizeof(table3d_axis_t)) == 0);
+    pValueCache->sharedAxesGeneration = pContext->axisGeneration;
+  }
+  return pValueCache->sharedAxes;
+}
+
+template <typename value_t>
+static inline value_t lookup3DTableValue(const struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const value_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+    if( X_in == pValueCache->last_lookup.x && 
+        Y_in == pValueCache->last_lookup.y)
+    {
+      return (value_t)pValueCache->lastOutput;
+    }
+
+    // The context must have been resolved for the same inputs on the same axes
+    if( X_in != pContext->last_lookup.x || 
+        Y_in != pContext->last_lookup.y ||
+        !has_context_axes(pContext, pValueCache, xSize, ySize, pXAxis, pYAxis))
+    {
+      return lookup3DTableValue(pValueCache, xSize, ySize, pValues, pXAxis, pYAxis, Y_in, X_in);
+    }
+
+    pValueCache->last_lookup.x = X_in;
+    pValueCache->last_lookup.y = Y_in;
+    pValueCache->lastXBinMax = pContext->xBinMax;
+    pValueCache->lastYBinMax = pContext->yBinMax;
+    // The axes are the same, so are the bin widths
+    pValueCache->lastXBinRecip = pContext->xBinRecip;
+    pValueCache->lastYBinRecip = pContext->yBinRecip;
+    pValueCache->binRecipsValid = true;
+
+    const table3d_corners<value_t> corners = get_corners(pValues, xSize, pContext->xBinMax, pContext->yBinMax);
+    value_t result = is_flat(corners) ? corners.A : interpolate_corners(corners, pContext->cornerWeights);
+    pValueCache->lastOutput = result;
+    return result;
+}
+
+// ============================= Public lookups =========================
+
+table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+  return lookup3DTableValue(pValueCache, xSize, ySize, pValues, pXAxis, pYAxis, Y_in, X_in);
+}
+
+table3d_value16_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value16_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+  return lookup3DTableValue(pValueCache, xSize, ySize, pValues, pXAxis, pYAxis, Y_in, X_in);
+}
+
+table3d_value_t get3DTableValue(const struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+  return lookup3DTableValue(pContext, pValueCache, xSize, ySize, pValues, pXAxis, pYAxis, Y_in, X_in);
+}
+
+table3d_value16_t get3DTableValue(const struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value16_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t Y_in, table3d_axis_t X_in)
+{
+  return lookup3DTableValue(pContext, pValueCache, xSize, ySize, pValues, pXAxis, pYAxis, Y_in, X_in);
 }
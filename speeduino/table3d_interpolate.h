@@ -29,7 +29,24 @@ struct table3DGetValueCache {
 
   //Store the last input and output values, again for caching purposes
   coord2d last_lookup = { INT16_MAX, INT16_MAX };
-  table3d_value_t lastOutput;
+  // Wide enough for any table value type
+  table3d_value16_t lastOutput;
+
+  // The reciprocal of the width of the lastXBinMax & lastYBinMax bins, so that 
+  // a lookup can locate a value within a bin using multiplication instead of a
+  // (slow on AVR) division. Only recomputed when the bin changes.
+  table3d_bin_recip_t lastXBinRecip;
+  table3d_bin_recip_t lastYBinRecip;
+  // False if the axes have changed since the reciprocals were computed, so start out invalid.
+  bool binRecipsValid = false;
+
+  // Incremented on every axis change. Never 0.
+  uint8_t axisGeneration = 1;
+
+  // Whether the axes are identical to those of a table3DLookupContext, as of 
+  // that context's axisGeneration. 0 if not compared since the axes changed.
+  uint8_t sharedAxesGeneration = 0;
+  bool sharedAxes = false;
 };
 
 
@@ -38,6 +55,17 @@ static inline void invalidate_cache(table3DGetValueCache *pCache)
     pCache->last_lookup.x = INT16_MAX;
 }
 
+// Call when an axis value has changed (the bin reciprocals must be recomputed)
+static inline void invalidate_axis_cache(table3DGetValueCache *pCache)
+{
+    invalidate_cache(pCache);
+    pCache->binRecipsValid = false;
+    pCache->sharedAxesGeneration = 0;
+    pCache->sharedAxes = false;
+    ++pCache->axisGeneration;
+    if (pCache->axisGeneration==0U) { pCache->axisGeneration = 1; }
+}
+
 /*
 3D Tables have an origin (0,0) in the top left hand corner. Vertical axis is expressed first.
 Eg: 2x2 table
@@ -52,8 +80,81 @@ Eg: 2x2 table
 
 */
 table3d_value_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
-                    table3d_dim_t axisSize,
+                    table3d_dim_t xSize, table3d_dim_t ySize,
                     const table3d_value_t *pValues,
                     const table3d_axis_t *pXAxis,
                     const table3d_axis_t *pYAxis,
+                    table3d_axis_t y, table3d_axis_t x);
+
+/*
+As above, for tables of 16-bit values. The interpolation is the same fixed point
+calculation, with 32-bit intermediates.
+*/
+table3d_value16_t get3DTableValue(struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value16_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t y, table3d_axis_t x);
+
+/*
+The position of an (x, y) pair on a set of table axes. Many tables are indexed
+by the same inputs (E.g. fuel load & RPM) and are often given identical axes.
+A context lets all of those tables share a single bin search & bin position 
+calculation, leaving only the final interpolation per table.
+
+Usage:
+  1. Resolve the context once per loop, against one table (the source).
+  2. Look up any table of the same size via the context. If that table's axes 
+     differ from the source's, or the (x, y) pair differs from the one the 
+     context was resolved for, the lookup falls back to a regular lookup. 
+
+Checking the axes is only done when either set of axes changes.
+A table should only be looked up via one context.
+*/
+struct table3DLookupContext {
+  // The source table axes
+  const table3d_axis_t *pXAxis = nullptr;
+  const table3d_axis_t *pYAxis = nullptr;
+  table3d_dim_t xSize = 0;
+  table3d_dim_t ySize = 0;
+  // The source table axisGeneration when the context was resolved. 0 if never resolved
+  uint8_t axisGeneration = 0;
+
+  // The (unclamped) x & y the context was resolved for
+  coord2d last_lookup = { INT16_MAX, INT16_MAX };
+
+  // The bins the x & y values fall in (See table3DGetValueCache)
+  table3d_dim_t xBinMax = 1;
+  table3d_dim_t yBinMax = 1;
+  // The reciprocals of the bin widths (See table3DGetValueCache)
+  table3d_bin_recip_t xBinRecip;
+  table3d_bin_recip_t yBinRecip;
+
+  // The fixed point (1.8) weight of each of the 4 bin corners, in the 
+  // order A, B, C, D (See get3DTableValue())
+  uint16_t cornerWeights[4];
+};
+
+void resolve3DTableLookup(struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pSourceCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t y, table3d_axis_t x);
+
+table3d_value_t get3DTableValue(const struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
+                    table3d_axis_t y, table3d_axis_t x);
+
+table3d_value16_t get3DTableValue(const struct table3DLookupContext *pContext,
+                    struct table3DGetValueCache *pValueCache, 
+                    table3d_dim_t xSize, table3d_dim_t ySize,
+                    const table3d_value16_t *pValues,
+                    const table3d_axis_t *pXAxis,
+                    const table3d_axis_t *pYAxis,
                     table3d_axis_t y, table3d_axis_t x);
\ No newline at end of file
@@ -24,21 +24,43 @@ using table3d_dim_t = uint8_t;
 /** @brief The type of each table value */
 using table3d_value_t = uint8_t;
 
+/** @brief The type of each value in a 16-bit value table
+ * 
+ * For tables that need more resolution than table3d_value_t offers. E.g. 0.1% VE
+ */
+using table3d_value16_t = uint16_t;
+
 /** @brief The type of each axis value */
 using table3d_axis_t = int16_t;
 
+/** @brief The type of the cached reciprocal of an axis bin width
+ * 
+ * See table3DGetValueCache::lastXBinRecip
+ */
+using table3d_bin_recip_t = uint16_t;
+
 /** @brief Core 3d table generation macro
  * 
  * We have a fixed number of table types: they are defined by this macro.
  * GENERATOR is expected to be another macros that takes at least 3 arguments:
- *    axis length, x-axis domain, y-axis domain
+ *    size, x-axis domain, y-axis domain
+ * 
+ * The size is either the axis length of a square table (E.g. 16) or 
+ * <x-axis length>x<y-axis length> for a rectangular table (E.g. 24x16).
+ * A _u16 suffix gives a table of 16-bit values (E.g. 16_u16), otherwise 
+ * values are 8-bit.
+ * Use TABLE3D_XSIZE(), TABLE3D_YSIZE() & TABLE3D_VALUE_TYPE() to obtain the 
+ * axis lengths and value type.
  */
 #define TABLE3D_GENERATOR(GENERATOR, ...) \
     GENERATOR(6, Rpm, Load, ##__VA_ARGS__) \
     GENERATOR(4, Rpm, Load, ##__VA_ARGS__) \
     GENERATOR(8, Rpm, Load, ##__VA_ARGS__) \
     GENERATOR(8, Rpm, Tps, ##__VA_ARGS__) \
-    GENERATOR(16, Rpm, Load, ##__VA_ARGS__)
+    GENERATOR(16, Rpm, Load, ##__VA_ARGS__) \
+    GENERATOR(24x16, Rpm, Load, ##__VA_ARGS__) \
+    GENERATOR(32, Rpm, Load, ##__VA_ARGS__) \
+    GENERATOR(16_u16, Rpm, Load, ##__VA_ARGS__)
 
 // Each 3d table is given a distinct type based on size & axis domains
 // This encapsulates the generation of the type name
@@ -47,4 +69,34 @@ using table3d_axis_t = int16_t;
 #define CAT_HELPER(a, b) a ## b
 #define CONCAT(A, B) CAT_HELPER(A, B)
 
+/** @brief The x-axis length (I.e. the row length) of a table size */
+#define TABLE3D_XSIZE(size) CONCAT(TABLE3D_XSIZE_, size)
+/** @brief The y-axis length (I.e. the number of rows) of a table size */
+#define TABLE3D_YSIZE(size) CONCAT(TABLE3D_YSIZE_, size)
+/** @brief The value type of a table size */
+#define TABLE3D_VALUE_TYPE(size) CONCAT(TABLE3D_VALUE_TYPE_, size)
+
+// The axis lengths & value type of every size used in TABLE3D_GENERATOR
+#define TABLE3D_XSIZE_4 4
+#define TABLE3D_YSIZE_4 4
+#define TABLE3D_VALUE_TYPE_4 table3d_value_t
+#define TABLE3D_XSIZE_6 6
+#define TABLE3D_YSIZE_6 6
+#define TABLE3D_VALUE_TYPE_6 table3d_value_t
+#define TABLE3D_XSIZE_8 8
+#define TABLE3D_YSIZE_8 8
+#define TABLE3D_VALUE_TYPE_8 table3d_value_t
+#define TABLE3D_XSIZE_16 16
+#define TABLE3D_YSIZE_16 16
+#define TABLE3D_VALUE_TYPE_16 table3d_value_t
+#define TABLE3D_XSIZE_24x16 24
+#define TABLE3D_YSIZE_24x16 16
+#define TABLE3D_VALUE_TYPE_24x16 table3d_value_t
+#define TABLE3D_XSIZE_32 32
+#define TABLE3D_YSIZE_32 32
+#define TABLE3D_VALUE_TYPE_32 table3d_value_t
+#define TABLE3D_XSIZE_16_u16 16
+#define TABLE3D_YSIZE_16_u16 16
+#define TABLE3D_VALUE_TYPE_16_u16 table3d_value16_t
+
 /** @} */
\ No newline at end of file
@@ -16,6 +16,9 @@
 /**  @brief Iterate through a table row. I.e. constant Y, changing X 
  * 
  * Instances of this class are normally created via a table_value_iterator instance.
+ * 
+ * @attention The iteration is over the row \b bytes. For tables of 16-bit values,
+ * each value is 2 elements (in native, little endian, order).
 */
 class table_row_iterator {
 public:
@@ -77,7 +80,10 @@ private:
 
 // ========================= INTER-ROW ITERATION ========================= 
 
-/**  @brief Iterate through a tables values, row by row. */
+/**  @brief Iterate through a tables values, row by row. 
+ * 
+ * See table_row_iterator for how 16-bit values are iterated.
+*/
 class table_value_iterator
 {
 public:
@@ -85,12 +91,13 @@ public:
     /** 
      * @brief Construct
      * @param pValues Pointer to the 1st value in a 1-d array
-     * @param axisSize The number of columns & elements per row (square tables only)
+     * @param rowSize The number of elements (bytes) per row
+     * @param numRows The number of rows
     */
-    table_value_iterator(const table3d_value_t *pValues, table3d_dim_t axisSize)
-        : pRowsStart(pValues + (axisSize*(axisSize-1U))),  //cppcheck-suppress misra-c2012-10.4
-        pRowsEnd(pValues - axisSize),
-        rowWidth(axisSize)
+    table_value_iterator(const table3d_value_t *pValues, table3d_dim_t rowSize, table3d_dim_t numRows)
+        : pRowsStart(pValues + ((uint16_t)rowSize*(numRows-1U))),  //cppcheck-suppress misra-c2012-10.4
+        pRowsEnd(pValues - rowSize),
+        rowWidth(rowSize)
     {
         // Table values are not linear in memory - rows are in reverse order
         // E.g. a 4x4 table with logical element [0][0] at the bottom left
@@ -110,7 +117,7 @@ public:
     */
     table_value_iterator& advance(table3d_dim_t rows)
     {
-        pRowsStart = pRowsStart - (rowWidth * rows);
+        pRowsStart = pRowsStart - ((uint16_t)rowWidth * rows);
         return *this;
     }
 
@@ -146,25 +153,28 @@ private:
 #define TABLE3D_TYPENAME_VALUE(size, xDom, yDom) CONCAT(TABLE3D_TYPENAME_BASE(size, xDom, yDom), _values)
 
 #define TABLE3D_GEN_VALUES(size, xDom, yDom) \
-    /** @brief The values for a 3D table with size x size dimensions, xDom x-axis and yDom y-axis */ \
+    /** @brief The values for a 3D table with size dimensions, xDom x-axis and yDom y-axis */ \
     struct TABLE3D_TYPENAME_VALUE(size, xDom, yDom) { \
         /** @brief The number of items in a row. I.e. it's length  */ \
-        static constexpr table3d_dim_t row_size = (size); \
+        static constexpr table3d_dim_t row_size = TABLE3D_XSIZE(size); \
         /** @brief The number of rows */ \
-        static constexpr table3d_dim_t num_rows = (size); \
+        static constexpr table3d_dim_t num_rows = TABLE3D_YSIZE(size); \
+        /** @brief The type of each value */ \
+        typedef TABLE3D_VALUE_TYPE(size) value_type; \
         /** \
          @brief The row values \
          @details Table values are not linear in memory - rows are in reverse order<br> \
          E.g. a 3x3 table with logical element [0][0] at the bottom left \
          (normal cartesian coordinates) has this layout:<br> \
-         6, 7, 8, 3, 4, 5, 0, 1, 2 \
+         6, 7, 8, 3, 4, 5, 0, 1, 2 <br> \
+         The values are packed: there is no padding, regardless of the row length. \
         */ \
-        table3d_value_t values[(uint16_t)row_size*num_rows]; \
+        value_type values[(uint16_t)row_size*num_rows]; \
         \
-        /** @brief Iterate over the values */ \
+        /** @brief Iterate over the value bytes */ \
         table_value_iterator begin(void) \
         {  \
-            return table_value_iterator(values, row_size); \
+            return table_value_iterator((table3d_value_t*)values, row_size*sizeof(value_type), num_rows); \
         } \
         \
         /** \
@@ -182,19 +192,34 @@ private:
          <br> \
          THIS IS WORTH 20% to 30% speed up<br> \
          <br> \
-         This limits us to 16x16 tables. If we need bigger and move to 16-bit \
-         operations, consider using libdivide. <br> \
+         Tables with more than 256 values must use 16-bit calculations. \
          */ \
-        table3d_value_t& value_at(table3d_dim_t linear_index) \
+        value_type& value_at(uint16_t linear_index) \
         { \
-            static_assert(row_size<17U, "Table is too big"); \
-            static_assert(num_rows<17U, "Table is too big"); \
+            static_assert(row_size<33U, "Table is too big"); \
+            static_assert(num_rows<33U, "Table is too big"); \
+            static_assert(row_size*sizeof(value_type)<256U, "Row is too big to iterate"); \
             /* Zero length will mess up unsigned calcs */ \
             static_assert(row_size>0U, "No zero length rows"); \
             static_assert(num_rows>0U, "No empty tables"); \
-            constexpr table3d_dim_t first_index = row_size*(table3d_dim_t)(num_rows-1U); \
-            const table3d_dim_t index = (table3d_dim_t)(first_index + (table3d_dim_t)(2U*(linear_index % row_size)) - linear_index); \
-            return values[index]; \
+            if ((uint16_t)row_size*num_rows<=256U) \
+            { \
+                constexpr table3d_dim_t first_index = (table3d_dim_t)(row_size*(num_rows-1U)); \
+                const table3d_dim_t index8 = (table3d_dim_t)linear_index; \
+                return values[(table3d_dim_t)(first_index + (table3d_dim_t)(2U*(index8 % row_size)) - index8)]; \
+            } \
+            constexpr uint16_t first_index = (uint16_t)row_size*(num_rows-1U); \
+            return values[(uint16_t)(first_index + (2U*(linear_index % row_size)) - linear_index)]; \
+        } \
+        \
+        /** \
+         @brief Direct access to a table value byte from a linear byte offset \
+         @details As value_at(), but addresses the bytes of each value in native \
+         (little endian) order. The same as value_at() for 8-bit values. \
+         */ \
+        uint8_t& value_byte_at(uint16_t linear_offset) \
+        { \
+            return ((uint8_t*)&value_at(linear_offset/sizeof(value_type)))[linear_offset%sizeof(value_type)]; \
         } \
     };
 TABLE3D_GENERATOR(TABLE3D_GEN_VALUES)
@@ -48,7 +48,7 @@ volatile uint16_t last250msLoopCount = 1000; //Set to effectively random number
 #if defined (CORE_TEENSY)
   IntervalTimer lowResTimer;
   void oneMSInterval(void);
-#elif defined (ARDUINO_ARCH_STM32)
+#elif defined (ARDUINO_ARCH_STM32) || defined(CORE_NATIVE)
   void oneMSInterval(void);
 #endif
 void initialiseTimers(void);
@@ -0,0 +1,239 @@
+/*
+The buffering of the tooth and composite loggers (See addToothLogEntry() in decoders.ino).
+
+The entries are stored in toothHistory and compositeLogHistory, which hold TOOTH_LOG_BUFFERS buffers of
+TOOTH_LOG_SIZE entries each. The trigger interrupt fills one buffer while the main loop sends the other, so
+nothing is lost between sends as long as each buffer is sent before the next one fills.
+The Mega doesn't have the RAM for a 2nd buffer (635 bytes), so only has the one. Logging stops while that is
+waiting to be sent, as it always has, and the entries in between are counted as dropped.
+
+This is a single producer/single consumer handoff with no locking:
+- The producer (The trigger interrupt) owns the write buffer and index. When the write buffer is full and the
+  other one is free, it publishes the full buffer as readyBuffer and sets ready
+- The consumer (The main loop) only reads readyBuffer while ready is set, then clears ready once it has been sent
+If both buffers are full, new entries are dropped (And counted) until the consumer releases its buffer.
+*/
+#ifndef TOOTH_LOG_H
+#define TOOTH_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef TOOTH_LOG_SIZE
+  #ifndef UNIT_TEST
+    #define TOOTH_LOG_SIZE      127 ///< The number of entries in each buffer. This MUST match dataLength of the loggers in the ini file
+  #else
+    #define TOOTH_LOG_SIZE      1
+  #endif
+#endif
+#ifndef TOOTH_LOG_BUFFERS
+  #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__)
+    #define TOOTH_LOG_BUFFERS   1
+  #else
+    #define TOOTH_LOG_BUFFERS   2
+  #endif
+#endif
+#define TOOTH_LOG_NO_SLOT       0xFFFFU ///< Returned by toothLog_reserve() when the entry must be dropped
+
+static_assert(TOOTH_LOG_SIZE <= 255, "TOOTH_LOG_SIZE must fit in the 8-bit write index");
+static_assert((TOOTH_LOG_BUFFERS == 1) || (TOOTH_LOG_BUFFERS == 2), "The tooth log is either single or double buffered");
+
+struct toothLogRing {
+  volatile uint8_t index;       ///< The next entry of the write buffer. Only written by the producer
+  volatile uint8_t writeBuffer; ///< The buffer being filled. Only written by the producer
+  volatile uint8_t readyBuffer; ///< The buffer waiting to be sent. Only valid while ready is set
+  volatile bool ready;          ///< Set by the producer when a buffer is published, cleared by the consumer once it has been sent
+  volatile uint16_t sequence;   ///< The number of buffers published since the logger was started. While ready is set, this is the number of readyBuffer
+  volatile uint16_t dropped;    ///< The number of entries dropped since the logger was started, because there was no free buffer
+};
+
+/** Empties both buffers. Only call this while the logger interrupts are not running (Eg. When starting a logger) */
+static inline void toothLog_reset(toothLogRing &ring)
+{
+  ring.ready = false;
+  ring.index = 0;
+  ring.writeBuffer = 0;
+  ring.readyBuffer = 0;
+  ring.sequence = 0;
+  ring.dropped = 0;
+}
+
+/* Hands the (full) write buffer to the consumer and starts filling the other one (If there is one). The consumer must not have a buffer */
+static inline void toothLog_publish(toothLogRing &ring)
+{
+  ring.readyBuffer = ring.writeBuffer;
+  ring.writeBuffer = (ring.writeBuffer + 1U) % TOOTH_LOG_BUFFERS;
+  ring.index = 0;
+  ring.sequence = ring.sequence + 1U;
+  //Everything above must be written before the buffer is handed over
+  ring.ready = true;
+}
+
+/**
+ * @brief Producer: The slot (Index into toothHistory and compositeLogHistory) to write the next entry to.
+ * toothLog_commit() must be called once the entry has been written
+ *
+ * @return TOOTH_LOG_NO_SLOT if both buffers are full (Or the only one is waiting to be sent). The entry is counted as dropped
+ */
+static inline uint16_t toothLog_reserve(toothLogRing &ring)
+{
+  if(ring.index >= TOOTH_LOG_SIZE)
+  {
+    //The write buffer filled while the consumer still had the other one. Publish it now if that has since been sent
+    if(ring.ready == true) { ring.dropped = ring.dropped + 1U; return TOOTH_LOG_NO_SLOT; }
+    toothLog_publish(ring);
+  }
+  //With a single buffer, the write buffer is the one being sent
+  if( (TOOTH_LOG_BUFFERS == 1) && (ring.ready == true) ) { ring.dropped = ring.dropped + 1U; return TOOTH_LOG_NO_SLOT; }
+  return ((uint16_t)ring.writeBuffer * TOOTH_LOG_SIZE) + ring.index;
+}
+
+/**
+ * @brief Producer: Adds the entry written to the slot from toothLog_reserve()
+ *
+ * @return true if this filled the write buffer and it has been published
+ */
+static inline bool toothLog_commit(toothLogRing &ring)
+{
+  ring.index = ring.index + 1U;
+  if( (ring.index >= TOOTH_LOG_SIZE) && (ring.ready == false) )
+  {
+    toothLog_publish(ring);
+    return true;
+  }
+  return false;
+}
+
+/** Consumer: Whether there is a full buffer waiting to be sent */
+static inline bool toothLog_isReady(const toothLogRing &ring)
+{
+  return ring.ready;
+}
+
+/** Consumer: The index in toothHistory and compositeLogHistory of the first entry of the buffer to send. Only valid when toothLog_isReady() */
+static inline uint16_t toothLog_readStart(const toothLogRing &ring)
+{
+  return (uint16_t)ring.readyBuffer * TOOTH_LOG_SIZE;
+}
+
+/** Consumer: Hands the sent buffer back to the producer */
+static inline void toothLog_release(toothLogRing &ring)
+{
+  ring.ready = false;
+}
+
+/*
+The compact log format (The 'l' command with format 1), which sends each tooth as a variable length integer of its
+change from an earlier tooth, rather than as a full 32-bit value. Tooth gaps are usually close to the ones before,
+so most entries are 1 or 2 bytes rather than 4 or 5.
+
+The header of each response (TOOTH_LOG_COMPACT_HEADER_SIZE bytes, all big endian) makes it independent of the others:
+- The index of the first entry in the buffer (1 byte) and the number of entries (1 byte). A buffer that doesn't fit
+  in one response is sent over several
+- The reference time (4 bytes). For the composite log, the time of the entry before the first. 0 for the tooth log
+- The reference gaps (4 bytes each). The gaps of the 2 entries before the first, the earlier one first
+Each entry is then the difference between its gap and the predicted gap, zigzag encoded (0, -1, 1, -2... become
+0, 1, 2, 3...) and written 7 bits per byte, least significant first, with bit 7 set if another byte follows.
+The predicted gap is the previous gap for the tooth log. The composite log logs both edges, so alternates between
+the high and low times of the teeth, and the prediction is the gap 2 entries back. For the composite log, the low 4
+bits of the first byte are the COMPOSITE_LOG_ flags of the entry, which leaves 3 bits of the value in that byte.
+*/
+#define TOOTH_LOG_COMPACT_HEADER_SIZE   14
+#define TOOTH_LOG_COMPACT_MAX_ENTRY     6 ///< The most bytes a single entry can take (A 32-bit value after the composite flags)
+#define TOOTH_LOG_COMPACT_FLAG_BITS     4 ///< The number of composite flag bits packed into the first byte of each entry
+
+/** Zigzag encodes a signed value, so that small negative values are also small */
+static inline uint32_t toothLog_zigzag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Writes a value as a variable length integer (See the compact log format above)
+ *
+ * @param flags Packed into the low flagBits bits of the first byte
+ * @return The number of bytes written. At most TOOTH_LOG_COMPACT_MAX_ENTRY
+ */
+static inline uint8_t toothLog_writeVarint(uint8_t *pDest, uint32_t value, uint8_t flags, uint8_t flagBits)
+{
+  uint8_t valueBits = 7U - flagBits;
+  uint8_t nextByte = flags | (uint8_t)((value & ((1UL << valueBits) - 1U)) << flagBits);
+  value = value >> valueBits;
+  uint8_t length = 0;
+  while(value != 0U)
+  {
+    pDest[length++] = nextByte | 0x80U;
+    nextByte = (uint8_t)(value & 0x7FU);
+    value = value >> 7;
+  }
+  pDest[length++] = nextByte;
+  return length;
+}
+
+static inline void toothLog_writeUint32(uint8_t *pDest, uint32_t value)
+{
+  pDest[0] = (uint8_t)(value >> 24);
+  pDest[1] = (uint8_t)(value >> 16);
+  pDest[2] = (uint8_t)(value >> 8);
+  pDest[3] = (uint8_t)value;
+}
+
+/* The gap of an entry of the buffer (0 for those before the buffer) */
+static inline uint32_t toothLog_entryGap(const volatile uint32_t *pEntries, bool composite, int16_t entry)
+{
+  if(entry < 0) { return 0; }
+  if(composite == false) { return pEntries[entry]; }
+  if(entry == 0) { return 0; }
+  return pEntries[entry] - pEntries[entry - 1];
+}
+
+/**
+ * @brief Encodes entries of a buffer in the compact log format, starting from firstEntry, until either the buffer or
+ * the space in pDest runs out
+ *
+ * @param pEntries The first entry of the buffer in toothHistory. Gaps for the tooth log, times for the composite log
+ * @param pFlags The first entry of the buffer in compositeLogHistory, or NULL for the tooth log
+ * @param length Set to the number of bytes written to pDest, including the header
+ * @return The number of entries encoded
+ */
+static inline uint8_t toothLog_encodeCompact(const volatile uint32_t *pEntries, const volatile uint8_t *pFlags, uint8_t firstEntry, uint8_t *pDest, uint16_t maxLength, uint16_t &length)
+{
+  const bool composite = (pFlags != NULL);
+
+  //The state before firstEntry
+  uint32_t lastTime = 0;
+  if(composite == true) { lastTime = pEntries[(firstEntry > 0U) ? (firstEntry - 1U) : 0U]; }
+  uint32_t gaps[2] = { toothLog_entryGap(pEntries, composite, (int16_t)firstEntry - 2), toothLog_entryGap(pEntries, composite, (int16_t)firstEntry - 1) };
+
+  pDest[0] = firstEntry;
+  toothLog_writeUint32(&pDest[2], lastTime);
+  toothLog_writeUint32(&pDest[6], gaps[0]);
+  toothLog_writeUint32(&pDest[10], gaps[1]);
+  length = TOOTH_LOG_COMPACT_HEADER_SIZE;
+
+  uint8_t entry = firstEntry;
+  while( (entry < TOOTH_LOG_SIZE) && ((length + TOOTH_LOG_COMPACT_MAX_ENTRY) <= maxLength) )
+  {
+    if(composite == true)
+    {
+      uint32_t time = pEntries[entry];
+      uint32_t gap = time - lastTime;
+      lastTime = time;
+      length += toothLog_writeVarint(&pDest[length], toothLog_zigzag((int32_t)(gap - gaps[0])), pFlags[entry] & 0x0FU, TOOTH_LOG_COMPACT_FLAG_BITS);
+      gaps[0] = gaps[1];
+      gaps[1] = gap;
+    }
+    else
+    {
+      uint32_t gap = pEntries[entry];
+      length += toothLog_writeVarint(&pDest[length], toothLog_zigzag((int32_t)(gap - gaps[1])), 0, 0);
+      gaps[0] = gaps[1];
+      gaps[1] = gap;
+    }
+    entry++;
+  }
+  pDest[1] = entry - firstEntry;
+  return entry - firstEntry;
+}
+
+#endif // TOOTH_LOG_H
@@ -0,0 +1,225 @@
+/*
+Speeduino - Simple engine management for the Arduino Mega 2560 platform
+Copyright (C) Josh Stewart
+A full copy of the license may be found in the projects root directory
+*/
+/** @file
+ * The table driven trigger pattern matcher and the built in patterns. See trigger_pattern.h
+ */
+#include "trigger_pattern.h"
+
+#define TRIGGER_PATTERN_GAP_COUNT (TRIGGER_PATTERN_MAX_SIGNATURE + 1)
+#define TRIGGER_PATTERN_MAX_GAP   0x7FFFFUL //Longer gaps are clamped to this (~0.5 seconds) so the ratio calculations can't overflow
+
+/*
+The built in patterns. Tooth #1 is the first tooth after the largest gap (Or on 36-2-2-2, after the single tooth)
+*/
+static const uint16_t pattern36_1[] PROGMEM = { //36-1
+  0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110,
+  120, 130, 140, 150, 160, 170, 180, 190, 200, 210, 220, 230,
+  240, 250, 260, 270, 280, 290, 300, 310, 320, 330, 340
+};
+static const uint16_t pattern60_2[] PROGMEM = { //60-2
+  0, 6, 12, 18, 24, 30, 36, 42, 48, 54, 60, 66,
+  72, 78, 84, 90, 96, 102, 108, 114, 120, 126, 132, 138,
+  144, 150, 156, 162, 168, 174, 180, 186, 192, 198, 204, 210,
+  216, 222, 228, 234, 240, 246, 252, 258, 264, 270, 276, 282,
+  288, 294, 300, 306, 312, 318, 324, 330, 336, 342
+};
+static const uint16_t pattern36_2_2_2[] PROGMEM = { //36-2-2-2 (H4). 13 teeth, 2 missing, 16 teeth, 2 missing, 1 tooth, 2 missing
+  0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110,
+  120, 150, 160, 170, 180, 190, 200, 210, 220, 230, 240, 250,
+  260, 270, 280, 290, 300, 330
+};
+static const uint16_t pattern36_2_1[] PROGMEM = { //36-2-1. 17 teeth, 1 missing, 16 teeth, 2 missing
+  0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110,
+  120, 130, 140, 150, 160, 180, 190, 200, 210, 220, 230, 240,
+  250, 260, 270, 280, 290, 300, 310, 320, 330
+};
+
+static const triggerPattern triggerPatterns[TRIGGER_PATTERN_COUNT] = {
+  { pattern36_1,     (uint8_t)(sizeof(pattern36_1) / sizeof(uint16_t)),     360 },
+  { pattern60_2,     (uint8_t)(sizeof(pattern60_2) / sizeof(uint16_t)),     360 },
+  { pattern36_2_2_2, (uint8_t)(sizeof(pattern36_2_2_2) / sizeof(uint16_t)), 360 },
+  { pattern36_2_1,   (uint8_t)(sizeof(pattern36_2_1) / sizeof(uint16_t)),   360 },
+};
+
+/** Returns one of the built in patterns (configPage10.genericTrigPattern). Out of range values return the first (36-1) */
+const triggerPattern *getTriggerPattern(uint8_t index)
+{
+  if(index >= TRIGGER_PATTERN_COUNT) { index = 0; }
+  return &triggerPatterns[index];
+}
+
+//The tooth the given number of teeth before a tooth, wrapping around the pattern
+static uint8_t toothBefore(const triggerPattern *pattern, uint8_t tooth, uint8_t count)
+{
+  count = count % pattern->teeth;
+  return (tooth >= count) ? (tooth - count) : (tooth + pattern->teeth - count);
+}
+
+/*
+Whether the ratio of 2 measured gaps (gap / previousGap) is within a factor of num/den (Either way) of the ratio of the gap angles.
+The gaps are at most TRIGGER_PATTERN_MAX_GAP and the angles at most 720, so with num and den up to 6 nothing here can overflow
+*/
+static inline bool gapRatioMatches(uint32_t gap, uint32_t previousGap, uint16_t gapAngle, uint16_t previousGapAngle, uint8_t num, uint8_t den)
+{
+  uint32_t measured = gap * previousGapAngle;
+  uint32_t expected = previousGap * gapAngle;
+  return ( (measured * num) >= (expected * den) ) && ( (measured * den) <= (expected * num) );
+}
+
+//Whether the gap ratios in front of 2 teeth are different enough that a measured ratio can't match both of them within a tolerance of num/den
+static bool gapRatiosDiffer(const triggerPattern *pattern, uint8_t tooth1, uint8_t tooth2, uint8_t num, uint8_t den)
+{
+  uint32_t ratio1 = (uint32_t)triggerPattern_gapAngle(pattern, tooth1) * triggerPattern_gapAngle(pattern, toothBefore(pattern, tooth2, 1));
+  uint32_t ratio2 = (uint32_t)triggerPattern_gapAngle(pattern, tooth2) * triggerPattern_gapAngle(pattern, toothBefore(pattern, tooth1, 1));
+  return ( (ratio1 * den * den) >= (ratio2 * num * num) ) || ( (ratio2 * den * den) >= (ratio1 * num * num) );
+}
+
+//The measured gap the given number of teeth before the latest one (0 is the latest)
+static inline uint32_t gapBefore(const triggerPatternState &state, uint8_t count)
+{
+  uint8_t index = (state.gapHead >= count) ? (state.gapHead - count) : (state.gapHead + TRIGGER_PATTERN_GAP_COUNT - count);
+  return state.gaps[index];
+}
+
+/*
+Finds the tooth that can be recognised from the fewest gap ratios, with the measured ratios allowed to be out by up to num/den.
+Sets syncTooth and signatureLength (0 if there is no such tooth)
+*/
+static void findSyncTooth(triggerPatternState &state, uint8_t num, uint8_t den)
+{
+  const triggerPattern *pattern = state.pattern;
+  state.signatureLength = 0;
+  state.syncTooth = 0;
+  for(uint8_t candidate = 0; candidate < pattern->teeth; candidate++)
+  {
+    //The number of ratios needed to tell this tooth apart from every other one
+    uint8_t length = 1;
+    for(uint8_t other = 0; (other < pattern->teeth) && (length <= TRIGGER_PATTERN_MAX_SIGNATURE); other++)
+    {
+      if(other == candidate) { continue; }
+      uint8_t ratio = 0;
+      while( (ratio < TRIGGER_PATTERN_MAX_SIGNATURE) && !gapRatiosDiffer(pattern, toothBefore(pattern, candidate, ratio), toothBefore(pattern, other, ratio), num, den) ) { ratio++; }
+      if( (ratio + 1U) > length) { length = ratio + 1U; }
+    }
+
+    if( (length <= TRIGGER_PATTERN_MAX_SIGNATURE) && ( (state.signatureLength == 0U) || (length < state.signatureLength) ) )
+    {
+      state.signatureLength = length;
+      state.syncTooth = candidate;
+    }
+  }
+}
+
+/** Prepares the matching of a pattern.
+ * This works out which tooth can be recognised from the fewest gap ratios, which is where sync will be gained, and how closely the ratios must match.
+ * The widest tolerance that still identifies a tooth is used, as the crank speed can change a lot from tooth to tooth when cranking.
+ * It is called from the decoder setup (Not an interrupt), so isn't time critical.
+ * The ratio of each gap to the one before it is also worked out here, so the trigger interrupt doesn't have to divide.
+ * @return false if no tooth of the pattern can be identified from TRIGGER_PATTERN_MAX_SIGNATURE gap ratios (Eg. Evenly spaced teeth),
+ * or it has more than TRIGGER_PATTERN_MAX_TEETH teeth
+ */
+bool triggerPattern_begin(triggerPatternState &state, const triggerPattern *pattern)
+{
+  state.pattern = pattern;
+  state.signatureLength = 0;
+  if(pattern->teeth > TRIGGER_PATTERN_MAX_TEETH)
+  {
+    triggerPattern_reset(state);
+    return false;
+  }
+
+  state.minGapAngle = 0xFFFF;
+  state.maxGapAngle = 0;
+  for(uint8_t tooth = 0; tooth < pattern->teeth; tooth++)
+  {
+    uint16_t gapAngle = triggerPattern_gapAngle(pattern, tooth);
+    if(gapAngle < state.minGapAngle) { state.minGapAngle = gapAngle; }
+    if(gapAngle > state.maxGapAngle) { state.maxGapAngle = gapAngle; }
+
+    //Rounded to the nearest step. Larger ratios than fit are capped, which only makes the trigger filter shorter (ie safer)
+    uint16_t nextGapAngle = triggerPattern_gapAngle(pattern, triggerPattern_nextTooth(pattern, tooth));
+    uint32_t ratio = (((uint32_t)nextGapAngle << TRIGGER_PATTERN_RATIO_SHIFT) + (gapAngle / 2U)) / gapAngle;
+    state.nextGapRatios[tooth] = (ratio > UINT8_MAX) ? UINT8_MAX : (uint8_t)ratio;
+  }
+
+  //Tolerances of 4/3, 5/4 and 6/5. Once synced, each tooth is checked with the next tolerance up (3/2, 4/3 or 5/4), to allow for the crank speed changing within a cycle
+  state.toleranceNum = 4;
+  findSyncTooth(state, 4, 3);
+  while( (state.signatureLength == 0U) && (state.toleranceNum < 6U) )
+  {
+    state.toleranceNum++;
+    findSyncTooth(state, state.toleranceNum, state.toleranceNum - 1U);
+  }
+
+  triggerPattern_reset(state);
+  return (state.signatureLength > 0U);
+}
+
+/** Clears the gap history and sync (Eg. When the engine has stalled) */
+void triggerPattern_reset(triggerPatternState &state)
+{
+  state.gapHead = 0;
+  state.gapCount = 0;
+  state.tooth = 0;
+  state.synced = false;
+}
+
+/** Processes the gap (uS) between the latest primary tooth and the one before it. Called from the trigger interrupt.
+ * @return One of the TRIGGER_PATTERN_* results. When it is TRIGGER_PATTERN_SYNCED or TRIGGER_PATTERN_TOOTH, state.tooth is the index of the latest tooth
+ */
+uint8_t triggerPattern_tooth(triggerPatternState &state, uint32_t gap)
+{
+  const triggerPattern *pattern = state.pattern;
+  if(gap > TRIGGER_PATTERN_MAX_GAP) { gap = TRIGGER_PATTERN_MAX_GAP; }
+  state.gapHead++;
+  if(state.gapHead >= TRIGGER_PATTERN_GAP_COUNT) { state.gapHead = 0; }
+  state.gaps[state.gapHead] = gap;
+  if(state.gapCount < TRIGGER_PATTERN_GAP_COUNT) { state.gapCount++; }
+
+  if(state.synced == true)
+  {
+    //Only the next tooth needs checking
+    uint8_t nextTooth = triggerPattern_nextTooth(pattern, state.tooth);
+    if( gapRatioMatches(gap, gapBefore(state, 1), triggerPattern_gapAngle(pattern, nextTooth), triggerPattern_gapAngle(pattern, state.tooth), state.toleranceNum - 1U, state.toleranceNum - 2U) )
+    {
+      state.tooth = nextTooth;
+      return TRIGGER_PATTERN_TOOTH;
+    }
+    state.synced = false;
+    return TRIGGER_PATTERN_SYNC_LOST;
+  }
+
+  if( (state.signatureLength > 0U) && (state.gapCount > state.signatureLength) )
+  {
+    bool matches = true;
+    for(uint8_t ratio = 0; (ratio < state.signatureLength) && (matches == true); ratio++)
+    {
+      uint8_t tooth = toothBefore(pattern, state.syncTooth, ratio);
+      matches = gapRatioMatches(gapBefore(state, ratio), gapBefore(state, ratio + 1U), triggerPattern_gapAngle(pattern, tooth), triggerPattern_gapAngle(pattern, toothBefore(pattern, tooth, 1)), state.toleranceNum, state.toleranceNum - 1U);
+    }
+    if(matches == true)
+    {
+      state.synced = true;
+      state.tooth = state.syncTooth;
+      return TRIGGER_PATTERN_SYNCED;
+    }
+  }
+  return TRIGGER_PATTERN_NO_SYNC;
+}
+
+/** The index of the last tooth at or before an angle (0 to cycleAngle-1) */
+uint8_t triggerPattern_toothAtAngle(const triggerPattern *pattern, uint16_t angle)
+{
+  uint8_t low = 0;
+  uint8_t high = pattern->teeth - 1U;
+  while(low < high)
+  {
+    uint8_t mid = (uint8_t)((low + high + 1U) >> 1);
+    if(triggerPattern_toothAngle(pattern, mid) <= angle) { low = mid; }
+    else { high = mid - 1U; }
+  }
+  return low;
+}
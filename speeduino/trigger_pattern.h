@@ -0,0 +1,88 @@
+/*
+A table driven trigger pattern matcher, used by the generic decoder (DECODER_GENERIC in decoders.ino).
+
+A pattern is described by the angle of each of its teeth, rather than by code. The matcher
+works on the ratio between each tooth gap and the one before it, which (Unlike the gap itself)
+doesn't depend on the engine speed:
+- Until it has sync, it compares the ratios of the last few gaps with those in front of the one
+  tooth of the pattern that is easiest to recognise (Found by triggerPattern_begin())
+- Once it has sync, it only checks that the ratio of each new gap matches that of the next tooth
+
+Either way the work per tooth is bounded by TRIGGER_PATTERN_MAX_SIGNATURE, regardless of the pattern.
+*/
+#ifndef TRIGGER_PATTERN_H
+#define TRIGGER_PATTERN_H
+
+#include <Arduino.h>
+
+#define TRIGGER_PATTERN_MAX_SIGNATURE 6 ///< The most gap ratios that are compared when looking for sync
+#define TRIGGER_PATTERN_MAX_TEETH     60 ///< The most teeth a pattern can have
+#define TRIGGER_PATTERN_RATIO_SHIFT   6 ///< The number of fractional bits of nextGapRatios (So ratios of up to 3.98 can be held)
+#define TRIGGER_PATTERN_COUNT         4 ///< The number of built in patterns (See getTriggerPattern())
+
+/** The return values of triggerPattern_tooth() */
+#define TRIGGER_PATTERN_NO_SYNC       0 ///< There is no sync (yet)
+#define TRIGGER_PATTERN_SYNCED        1 ///< The tooth was recognised and sync has just been gained
+#define TRIGGER_PATTERN_TOOTH         2 ///< The tooth matched the next one in the pattern
+#define TRIGGER_PATTERN_SYNC_LOST     3 ///< The tooth didn't match the next one in the pattern, so sync has been lost
+
+/** The description of a trigger wheel.
+ * Tooth #1 (At angle 0) is the reference that the trigger angle is set from.
+ */
+struct triggerPattern {
+  const uint16_t *toothAngles; ///< (PROGMEM) The angle of each tooth after tooth #1, in ascending order. The first is always 0
+  uint8_t teeth;               ///< The number of (physical) teeth
+  uint16_t cycleAngle;         ///< The crank angle covered by the teeth. 360 for a crank wheel or 720 for a cam wheel
+};
+
+/** The matching state of a pattern. Written by the trigger interrupt once triggerPattern_begin() has been called */
+struct triggerPatternState {
+  const triggerPattern *pattern;
+  uint32_t gaps[TRIGGER_PATTERN_MAX_SIGNATURE + 1]; ///< The most recent tooth gaps (uS), as a ring buffer
+  uint8_t gapHead;         ///< The index in gaps of the latest gap
+  uint8_t gapCount;        ///< The number of valid entries in gaps
+  uint8_t tooth;           ///< The index (0 based) of the current tooth. Only valid when synced
+  bool synced;
+  uint8_t syncTooth;       ///< The index of the tooth that sync is gained on
+  uint8_t signatureLength; ///< The number of gap ratios that identify syncTooth. 0 if the pattern can't be synced from its gaps alone
+  uint8_t toleranceNum;    ///< The measured gap ratios must be within toleranceNum/(toleranceNum-1) of the pattern to gain sync
+  uint16_t minGapAngle;    ///< The shortest gap in the pattern
+  uint16_t maxGapAngle;    ///< The longest gap in the pattern
+  uint8_t nextGapRatios[TRIGGER_PATTERN_MAX_TEETH]; ///< For each tooth, the angle of the gap after it over that of the gap before it (See triggerPattern_nextGap())
+};
+
+const triggerPattern *getTriggerPattern(uint8_t index);
+
+bool triggerPattern_begin(triggerPatternState &state, const triggerPattern *pattern);
+void triggerPattern_reset(triggerPatternState &state);
+uint8_t triggerPattern_tooth(triggerPatternState &state, uint32_t gap);
+uint8_t triggerPattern_toothAtAngle(const triggerPattern *pattern, uint16_t angle);
+
+/** The angle of a tooth from tooth #1 */
+static inline uint16_t triggerPattern_toothAngle(const triggerPattern *pattern, uint8_t tooth)
+{
+  return pgm_read_word(&pattern->toothAngles[tooth]);
+}
+
+/** The angle between a tooth and the one before it */
+static inline uint16_t triggerPattern_gapAngle(const triggerPattern *pattern, uint8_t tooth)
+{
+  if(tooth == 0U) { return pattern->cycleAngle - triggerPattern_toothAngle(pattern, pattern->teeth - 1U); }
+  return triggerPattern_toothAngle(pattern, tooth) - triggerPattern_toothAngle(pattern, tooth - 1U);
+}
+
+/** The expected length of the gap after the current tooth, from the length of the gap before it. Only valid when synced.
+ * This is a multiply and shift, as it is used on every tooth by the trigger interrupt
+ */
+static inline uint32_t triggerPattern_nextGap(const triggerPatternState &state, uint32_t gap)
+{
+  return (gap * state.nextGapRatios[state.tooth]) >> TRIGGER_PATTERN_RATIO_SHIFT;
+}
+
+/** The index of the tooth after the given one */
+static inline uint8_t triggerPattern_nextTooth(const triggerPattern *pattern, uint8_t tooth)
+{
+  return (tooth >= (pattern->teeth - 1U)) ? 0U : (tooth + 1U);
+}
+
+#endif // TRIGGER_PATTERN_H
@@ -661,6 +661,7 @@ void doUpdates(void)
       *table_Y = (120 + 10*i);
       ++table_Y;
     }
+    invalidate_axis_cache(&boostTableLookupDuty.get_value_cache);
 
     //AFR Protection added, add default values
     configPage9.afrProtectEnabled = 0; //Disable by default
@@ -696,6 +697,15 @@ void doUpdates(void)
     //Oil Pressure protection delay added. Set to 0 to match existing behaviour
     configPage10.oilPressureProtTime = 0;
 
+    //Per tooth injection timing added. Off to match existing behaviour
+    configPage10.perToothInj = 0;
+
+    //Generic trigger decoder added
+    configPage10.genericTrigPattern = 0;
+
+    //Predictive crank angle methods added. Last interval to match existing behaviour
+    configPage10.crankPrediction = CRANK_PREDICTION_OFF;
+
     writeAllConfig();
     storeEEPROMVersion(21);
   }
@@ -732,6 +742,7 @@ void multiplyTableLoad(const void *pTable, table_type_t key, uint8_t multiplier)
     *y_it = *y_it * multiplier; 
     ++y_it;
   }
+  invalidate_table_axes(pTable, key);
 }
 
 void divideTableLoad(const void *pTable, table_type_t key, uint8_t divisor)
@@ -742,4 +753,5 @@ void divideTableLoad(const void *pTable, table_type_t key, uint8_t divisor)
     *y_it = *y_it / divisor; //Previous TS scale was 2.0, now is 0.5, 4x increase
     ++y_it;
   }
+  invalidate_table_axes(pTable, key);
 }
@@ -155,6 +155,8 @@ void checkProgrammableIO(void)
   uint8_t dataRequested;
   bool firstCheck, secondCheck;
 
+  updateOutputChannels(); //ProgrammableIOGetData() reads the realtime data block
+
   for (uint8_t y = 0; y < sizeof(configPage13.outputPin); y++)
   {
     firstCheck = false;
@@ -253,7 +255,8 @@ void checkProgrammableIO(void)
   }
 }
 /** Get single I/O data var (from currentStatus) for comparison.
- * Uses member offset index @ref fsIntIndex to lookup realtime 'live' data from @ref currentStatus.
+ * Uses member offset index @ref fsIntIndex to lookup realtime 'live' data from the realtime data block (See output_channels.h).
+ * The block must have been refreshed with updateOutputChannels() first.
  * @param index - Field index/number (?)
  * @return 16 bit (int) result
  */
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <math.h>
+#include <unity.h>
+#include "crank_prediction.cpp"
+
+/*
+Compares the accuracy of the crank speed estimates used by angleToTime() (See crankMaths.ino), by simulating a crank
+that follows an exact path. At every tooth each method predicts when the crank will reach a point further on (As when
+scheduling a spark) and the error, converted to degrees at the actual speed, is recorded:
+- Last revolution:  The speed over the last 360 degrees (CRANKMATH_METHOD_INTERVAL_REV)
+- Last tooth:       The speed over the last tooth gap (CRANKMATH_METHOD_INTERVAL_TOOTH)
+- Alpha-beta:       CRANK_PREDICTION_ALPHA_BETA
+- 2nd derivative:   CRANK_PREDICTION_2ND_DERIV
+*/
+
+#define METHOD_REV          0
+#define METHOD_TOOTH        1
+#define METHOD_ALPHA_BETA   2
+#define METHOD_2ND_DERIV    3
+#define METHOD_COUNT        4
+static const char * const methodNames[METHOD_COUNT] = { "Last revolution", "Last tooth", "Alpha-beta", "2nd derivative" };
+
+struct crankProfile {
+  const char *name;
+  uint16_t toothAngle;  //Evenly spaced teeth
+  double startRPM;
+  double rpmPerSecond;
+  double endRPM;         //The simulation stops once this is passed
+  uint16_t targetAngle; //How far ahead of each tooth the prediction is made for
+  double jitter;        //Random error in each tooth time, as a fraction of the gap
+};
+
+struct predictionResult {
+  double worstError;
+  double meanError;
+};
+
+//The time (uS) that the crank reaches the given angle, under constant acceleration
+static double crankTimeAt(const crankProfile &profile, double angle)
+{
+  double degreesPerUs = profile.startRPM * 6.0 / 1000000.0;
+  double accel = profile.rpmPerSecond * 6.0 / 1000000.0 / 1000000.0; //Degrees per uS^2
+  if (fabs(accel) < 1e-18) { return angle / degreesPerUs; }
+  return (-degreesPerUs + sqrt((degreesPerUs * degreesPerUs) + (2.0 * accel * angle))) / accel;
+}
+
+static double rpmAt(const crankProfile &profile, double t)
+{
+  return profile.startRPM + (profile.rpmPerSecond * t / 1000000.0);
+}
+
+static void runCrank(const crankProfile &profile, predictionResult results[METHOD_COUNT])
+{
+  crankPrediction alphaBeta;
+  crankPrediction secondDeriv;
+  crankPrediction_reset(alphaBeta);
+  crankPrediction_reset(secondDeriv);
+
+  const uint16_t teethPerRev = 360U / profile.toothAngle;
+  uint32_t toothTimes[64] = { 0 }; //The last revolution of tooth times, indexed by tooth number
+  double totalError[METHOD_COUNT] = { 0 };
+  double worstError[METHOD_COUNT] = { 0 };
+  uint32_t samples = 0;
+  srand(1);
+
+  uint32_t lastToothTime = 0;
+  for (uint32_t tooth = 1; ; tooth++)
+  {
+    double exactTime = crankTimeAt(profile, (double)tooth * profile.toothAngle);
+    double rpm = rpmAt(profile, exactTime);
+    if ( (profile.rpmPerSecond >= 0) ? (rpm > profile.endRPM) : (rpm < profile.endRPM) ) { break; }
+    double jitter = profile.jitter * ((double)rand() / RAND_MAX - 0.5) * 2.0;
+    uint32_t toothTime = (uint32_t)(exactTime + (jitter * (exactTime - crankTimeAt(profile, (double)(tooth - 1U) * profile.toothAngle))));
+    uint32_t gap = toothTime - lastToothTime;
+    lastToothTime = toothTime;
+    uint32_t revolutionTime = toothTime - toothTimes[tooth % teethPerRev];
+    toothTimes[tooth % teethPerRev] = toothTime;
+
+    crankPrediction_tooth(alphaBeta, gap, profile.toothAngle, CRANK_PREDICTION_ALPHA_BETA);
+    crankPrediction_tooth(secondDeriv, gap, profile.toothAngle, CRANK_PREDICTION_2ND_DERIV);
+    if (tooth <= (2U * teethPerRev)) { continue; } //Let everything settle
+
+    uint32_t predicted[METHOD_COUNT];
+    predicted[METHOD_REV] = (uint32_t)(((uint64_t)revolutionTime * profile.targetAngle) / 360U);
+    predicted[METHOD_TOOTH] = (uint32_t)(((uint64_t)gap * profile.targetAngle) / profile.toothAngle);
+    TEST_ASSERT_TRUE(crankPrediction_angleToTime(alphaBeta, profile.targetAngle, predicted[METHOD_ALPHA_BETA]));
+    TEST_ASSERT_TRUE(crankPrediction_angleToTime(secondDeriv, profile.targetAngle, predicted[METHOD_2ND_DERIV]));
+
+    //The error is against the exact tooth position, so the jitter of this tooth counts against every method equally
+    double targetTime = crankTimeAt(profile, ((double)tooth * profile.toothAngle) + profile.targetAngle);
+    double degreesPerUs = rpmAt(profile, targetTime) * 6.0 / 1000000.0;
+    for (uint8_t method = 0; method < METHOD_COUNT; method++)
+    {
+      double error = fabs(((double)toothTime + predicted[method] - targetTime) * degreesPerUs);
+      totalError[method] += error;
+      if (error > worstError[method]) { worstError[method] = error; }
+    }
+    samples++;
+  }
+  TEST_ASSERT_TRUE(samples > 0U);
+
+  for (uint8_t method = 0; method < METHOD_COUNT; method++)
+  {
+    results[method].worstError = worstError[method];
+    results[method].meanError = totalError[method] / samples;
+    char message[128];
+    snprintf(message, sizeof(message), "%-28s %-16s %5lu teeth, worst error %6.2f deg, mean %5.2f deg", profile.name, methodNames[method], (unsigned long)samples, results[method].worstError, results[method].meanError);
+    TEST_MESSAGE(message);
+  }
+}
+
+static void test_crankPrediction_steady(void)
+{
+  //At a steady speed the prediction is exact
+  crankPrediction state;
+  crankPrediction_reset(state);
+  uint32_t time;
+  uint16_t angle;
+  crankPrediction_tooth(state, 1000, 10, CRANK_PREDICTION_ALPHA_BETA);
+  TEST_ASSERT_FALSE(crankPrediction_angleToTime(state, 10, time)); //Needs 2 teeth
+  crankPrediction_tooth(state, 1000, 10, CRANK_PREDICTION_ALPHA_BETA);
+  TEST_ASSERT_TRUE(crankPrediction_angleToTime(state, 90, time));
+  TEST_ASSERT_EQUAL_UINT32(9000, time);
+  TEST_ASSERT_TRUE(crankPrediction_timeToAngle(state, 4500, angle));
+  TEST_ASSERT_EQUAL_UINT16(45, angle);
+
+  crankPrediction_reset(state);
+  TEST_ASSERT_FALSE(crankPrediction_timeToAngle(state, 4500, angle));
+}
+
+static void test_crankPrediction_unevenTeeth(void)
+{
+  //A change of tooth angle is scaled, so it isn't seen as a change in speed
+  crankPrediction state;
+  crankPrediction_reset(state);
+  uint32_t time;
+  crankPrediction_tooth(state, 1000, 10, CRANK_PREDICTION_2ND_DERIV);
+  crankPrediction_tooth(state, 1000, 10, CRANK_PREDICTION_2ND_DERIV);
+  crankPrediction_tooth(state, 2000, 20, CRANK_PREDICTION_2ND_DERIV);
+  TEST_ASSERT_EQUAL_INT32(0, state.trendx16);
+  TEST_ASSERT_TRUE(crankPrediction_angleToTime(state, 30, time));
+  TEST_ASSERT_EQUAL_UINT32(3000, time);
+}
+
+static void test_crankPrediction_inverse(void)
+{
+  //timeToAngle() is the inverse of angleToTime() when accelerating
+  crankPrediction state;
+  crankPrediction_reset(state);
+  crankPrediction_tooth(state, 1050, 10, CRANK_PREDICTION_2ND_DERIV);
+  crankPrediction_tooth(state, 1000, 10, CRANK_PREDICTION_2ND_DERIV);
+  for (uint16_t angle = 10; angle <= 90; angle += 5)
+  {
+    uint32_t time;
+    uint16_t result;
+    TEST_ASSERT_TRUE(crankPrediction_angleToTime(state, angle, time));
+    TEST_ASSERT_TRUE(crankPrediction_timeToAngle(state, time, result));
+    TEST_ASSERT_UINT16_WITHIN(1, angle, result);
+  }
+}
+
+//The predictive methods must be better than both last interval methods when the speed is changing
+static void comparePrediction(const crankProfile &profile, uint8_t lastMethod)
+{
+  predictionResult results[METHOD_COUNT];
+  runCrank(profile, results);
+  for (uint8_t method = METHOD_ALPHA_BETA; method <= lastMethod; method++)
+  {
+    TEST_ASSERT_TRUE(results[method].meanError < results[METHOD_REV].meanError);
+    TEST_ASSERT_TRUE(results[method].meanError < results[METHOD_TOOTH].meanError);
+  }
+}
+
+static void test_crankPrediction_acceleration(void)
+{
+  //10,000 RPM/s, predicting a spark 90 degrees ahead.
+  //On fine teeth the 2nd derivative is filtered in the same way as alpha-beta (See crankPrediction_tooth())
+  comparePrediction({ "36 teeth, 10000rpm/s", 10, 1000, 10000, 7000, 90, 0 }, METHOD_2ND_DERIV);
+  comparePrediction({ "4 teeth, 10000rpm/s", 90, 1000, 10000, 7000, 90, 0 }, METHOD_2ND_DERIV);
+  comparePrediction({ "2 teeth, 10000rpm/s", 180, 1000, 10000, 7000, 180, 0 }, METHOD_2ND_DERIV);
+}
+
+static void test_crankPrediction_deceleration(void)
+{
+  comparePrediction({ "36 teeth, -10000rpm/s", 10, 7000, -10000, 1000, 90, 0 }, METHOD_2ND_DERIV);
+  comparePrediction({ "4 teeth, -10000rpm/s", 90, 7000, -10000, 1000, 90, 0 }, METHOD_2ND_DERIV);
+}
+
+static void test_crankPrediction_jitter(void)
+{
+  //0.2 degrees of jitter in the position of each tooth (2% of a 10 degree gap, 0.2% of a 90 degree one).
+  //Neither predictive method may pass on more than the last tooth does, and the worst case is bounded. On fine wheels
+  //the 2nd derivative of a single pair of gaps would be extrapolated over many teeth, so is filtered as alpha-beta is
+  predictionResult results[METHOD_COUNT];
+  runCrank({ "36 teeth, 10000rpm/s, jitter", 10, 1000, 10000, 7000, 90, 0.02 }, results);
+  for (uint8_t method = METHOD_ALPHA_BETA; method <= METHOD_2ND_DERIV; method++)
+  {
+    TEST_ASSERT_TRUE(results[method].meanError < results[METHOD_TOOTH].meanError);
+    TEST_ASSERT_TRUE(results[method].worstError < results[METHOD_TOOTH].worstError);
+    TEST_ASSERT_TRUE(results[method].worstError < 2.5);
+  }
+
+  runCrank({ "4 teeth, 10000rpm/s, jitter", 90, 1000, 10000, 7000, 90, 0.002 }, results);
+  for (uint8_t method = METHOD_ALPHA_BETA; method <= METHOD_2ND_DERIV; method++)
+  {
+    TEST_ASSERT_TRUE(results[method].meanError < results[METHOD_TOOTH].meanError);
+    TEST_ASSERT_TRUE(results[method].worstError < results[METHOD_TOOTH].worstError);
+    TEST_ASSERT_TRUE(results[method].worstError < 2.0);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_crankPrediction_steady);
+  RUN_TEST(test_crankPrediction_unevenTeeth);
+  RUN_TEST(test_crankPrediction_inverse);
+  RUN_TEST(test_crankPrediction_acceleration);
+  RUN_TEST(test_crankPrediction_deceleration);
+  RUN_TEST(test_crankPrediction_jitter);
+
+  UNITY_END();
+
+  return 0;
+}
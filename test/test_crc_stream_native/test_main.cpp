@@ -0,0 +1,171 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "src/FastCRC/FastCRCsw.cpp"
+#include "crc_stream.h"
+#include "../test_perf_native/perf_timer.h"
+
+volatile uint32_t perf_sink;
+static FastCRC32 crc;
+static FastCRC32 otherCRC;
+
+static void test_crcStream_checkValue(void)
+{
+  //The standard CRC-32 check value, split at every point
+  const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  for (uint8_t split = 0; split <= sizeof(check); split++)
+  {
+    crcStream stream;
+    crcStream_begin(stream);
+    crcStream_update(crc, stream, check, split);
+    crcStream_update(crc, stream, &check[split], sizeof(check) - split);
+    TEST_ASSERT_EQUAL_UINT32(0xCBF43926UL, crcStream_end(stream));
+  }
+
+  crcStream stream;
+  crcStream_begin(stream);
+  TEST_ASSERT_EQUAL_UINT32(0, crcStream_end(stream));
+  TEST_ASSERT_EQUAL_UINT32(crc.crc32(check, 0), crcStream_end(stream));
+}
+
+static void test_crcStream_randomParts(void)
+{
+  //Any split matches the CRC of the whole, even with other CRCs calculated between the parts
+  static uint8_t data[1024];
+  srand(1);
+  for (uint16_t x = 0; x < sizeof(data); x++) { data[x] = (uint8_t)rand(); }
+
+  for (uint16_t run = 0; run < 200U; run++)
+  {
+    uint16_t length = (uint16_t)(rand() % sizeof(data));
+    uint32_t expected = crc.crc32(data, length);
+    crcStream stream;
+    crcStream_begin(stream);
+    uint16_t sent = 0;
+    while (sent < length)
+    {
+      uint16_t part = (uint16_t)(rand() % 80);
+      if (part > (length - sent)) { part = length - sent; }
+      crcStream_update(crc, stream, &data[sent], part);
+      otherCRC.crc32(data, 16);
+      sent += part;
+    }
+    TEST_ASSERT_EQUAL_UINT32(expected, crcStream_end(stream));
+  }
+}
+
+/*
+As sendSerialPayload() and continueSerialTransmission() in comms.cpp, with a 64 byte tx buffer (As the AVR and native
+boards). Each call writes what fits in the buffer, and the last also writes the CRC. The time that call takes is
+the delay between the last byte of the payload and its CRC
+*/
+#define TX_BUFFER_SIZE 64U
+static uint8_t txData[1024 + 4];
+static uint16_t txLength;
+
+static void txWrite(const uint8_t *pData, uint16_t length)
+{
+  memcpy(&txData[txLength], pData, length);
+  txLength += length;
+}
+
+static void txWriteCRC(uint32_t value)
+{
+  uint8_t bytes[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+  txWrite(bytes, sizeof(bytes));
+}
+
+//Returns true once the CRC has been written
+static bool sendChunk(const uint8_t *pPayload, uint16_t length, uint16_t &sent, crcStream &stream, bool streaming)
+{
+  uint16_t chunk = length - sent;
+  if (chunk > TX_BUFFER_SIZE) { chunk = TX_BUFFER_SIZE; }
+  txWrite(&pPayload[sent], chunk);
+  if (streaming == true) { crcStream_update(crc, stream, &pPayload[sent], chunk); }
+  sent += chunk;
+  if (sent < length) { return false; }
+  txWriteCRC( (streaming == true) ? crcStream_end(stream) : crc.crc32(pPayload, length) );
+  return true;
+}
+
+struct sendTimes {
+  uint64_t lastCall; //ns
+  uint64_t total;    //ns
+};
+
+static sendTimes timeSend(const uint8_t *pPayload, uint16_t length, bool streaming)
+{
+  static constexpr uint32_t SENDS = 2000U;
+  sendTimes best = { UINT64_MAX, UINT64_MAX };
+  for (uint8_t repeat = 0; repeat < PERF_REPEATS; repeat++)
+  {
+    sendTimes times = { 0, 0 };
+    for (uint32_t send = 0; send < SENDS; send++)
+    {
+      txLength = 0;
+      uint16_t sent = 0;
+      crcStream stream;
+      crcStream_begin(stream);
+      bool done = false;
+      while (done == false)
+      {
+        uint64_t start = perf_now_ns();
+        done = sendChunk(pPayload, length, sent, stream, streaming);
+        uint64_t time = perf_now_ns() - start;
+        times.total += time;
+        if (done == true) { times.lastCall += time; }
+      }
+      perf_sink = perf_sink + txData[txLength - 1U];
+    }
+    if (times.lastCall < best.lastCall) { best.lastCall = times.lastCall; }
+    if (times.total < best.total) { best.total = times.total; }
+  }
+  best.lastCall /= SENDS;
+  best.total /= SENDS;
+  return best;
+}
+
+static void test_crcStream_sendLatency(void)
+{
+  static uint8_t payload[1024];
+  for (uint16_t x = 0; x < sizeof(payload); x++) { payload[x] = (uint8_t)(x * 7U); }
+
+  //A realtime data poll, a full serial buffer (Page reads) and a page read with SD logging (Larger buffer)
+  static const uint16_t lengths[] = { 143, 517, 1024 };
+  for (uint8_t x = 0; x < (sizeof(lengths) / sizeof(lengths[0])); x++)
+  {
+    //Both send the same bytes
+    crcStream stream;
+    uint16_t sent = 0;
+    txLength = 0;
+    crcStream_begin(stream);
+    while (sendChunk(payload, lengths[x], sent, stream, true) == false) { }
+    uint8_t streamed[sizeof(txData)];
+    memcpy(streamed, txData, txLength);
+    sent = 0;
+    txLength = 0;
+    while (sendChunk(payload, lengths[x], sent, stream, false) == false) { }
+    TEST_ASSERT_EQUAL_MEMORY(txData, streamed, txLength);
+
+    sendTimes twoPass = timeSend(payload, lengths[x], false);
+    sendTimes streaming = timeSend(payload, lengths[x], true);
+    char message[160];
+    snprintf(message, sizeof(message), "%4u bytes: last byte to CRC %5lu ns -> %4lu ns, total %5lu ns -> %5lu ns",
+             lengths[x], (unsigned long)twoPass.lastCall, (unsigned long)streaming.lastCall, (unsigned long)twoPass.total, (unsigned long)streaming.total);
+    TEST_MESSAGE(message);
+    if (lengths[x] > (2U * TX_BUFFER_SIZE)) { TEST_ASSERT_TRUE(streaming.lastCall < twoPass.lastCall); }
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_crcStream_checkValue);
+  RUN_TEST(test_crcStream_randomParts);
+  RUN_TEST(test_crcStream_sendLatency);
+
+  UNITY_END();
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include <decoders.h>
+#include <globals.h>
+#include <unity.h>
+#include "generic.h"
+
+
+void test_setup_generic(byte pattern)
+{
+    //Setup the generic decoder with one of its built in patterns
+    configPage10.genericTrigPattern = pattern;
+    configPage4.TrigSpeed = CRANK_SPEED;
+    configPage4.trigPatternSec = SEC_TRIGGER_SINGLE;
+    configPage4.sparkMode = IGN_MODE_WASTED;
+
+    triggerSetup_Generic();
+}
+
+//************************************** Begin the new ignition setEndTooth tests **************************************
+//On the missing tooth patterns the end teeth must be the same as the missing tooth decoder gives
+void test_generic_newIgn_36_1_trig0_1()
+{
+    //Test the set end tooth function. Conditions:
+    //Trigger: 36-1
+    //Advance: 10
+    //triggerAngle=0
+    test_setup_generic(0);
+    ignition1EndAngle = 360 - 10; //Set 10 degrees advance
+    configPage4.triggerAngle = 0; //No trigger offset
+
+    triggerSetEndTeeth_Generic();
+    TEST_ASSERT_EQUAL(34, ignition1EndTooth);
+}
+
+void test_generic_newIgn_36_1_trig90_1()
+{
+    //Test the set end tooth function. Conditions:
+    //Trigger: 36-1
+    //Advance: 10
+    //triggerAngle=90
+    test_setup_generic(0);
+    ignition1EndAngle = 360 - 10; //Set 10 degrees advance
+    configPage4.triggerAngle = 90;
+
+    triggerSetEndTeeth_Generic();
+    TEST_ASSERT_EQUAL(25, ignition1EndTooth);
+}
+
+void test_generic_newIgn_36_1_trigNeg90_1()
+{
+    //Test the set end tooth function. Conditions:
+    //Trigger: 36-1
+    //Advance: 10
+    //triggerAngle=-90
+    test_setup_generic(0);
+    ignition1EndAngle = 360 - 10; //Set 10 degrees advance
+    configPage4.triggerAngle = -90;
+
+    triggerSetEndTeeth_Generic();
+    TEST_ASSERT_EQUAL(7, ignition1EndTooth);
+}
+
+void test_generic_newIgn_36_1_trig180_2()
+{
+    //Test the set end tooth function. Conditions:
+    //Trigger: 36-1
+    //Advance: 10
+    //triggerAngle=180
+    test_setup_generic(0);
+    ignition2EndAngle = 180 - 10; //Set 10 degrees advance
+    configPage4.triggerAngle = 180;
+
+    triggerSetEndTeeth_Generic();
+    TEST_ASSERT_EQUAL(34, ignition2EndTooth);
+}
+
+void test_generic_newIgn_36_2_2_2_trig0_1()
+{
+    //Test the set end tooth function. Conditions:
+    //Trigger: 36-2-2-2
+    //Advance: 10
+    //triggerAngle=0
+    test_setup_generic(2);
+    ignition1EndAngle = 360 - 10; //Set 10 degrees advance
+    configPage4.triggerAngle = 0; //No trigger offset
+
+    triggerSetEndTeeth_Generic();
+    TEST_ASSERT_EQUAL(30, ignition1EndTooth); //The tooth at 330 degrees
+}
+
+void test_generic_newIgn_36_2_2_2_gap_1()
+{
+    //Test the set end tooth function when the end angle falls in one of the gaps. Conditions:
+    //Trigger: 36-2-2-2
+    //Advance: 200
+    //triggerAngle=0
+    test_setup_generic(2);
+    ignition1EndAngle = 360 - 200;
+    configPage4.triggerAngle = 0; //No trigger offset
+
+    triggerSetEndTeeth_Generic();
+    TEST_ASSERT_EQUAL(13, ignition1EndTooth); //The last tooth before the gap (120 degrees)
+}
+
+void testGeneric()
+{
+  RUN_TEST(test_generic_newIgn_36_1_trig0_1);
+  RUN_TEST(test_generic_newIgn_36_1_trig90_1);
+  RUN_TEST(test_generic_newIgn_36_1_trigNeg90_1);
+  RUN_TEST(test_generic_newIgn_36_1_trig180_2);
+  RUN_TEST(test_generic_newIgn_36_2_2_2_trig0_1);
+  RUN_TEST(test_generic_newIgn_36_2_2_2_gap_1);
+}
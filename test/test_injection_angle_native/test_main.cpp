@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <math.h>
+#include <unity.h>
+#include "src/NativeArduino/NativeArduino.cpp"
+#include "table2d.ino"
+#include "scheduler.ino"
+#include "utilities.h"
+
+/*
+Compares the accuracy of the 2 ways of setting the fuel schedules, by simulating an engine on the native board's
+virtual clock (See test_schedules_native):
+- Time domain: The main loop estimates the current crank angle from the last tooth and converts the angle until each
+  injection into a time, as per the BEGIN FUEL SCHEDULES section of speeduino.ino
+- Angle domain: The main loop leaves the start angles with setFuelScheduleAngle() and the decoder sets each schedule from
+  the last tooth before it, with setFuelSchedulesFromTooth() (Per tooth injection, configPage10.perToothInj)
+The crank follows an exact, continuously accelerating, path. The crank angle at which each injector actually opens is
+compared to the requested start angle and the worst case and mean errors of each method are reported.
+*/
+
+// The firmware state used by scheduler.ino
+struct statuses currentStatus;
+struct config4 configPage4;
+table2D_u8_u8 PrimingPulseTable;
+byte channelInjEnabled;
+volatile uint16_t ignitionCount;
+int CRANK_ANGLE_MAX_INJ = 720;
+volatile uint16_t timePerDegreex16;
+native_compare_t nativeTimers[NATIVE_TIMER_COUNT];
+
+//Only the fuel schedule compare units are simulated. Must be in the same order as native_timer_t
+static void (* const scheduleISRs[NATIVE_TIMER_COUNT])(void) = {
+  fuelSchedule1Interrupt, fuelSchedule2Interrupt, fuelSchedule3Interrupt, fuelSchedule4Interrupt,
+  fuelSchedule5Interrupt, fuelSchedule6Interrupt, fuelSchedule7Interrupt, fuelSchedule8Interrupt,
+  nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  nullptr, nullptr, nullptr, nullptr,
+};
+static COUNTER_TYPE lastTimerCounter;
+
+void nativeServiceInterrupts(void)
+{
+  static bool inInterrupt = false;
+  if ( (nativeInterruptsEnabled == false) || (inInterrupt == true) ) { return; }
+  inInterrupt = true;
+
+  COUNTER_TYPE counter = NATIVE_TIMER_COUNTER;
+  if (counter != lastTimerCounter)
+  {
+    nativeServiceCompareUnits(lastTimerCounter, counter, scheduleISRs);
+    lastTimerCounter = counter;
+  }
+
+  inInterrupt = false;
+}
+
+// Moves the virtual clock to the given time, stopping at every compare match on the way
+static void runUntil(uint32_t until)
+{
+  uint32_t now = micros();
+  while ((int32_t)(until - now) > 0)
+  {
+    uint32_t ticks = nativeTicksToNextCompare(lastTimerCounter, scheduleISRs);
+    uint32_t next = (now & ~3UL) + (ticks * 4UL);
+    if ( (ticks == 0U) || ((int32_t)(next - until) > 0) ) { next = until; }
+    nativeSetVirtualClock(next);
+    now = next;
+  }
+}
+
+// The simulated engine: a 4 cylinder, sequential, with a 36-1 crank wheel. Tooth #1 is at 0 degrees
+#define TRIGGER_TEETH         36
+#define TRIGGER_TOOTH_ANGLE   (360 / TRIGGER_TEETH)
+#define SIM_CHANNELS          4
+#define PULSE_WIDTH           4000UL  //uS
+#define START_ANGLE           300     //Relative to each channel's TDC
+#define WARMUP_CYCLES         2       //Engine cycles before the errors are recorded
+static const uint16_t channelDegrees[SIM_CHANNELS] = { 0, 180, 360, 540 };
+
+struct engineProfile {
+  const char *name;
+  double startRPM;
+  double rpmPerSecond;
+  uint32_t duration; //uS
+  uint32_t mainLoopTime; //The time (uS) between the main loop setting the schedules
+};
+
+// The crank angle (Degrees since the start of the run) at the given time since the start of the run
+static double crankAngleAt(const engineProfile &profile, double time)
+{
+  double rpmPeruS = profile.rpmPerSecond / 1000000.0;
+  return 0.000006 * ( (profile.startRPM * time) + (0.5 * rpmPeruS * time * time) );
+}
+
+// The inverse of crankAngleAt()
+static double timeAtCrankAngle(const engineProfile &profile, double angle)
+{
+  double rpmPeruS = profile.rpmPerSecond / 1000000.0;
+  if (profile.rpmPerSecond == 0.0) { return angle / (0.000006 * profile.startRPM); }
+  return ( sqrt( (profile.startRPM * profile.startRPM) + (2.0 * rpmPeruS * angle / 0.000006) ) - profile.startRPM ) / rpmPeruS;
+}
+
+// The decoder state, as per the missing tooth decoder
+static uint32_t toothLastToothTime;
+static uint32_t toothLastMinusOneToothTime;
+static uint32_t toothOneTime;
+static uint32_t toothOneMinusOneTime;
+static uint16_t lastToothAngle; //Within the engine cycle
+static bool lastToothAfterGap;
+
+// The results
+static uint32_t runStartTime;
+static const engineProfile *pProfile;
+static uint32_t startCount[SIM_CHANNELS];
+static uint32_t recordedCount;
+static double worstError;
+static double totalError;
+
+template <uint8_t channel> static void recordStart(void)
+{
+  double angle = crankAngleAt(*pProfile, (double)(micros() - runStartTime));
+  ++startCount[channel];
+  if (angle < (WARMUP_CYCLES * 720.0)) { return; }
+
+  double target = START_ANGLE + channelDegrees[channel];
+  double error = fmod(angle - target, 720.0);
+  if (error >= 360.0) { error -= 720.0; }
+  else if (error < -360.0) { error += 720.0; }
+
+  if (fabs(error) > fabs(worstError)) { worstError = error; }
+  totalError += fabs(error);
+  ++recordedCount;
+}
+static void endInjection(void) { }
+
+static void (* const setFuelSchedules[SIM_CHANNELS])(unsigned long, unsigned long) = {
+  setFuelSchedule1, setFuelSchedule2, setFuelSchedule3, setFuelSchedule4,
+};
+
+static void resetEngine(const engineProfile &profile)
+{
+  initialiseSchedulers();
+  inj1StartFunction = recordStart<0>; inj1EndFunction = endInjection;
+  inj2StartFunction = recordStart<1>; inj2EndFunction = endInjection;
+  inj3StartFunction = recordStart<2>; inj3EndFunction = endInjection;
+  inj4StartFunction = recordStart<3>; inj4EndFunction = endInjection;
+
+  runUntil(micros() + 100000UL);
+  runStartTime = micros();
+  pProfile = &profile;
+  toothLastToothTime = 0;
+  toothLastMinusOneToothTime = 0;
+  toothOneTime = 0;
+  toothOneMinusOneTime = 0;
+  lastToothAngle = 0;
+  lastToothAfterGap = false;
+  for (uint8_t channel = 0; channel < SIM_CHANNELS; channel++) { startCount[channel] = 0; }
+  recordedCount = 0;
+  worstError = 0.0;
+  totalError = 0.0;
+  timePerDegreex16 = (uint16_t)(2666656.0 / profile.startRPM);
+}
+
+// The primary trigger ISR
+static void toothSeen(uint32_t toothNumber, bool perToothInjection)
+{
+  uint16_t toothInRevolution = toothNumber % TRIGGER_TEETH; //0 is tooth #1
+  toothLastMinusOneToothTime = toothLastToothTime;
+  toothLastToothTime = micros();
+  lastToothAfterGap = (toothInRevolution == 0U);
+  if (lastToothAfterGap)
+  {
+    toothOneMinusOneTime = toothOneTime;
+    toothOneTime = toothLastToothTime;
+  }
+  lastToothAngle = (toothNumber * TRIGGER_TOOTH_ANGLE) % 720U;
+
+  if (perToothInjection)
+  {
+    uint16_t angleToNextTooth = (toothInRevolution == (TRIGGER_TEETH - 2)) ? (2 * TRIGGER_TOOTH_ANGLE) : TRIGGER_TOOTH_ANGLE;
+    noInterrupts();
+    setFuelSchedulesFromTooth(lastToothAngle, angleToNextTooth);
+    interrupts();
+  }
+}
+
+// The fuel schedule section of the main loop, including the crank speed calculations (doCrankSpeedCalcs() and getCrankAngle())
+static void mainLoop(bool perToothInjection)
+{
+  if (toothOneMinusOneTime == 0U) { return; } //No RPM yet
+
+  //Accelerating, so the time per degree is from the last 2 teeth when they are evenly spaced. Otherwise from the RPM of the last revolution
+  uint16_t rpm = (uint16_t)(60000000UL / (toothOneTime - toothOneMinusOneTime));
+  if (lastToothAfterGap) { timePerDegreex16 = (uint16_t)(2666656UL / rpm); }
+  else { timePerDegreex16 = (uint16_t)(((toothLastToothTime - toothLastMinusOneToothTime) * 16UL) / TRIGGER_TOOTH_ANGLE); }
+  uint16_t timePerDegree = timePerDegreex16 / 16U;
+  unsigned long degreesPeruSx32768 = 524288UL / timePerDegreex16;
+
+  int crankAngle = lastToothAngle + (int)(((micros() - toothLastToothTime) * degreesPeruSx32768) / 32768UL);
+  while (crankAngle >= CRANK_ANGLE_MAX_INJ) { crankAngle -= CRANK_ANGLE_MAX_INJ; }
+
+  for (uint8_t channel = 0; channel < SIM_CHANNELS; channel++)
+  {
+    int startAngle = (START_ANGLE + channelDegrees[channel]) % CRANK_ANGLE_MAX_INJ;
+    if (perToothInjection)
+    {
+      setFuelScheduleAngle(channel, startAngle, PULSE_WIDTH, true);
+    }
+    else
+    {
+      int tempCrankAngle = crankAngle - channelDegrees[channel];
+      if( tempCrankAngle < 0) { tempCrankAngle += CRANK_ANGLE_MAX_INJ; }
+      int tempStartAngle = startAngle - channelDegrees[channel];
+      if ( tempStartAngle < 0) { tempStartAngle += CRANK_ANGLE_MAX_INJ; }
+      if ( (tempStartAngle <= tempCrankAngle) && (fuelSchedules[channel].Status == RUNNING) ) { tempStartAngle += CRANK_ANGLE_MAX_INJ; }
+      if ( tempStartAngle > tempCrankAngle )
+      {
+        setFuelSchedules[channel](((tempStartAngle - tempCrankAngle) * (unsigned long)timePerDegree), PULSE_WIDTH);
+      }
+    }
+  }
+}
+
+struct injectionResult {
+  double worstError;
+  double meanError;
+};
+
+static injectionResult runEngine(const engineProfile &profile, bool perToothInjection)
+{
+  resetEngine(profile);
+
+  uint32_t toothNumber = 0;
+  uint32_t nextTooth = runStartTime;
+  uint32_t nextLoop = runStartTime + profile.mainLoopTime;
+  while ((micros() - runStartTime) < profile.duration)
+  {
+    if ((int32_t)(nextTooth - nextLoop) <= 0)
+    {
+      runUntil(nextTooth);
+      toothSeen(toothNumber, perToothInjection);
+      //Skip the missing tooth
+      toothNumber++;
+      if ((toothNumber % TRIGGER_TEETH) == (TRIGGER_TEETH - 1U)) { toothNumber++; }
+      nextTooth = runStartTime + (uint32_t)lround(timeAtCrankAngle(profile, toothNumber * (double)TRIGGER_TOOTH_ANGLE));
+    }
+    else
+    {
+      runUntil(nextLoop);
+      mainLoop(perToothInjection);
+      nextLoop += profile.mainLoopTime;
+    }
+  }
+
+  //Every channel must have injected once per cycle (Within 1, depending on where the run ended)
+  double cycles = crankAngleAt(profile, (double)(micros() - runStartTime)) / 720.0;
+  for (uint8_t channel = 0; channel < SIM_CHANNELS; channel++)
+  {
+    TEST_ASSERT_UINT32_WITHIN(2, (uint32_t)cycles, startCount[channel]);
+  }
+  TEST_ASSERT_TRUE(recordedCount > 0U);
+
+  injectionResult result = { worstError, totalError / recordedCount };
+  char message[128];
+  snprintf(message, sizeof(message), "%-22s %-12s %5lu injections, worst error %6.2f deg, mean %5.2f deg", profile.name, perToothInjection ? "Angle domain" : "Time domain", (unsigned long)recordedCount, result.worstError, result.meanError);
+  TEST_MESSAGE(message);
+  return result;
+}
+
+// Angle domain must be at least as accurate as time domain and within a fraction of a tooth
+#define MAX_ANGLE_DOMAIN_ERROR 1.0
+
+static void compareInjection(const engineProfile &profile)
+{
+  injectionResult timeDomain = runEngine(profile, false);
+  injectionResult angleDomain = runEngine(profile, true);
+
+  TEST_ASSERT_TRUE(fabs(angleDomain.worstError) <= MAX_ANGLE_DOMAIN_ERROR);
+  TEST_ASSERT_TRUE(fabs(angleDomain.worstError) <= fabs(timeDomain.worstError));
+  TEST_ASSERT_TRUE(angleDomain.meanError <= timeDomain.meanError);
+}
+
+static void test_injection_angle_steady(void)
+{
+  static const engineProfile profile = { "Steady 3000rpm", 3000.0, 0.0, 1000000UL, 1000UL };
+  compareInjection(profile);
+}
+
+static void test_injection_angle_acceleration(void)
+{
+  static const engineProfile profile = { "1500-7500rpm in 0.5s", 1500.0, 12000.0, 500000UL, 1000UL };
+  compareInjection(profile);
+}
+
+static void test_injection_angle_deceleration(void)
+{
+  static const engineProfile profile = { "7000-2000rpm in 1s", 7000.0, -5000.0, 1000000UL, 1000UL };
+  compareInjection(profile);
+}
+
+//A slow main loop (Eg. While busy with serial comms) leaves the time domain path predicting further ahead
+static void test_injection_angle_slow_loop(void)
+{
+  static const engineProfile profile = { "1500-7500rpm, 4ms loop", 1500.0, 12000.0, 500000UL, 4000UL };
+  compareInjection(profile);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  nativeSetVirtualClock(0);
+  lastTimerCounter = NATIVE_TIMER_COUNTER;
+
+  RUN_TEST(test_injection_angle_steady);
+  RUN_TEST(test_injection_angle_acceleration);
+  RUN_TEST(test_injection_angle_deceleration);
+  RUN_TEST(test_injection_angle_slow_loop);
+
+  UNITY_END();
+
+  return 0;
+}
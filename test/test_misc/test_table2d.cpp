@@ -21,16 +21,15 @@ static int16_t table2d_axis_s16[TEST_TABLE2D_SIZE] = {
     123, 2539, 5531, 7537, 11329, 16363, 21323, 26357, 32029,
 };
 
-static table2D table2d_u8_u8;
-static table2D table2d_u8_s16;
-static table2D table2d_s16_u8;
-static table2D table2d_s16_s16;
+// Named <value type>_<axis type>
+static table2D<uint8_t, uint8_t> table2d_u8_u8;
+static table2D<int16_t, uint8_t> table2d_u8_s16;
+static table2D<uint8_t, int16_t> table2d_s16_u8;
+static table2D<int16_t, int16_t> table2d_s16_s16;
 
 template <typename dataT, typename axisT>
-void setup_test_subject(table2D &table, dataT *data, axisT *axis)
+void setup_test_subject(table2D<axisT, dataT> &table, dataT *data, axisT *axis)
 {
-    table.valueSize = sizeof(dataT)*CHAR_BIT;
-    table.axisSize = sizeof(axisT)*CHAR_BIT;
     table.xSize = TEST_TABLE2D_SIZE;
     table.values = data;
     table.axisX = axis;
@@ -145,6 +144,26 @@ void test_table2d_all_decrementing(void)
 }
 
 
+void test_table2d_cacheInvalidation(void)
+{
+    setup_test_subjects();
+
+    uint8_t input = table2d_axis_u8[3]+((table2d_axis_u8[4]-table2d_axis_u8[3])/2);
+    uint8_t original = table2d_data_u8[4];
+    TEST_ASSERT_EQUAL(table2D_getValue(&table2d_u8_u8, input), table2D_getValue(&table2d_u8_u8, input));
+
+    // Simulate a tune change: the cache stays valid until it is invalidated
+    table2d_data_u8[4] = original-10U;
+    uint8_t cachedResult = table2D_getValue(&table2d_u8_u8, input);
+    table2D_invalidateAllCaches();
+    uint8_t newResult = table2D_getValue(&table2d_u8_u8, input);
+    TEST_ASSERT_EQUAL(cachedResult-5U, newResult);
+
+    table2d_data_u8[4] = original;
+    table2D_invalidateCache(&table2d_u8_u8);
+    TEST_ASSERT_EQUAL(cachedResult, table2D_getValue(&table2d_u8_u8, input));
+}
+
 void testTable2d()
 {
     RUN_TEST(test_table2dLookup_50pct);
@@ -152,4 +171,5 @@ void testTable2d()
     RUN_TEST(test_table2dLookup_overMax);
     RUN_TEST(test_table2dLookup_underMin);
     RUN_TEST(test_table2d_all_decrementing); 
+    RUN_TEST(test_table2d_cacheInvalidation);
 }
\ No newline at end of file
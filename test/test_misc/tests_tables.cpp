@@ -89,6 +89,7 @@ void setup_TestTable(void)
       ++itY;
     }
   }
+  invalidate_axis_cache(&testTable.get_value_cache);
 
   {
     table_value_iterator itZ = testTable.values.begin();
@@ -121,6 +122,12 @@ void testTables()
   RUN_TEST(test_tableLookup_underMinX);
   RUN_TEST(test_tableLookup_underMinY);
   RUN_TEST(test_tableLookup_roundUp);
+  RUN_TEST(test_tableLookup_binSearch);
+  RUN_TEST(test_tableLookup_sharedContext);
+  RUN_TEST(test_tableLookup_binReciprocals);
+  RUN_TEST(test_tableLookup_largeTables);
+  RUN_TEST(test_tableValueAt_largeTables);
+  RUN_TEST(test_tableLookup_16bitValues);
   //RUN_TEST(test_all_incrementing);
   
 }
@@ -215,6 +222,208 @@ void test_tableLookup_roundUp(void)
   TEST_ASSERT_EQUAL(testTable.get_value_cache.lastYBinMax, (table3d_dim_t)14);
 }
 
+void test_tableLookup_binSearch(void)
+{
+  // Tests that every bin is found when neither the cached bin nor its neighbours match,
+  // which is the path taken on large transients
+  setup_TestTable();
+
+  for (table3d_dim_t bin = 1; bin < _countof(tempXAxis); ++bin)
+  {
+    // Axes are stored in reverse, so the upper bin index counts down from the top of the axis
+    table3d_dim_t expectedBin = (table3d_dim_t)(_countof(tempXAxis) - 1U - bin);
+    // Force a search by starting from a bin at the other end of the axis
+    testTable.get_value_cache.lastXBinMax = expectedBin < 8U ? 14U : 1U;
+    testTable.get_value_cache.lastYBinMax = expectedBin < 8U ? 14U : 1U;
+    invalidate_cache(&testTable.get_value_cache);
+
+    get3DTableValue(&testTable, tempYAxis[bin]-1, tempXAxis[bin]-1);
+    TEST_ASSERT_EQUAL(expectedBin, testTable.get_value_cache.lastXBinMax);
+    TEST_ASSERT_EQUAL(expectedBin, testTable.get_value_cache.lastYBinMax);
+  }
+}
+
+void test_tableLookup_sharedContext(void)
+{
+  // Tests that a table with the same axes as the context source table interpolates
+  // from the context, and that any difference falls back to a regular lookup
+  setup_TestTable();
+  static table3d16RpmLoad sharedTable;
+  sharedTable = testTable;
+  invalidate_axis_cache(&sharedTable.get_value_cache);
+
+  table3DLookupContext context;
+  resolve3DTableLookup(&context, &testTable, 53, 2250);
+  TEST_ASSERT_EQUAL(69, get3DTableValue(&sharedTable, &context, 53, 2250));
+  TEST_ASSERT_TRUE(sharedTable.get_value_cache.sharedAxes);
+  TEST_ASSERT_EQUAL((table3d_dim_t)9, sharedTable.get_value_cache.lastXBinMax);
+  TEST_ASSERT_EQUAL((table3d_dim_t)8, sharedTable.get_value_cache.lastYBinMax);
+
+  // A different load to the one the context was resolved for
+  TEST_ASSERT_EQUAL(get3DTableValue(&testTable, 60, 2250), get3DTableValue(&sharedTable, &context, 60, 2250));
+
+  // Different axes
+  sharedTable.axisX.axis[0] = sharedTable.axisX.axis[0] + 1;
+  invalidate_axis_cache(&sharedTable.get_value_cache);
+  TEST_ASSERT_EQUAL(69, get3DTableValue(&sharedTable, &context, 53, 2250));
+  TEST_ASSERT_FALSE(sharedTable.get_value_cache.sharedAxes);
+}
+
+// A lookup with no cached state, to check a cached one against
+static table3d_value_t uncachedLookup(const table3d16RpmLoad &table, table3d_axis_t y, table3d_axis_t x)
+{
+  static table3d16RpmLoad fresh;
+  fresh = table;
+  fresh.get_value_cache = table3DGetValueCache();
+  return get3DTableValue(&fresh, y, x);
+}
+
+void test_tableLookup_binReciprocals(void)
+{
+  // Tests that the cached bin width reciprocals follow the bin, axis changes
+  // and the bins set by a context
+  setup_TestTable();
+
+  // Moving between bins and within a bin
+  static const table3d_axis_t xs[] = { 2250, 2300, 2600, 2650, 6900, 530, 560 };
+  for (uint8_t i = 0; i < _countof(xs); ++i)
+  {
+    TEST_ASSERT_EQUAL(uncachedLookup(testTable, 53, xs[i]), get3DTableValue(&testTable, 53, xs[i]));
+  }
+
+  // The same bin (500-700), but the axis changed its width
+  TEST_ASSERT_EQUAL((table3d_dim_t)14, testTable.get_value_cache.lastXBinMax);
+  testTable.axisX.axis[14] = 850;
+  invalidate_axis_cache(&testTable.get_value_cache);
+  TEST_ASSERT_EQUAL(uncachedLookup(testTable, 53, 560), get3DTableValue(&testTable, 53, 560));
+  TEST_ASSERT_EQUAL((table3d_dim_t)14, testTable.get_value_cache.lastXBinMax);
+
+  // The bins are set by a context, then used by a regular lookup in the same bin
+  static table3d16RpmLoad sharedTable;
+  sharedTable = testTable;
+  invalidate_axis_cache(&sharedTable.get_value_cache);
+  get3DTableValue(&sharedTable, 20, 6900);
+  table3DLookupContext context;
+  resolve3DTableLookup(&context, &testTable, 53, 2250);
+  get3DTableValue(&sharedTable, &context, 53, 2250);
+  TEST_ASSERT_EQUAL(uncachedLookup(sharedTable, 55, 2400), get3DTableValue(&sharedTable, 55, 2400));
+}
+
+// Fills a table with a plane: value = (2 * column) + (3 * row), on evenly spaced axes.
+// Interpolating a plane is exact (apart from rounding), so any position can be checked.
+template <typename table_t>
+static void setup_PlaneTable(table_t &table)
+{
+  table3d_axis_t axisValue = 500;
+  for (table_axis_iterator itX = table.axisX.begin(); !itX.at_end(); ++itX)
+  {
+    *itX = axisValue;
+    axisValue = axisValue + 200;
+  }
+  axisValue = 10;
+  for (table_axis_iterator itY = table.axisY.begin(); !itY.at_end(); ++itY)
+  {
+    *itY = axisValue;
+    axisValue = axisValue + 6;
+  }
+  invalidate_axis_cache(&table.get_value_cache);
+
+  uint8_t row = 0;
+  for (table_value_iterator itZ = table.values.begin(); !itZ.at_end(); ++itZ)
+  {
+    uint8_t column = 0;
+    for (table_row_iterator itRow = *itZ; !itRow.at_end(); ++itRow)
+    {
+      *itRow = (table3d_value_t)((2U * column) + (3U * row));
+      ++column;
+    }
+    ++row;
+  }
+}
+
+template <typename table_t>
+static void test_PlaneTableLookup(table_t &table)
+{
+  setup_PlaneTable(table);
+  const table3d_dim_t xSize = table_t::xaxis_t::length;
+  const table3d_dim_t ySize = table_t::yaxis_t::length;
+
+  for (table3d_dim_t row = 0; row < ySize-1U; ++row)
+  {
+    for (table3d_dim_t column = 0; column < xSize-1U; ++column)
+    {
+      // Exactly on a cell
+      table3d_axis_t x = 500 + (column * 200);
+      table3d_axis_t y = 10 + (row * 6);
+      TEST_ASSERT_EQUAL((2U * column) + (3U * row), get3DTableValue(&table, y, x));
+      // Midway between 4 cells
+      TEST_ASSERT_INT_WITHIN(1, (2U * column) + (3U * row) + 2U, get3DTableValue(&table, y+3, x+100));
+    }
+  }
+  // Clamped to the top right corner
+  TEST_ASSERT_EQUAL((2U * (xSize-1U)) + (3U * (ySize-1U)), get3DTableValue(&table, 1000, 30000));
+}
+
+void test_tableLookup_largeTables(void)
+{
+  // Tests lookups on rectangular tables and tables with more than 256 values
+  static table3d24x16RpmLoad table24x16;
+  test_PlaneTableLookup(table24x16);
+  static table3d32RpmLoad table32;
+  test_PlaneTableLookup(table32);
+}
+
+template <typename table_t>
+static void test_PlaneTableValueAt(table_t &table)
+{
+  setup_PlaneTable(table);
+  const table3d_dim_t xSize = table_t::xaxis_t::length;
+
+  // The linear index is row major from the bottom left, as TS addresses the values
+  for (uint16_t index = 0; index < sizeof(table.values.values); ++index)
+  {
+    TEST_ASSERT_EQUAL((2U * (index % xSize)) + (3U * (index / xSize)), table.values.value_at(index));
+  }
+}
+
+void test_tableValueAt_largeTables(void)
+{
+  // Tests the page offset to value mapping on rectangular tables and tables with more than 256 values
+  static table3d24x16RpmLoad table24x16;
+  test_PlaneTableValueAt(table24x16);
+  static table3d32RpmLoad table32;
+  test_PlaneTableValueAt(table32);
+}
+
+void test_tableLookup_16bitValues(void)
+{
+  // Tests lookups & paging byte access on a table of 16-bit values
+  static table3d16_u16RpmLoad table;
+  setup_PlaneTable(table);
+  // Scale the plane up so the values need 16-bits
+  const table3d_value16_t scale = 250U;
+  for (uint16_t index = 0; index < 16U*16U; ++index)
+  {
+    table.values.value_at(index) = scale * ((2U * (index % 16U)) + (3U * (index / 16U)));
+  }
+
+  for (table3d_dim_t row = 0; row < 15U; ++row)
+  {
+    for (table3d_dim_t column = 0; column < 15U; ++column)
+    {
+      table3d_axis_t x = 500 + (column * 200);
+      table3d_axis_t y = 10 + (row * 6);
+      TEST_ASSERT_EQUAL(scale * ((2U * column) + (3U * row)), get3DTableValue(&table, y, x));
+      // Midway between 4 cells
+      TEST_ASSERT_INT_WITHIN(1, (scale * ((2U * column) + (3U * row))) + (scale * 5U / 2U), get3DTableValue(&table, y+3, x+100));
+    }
+  }
+
+  // Each value is 2 bytes in the page, little endian
+  TEST_ASSERT_EQUAL(table.values.value_at(17) & 0xFFU, table.values.value_byte_at(34));
+  TEST_ASSERT_EQUAL(table.values.value_at(17) >> 8U, table.values.value_byte_at(35));
+}
+
 void test_all_incrementing(void)
 {
   //Test the when going up both the load and RPM axis that the returned value is always equal or higher to the previous one
@@ -8,4 +8,10 @@ void test_tableLookup_overMaxY(void);
 void test_tableLookup_underMinX(void);
 void test_tableLookup_underMinY(void);
 void test_tableLookup_roundUp(void);
+void test_tableLookup_binSearch(void);
+void test_tableLookup_sharedContext(void);
+void test_tableLookup_binReciprocals(void);
+void test_tableLookup_largeTables(void);
+void test_tableValueAt_largeTables(void);
+void test_tableLookup_16bitValues(void);
 void test_all_incrementing(void);
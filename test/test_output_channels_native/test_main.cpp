@@ -0,0 +1,495 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "output_channels.cpp"
+#include "logger.h"
+#include "../test_perf_native/perf_timer.h"
+
+/*
+Checks the realtime data block (See output_channels.h) against the per byte switch that it replaced, which is kept
+here as the reference, and compares the time each takes to serve a poll.
+*/
+
+struct statuses currentStatus;
+#if defined(ISR_STATS)
+struct isrStatsLogValues isrStatsLog;
+#endif
+volatile uint32_t perf_sink;
+static byte errorValue;
+
+byte getNextError(void) { return errorValue; }
+uint16_t freeRam(void) { return 0x1234; }
+
+//The getTSLogEntry() switch before the realtime data block
+static byte referenceLogEntry(uint16_t byteNum)
+{
+  byte statusValue = 0;
+
+  switch(byteNum)
+  {
+    case 0: statusValue = currentStatus.secl; break; //secl is simply a counter that increments each second. Used to track unexpected resets (Which will reset this count to 0)
+    case 1: statusValue = currentStatus.status1; break; //status1 Bitfield
+    case 2: statusValue = currentStatus.engine; break; //Engine Status Bitfield
+    case 3: statusValue = currentStatus.syncLossCounter; break;
+    case 4: statusValue = lowByte(currentStatus.MAP); break; //2 bytes for MAP
+    case 5: statusValue = highByte(currentStatus.MAP); break;
+    case 6: statusValue = (byte)(currentStatus.IAT + CALIBRATION_TEMPERATURE_OFFSET); break; //mat
+    case 7: statusValue = (byte)(currentStatus.coolant + CALIBRATION_TEMPERATURE_OFFSET); break; //Coolant ADC
+    case 8: statusValue = currentStatus.batCorrection; break; //Battery voltage correction (%)
+    case 9: statusValue = currentStatus.battery10; break; //battery voltage
+    case 10: statusValue = currentStatus.O2; break; //O2
+    case 11: statusValue = currentStatus.egoCorrection; break; //Exhaust gas correction (%)
+    case 12: statusValue = currentStatus.iatCorrection; break; //Air temperature Correction (%)
+    case 13: statusValue = currentStatus.wueCorrection; break; //Warmup enrichment (%)
+    case 14: statusValue = lowByte(currentStatus.RPM); break; //rpm HB
+    case 15: statusValue = highByte(currentStatus.RPM); break; //rpm LB
+    case 16: statusValue = (byte)(currentStatus.AEamount >> 1); break; //TPS acceleration enrichment (%) divided by 2 (Can exceed 255)
+    case 17: statusValue = lowByte(currentStatus.corrections); break; //Total GammaE (%)
+    case 18: statusValue = highByte(currentStatus.corrections); break; //Total GammaE (%)
+    case 19: statusValue = currentStatus.VE1; break; //VE 1 (%)
+    case 20: statusValue = currentStatus.VE2; break; //VE 2 (%)
+    case 21: statusValue = currentStatus.afrTarget; break;
+    case 22: statusValue = lowByte(currentStatus.tpsDOT); break; //TPS DOT
+    case 23: statusValue = highByte(currentStatus.tpsDOT); break; //TPS DOT
+    case 24: statusValue = currentStatus.advance; break;
+    case 25: statusValue = currentStatus.TPS; break; // TPS (0% to 100%)
+    
+    case 26: 
+      if(currentStatus.loopsPerSecond > 60000) { currentStatus.loopsPerSecond = 60000;}
+      statusValue = lowByte(currentStatus.loopsPerSecond); 
+      break;
+    case 27: 
+      if(currentStatus.loopsPerSecond > 60000) { currentStatus.loopsPerSecond = 60000;}
+      statusValue = highByte(currentStatus.loopsPerSecond); 
+      break;
+    
+    case 28: 
+      currentStatus.freeRAM = freeRam();
+      statusValue = lowByte(currentStatus.freeRAM); //(byte)((currentStatus.loopsPerSecond >> 8) & 0xFF);
+      break; 
+    case 29: 
+      currentStatus.freeRAM = freeRam();
+      statusValue = highByte(currentStatus.freeRAM); 
+      break;
+
+    case 30: statusValue = (byte)(currentStatus.boostTarget >> 1); break; //Divide boost target by 2 to fit in a byte
+    case 31: statusValue = (byte)(currentStatus.boostDuty / 100); break;
+    case 32: statusValue = currentStatus.spark; break; //Spark related bitfield
+
+    //rpmDOT must be sent as a signed integer
+    case 33: statusValue = lowByte(currentStatus.rpmDOT); break;
+    case 34: statusValue = highByte(currentStatus.rpmDOT); break;
+
+    case 35: statusValue = currentStatus.ethanolPct; break; //Flex sensor value (or 0 if not used)
+    case 36: statusValue = currentStatus.flexCorrection; break; //Flex fuel correction (% above or below 100)
+    case 37: statusValue = currentStatus.flexIgnCorrection; break; //Ignition correction (Increased degrees of advance) for flex fuel
+
+    case 38: statusValue = currentStatus.idleLoad; break;
+    case 39: statusValue = currentStatus.testOutputs; break;
+
+    case 40: statusValue = currentStatus.O2_2; break; //O2
+    case 41: statusValue = currentStatus.baro; break; //Barometer value
+
+    case 42: statusValue = lowByte(currentStatus.canin[0]); break;
+    case 43: statusValue = highByte(currentStatus.canin[0]); break;
+    case 44: statusValue = lowByte(currentStatus.canin[1]); break;
+    case 45: statusValue = highByte(currentStatus.canin[1]); break;
+    case 46: statusValue = lowByte(currentStatus.canin[2]); break;
+    case 47: statusValue = highByte(currentStatus.canin[2]); break;
+    case 48: statusValue = lowByte(currentStatus.canin[3]); break;
+    case 49: statusValue = highByte(currentStatus.canin[3]); break;
+    case 50: statusValue = lowByte(currentStatus.canin[4]); break;
+    case 51: statusValue = highByte(currentStatus.canin[4]); break;
+    case 52: statusValue = lowByte(currentStatus.canin[5]); break;
+    case 53: statusValue = highByte(currentStatus.canin[5]); break;
+    case 54: statusValue = lowByte(currentStatus.canin[6]); break;
+    case 55: statusValue = highByte(currentStatus.canin[6]); break;
+    case 56: statusValue = lowByte(currentStatus.canin[7]); break;
+    case 57: statusValue = highByte(currentStatus.canin[7]); break;
+    case 58: statusValue = lowByte(currentStatus.canin[8]); break;
+    case 59: statusValue = highByte(currentStatus.canin[8]); break;
+    case 60: statusValue = lowByte(currentStatus.canin[9]); break;
+    case 61: statusValue = highByte(currentStatus.canin[9]); break;
+    case 62: statusValue = lowByte(currentStatus.canin[10]); break;
+    case 63: statusValue = highByte(currentStatus.canin[10]); break;
+    case 64: statusValue = lowByte(currentStatus.canin[11]); break;
+    case 65: statusValue = highByte(currentStatus.canin[11]); break;
+    case 66: statusValue = lowByte(currentStatus.canin[12]); break;
+    case 67: statusValue = highByte(currentStatus.canin[12]); break;
+    case 68: statusValue = lowByte(currentStatus.canin[13]); break;
+    case 69: statusValue = highByte(currentStatus.canin[13]); break;
+    case 70: statusValue = lowByte(currentStatus.canin[14]); break;
+    case 71: statusValue = highByte(currentStatus.canin[14]); break;
+    case 72: statusValue = lowByte(currentStatus.canin[15]); break;
+    case 73: statusValue = highByte(currentStatus.canin[15]); break;
+
+    case 74: statusValue = currentStatus.tpsADC; break;
+    case 75: statusValue = getNextError(); break;
+
+    case 76: statusValue = lowByte(currentStatus.PW1); break; //Pulsewidth 1 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 77: statusValue = highByte(currentStatus.PW1); break; //Pulsewidth 1 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 78: statusValue = lowByte(currentStatus.PW2); break; //Pulsewidth 2 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 79: statusValue = highByte(currentStatus.PW2); break; //Pulsewidth 2 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 80: statusValue = lowByte(currentStatus.PW3); break; //Pulsewidth 3 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 81: statusValue = highByte(currentStatus.PW3); break; //Pulsewidth 3 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 82: statusValue = lowByte(currentStatus.PW4); break; //Pulsewidth 4 multiplied by 10 in ms. Have to convert from uS to mS.
+    case 83: statusValue = highByte(currentStatus.PW4); break; //Pulsewidth 4 multiplied by 10 in ms. Have to convert from uS to mS.
+
+    case 84: statusValue = currentStatus.status3; break;
+    case 85: statusValue = currentStatus.engineProtectStatus; break;
+    case 86: statusValue = lowByte(currentStatus.fuelLoad); break;
+    case 87: statusValue = highByte(currentStatus.fuelLoad); break;
+    case 88: statusValue = lowByte(currentStatus.ignLoad); break;
+    case 89: statusValue = highByte(currentStatus.ignLoad); break;
+    case 90: statusValue = lowByte(currentStatus.dwell); break;
+    case 91: statusValue = highByte(currentStatus.dwell); break;
+    case 92: statusValue = currentStatus.CLIdleTarget; break;
+    case 93: statusValue = lowByte(currentStatus.mapDOT); break;
+    case 94: statusValue = highByte(currentStatus.mapDOT); break;
+    case 95: statusValue = lowByte(currentStatus.vvt1Angle); break; //2 bytes for vvt1Angle
+    case 96: statusValue = highByte(currentStatus.vvt1Angle); break;
+    case 97: statusValue = currentStatus.vvt1TargetAngle; break;
+    case 98: statusValue = (byte)(currentStatus.vvt1Duty); break;
+    case 99: statusValue = lowByte(currentStatus.flexBoostCorrection); break;
+    case 100: statusValue = highByte(currentStatus.flexBoostCorrection); break;
+    case 101: statusValue = currentStatus.baroCorrection; break;
+    case 102: statusValue = currentStatus.VE; break; //Current VE (%). Can be equal to VE1 or VE2 or a calculated value from both of them
+    case 103: statusValue = currentStatus.ASEValue; break; //Current ASE (%)
+    case 104: statusValue = lowByte(currentStatus.vss); break;
+    case 105: statusValue = highByte(currentStatus.vss); break;
+    case 106: statusValue = currentStatus.gear; break;
+    case 107: statusValue = currentStatus.fuelPressure; break;
+    case 108: statusValue = currentStatus.oilPressure; break;
+    case 109: statusValue = currentStatus.wmiPW; break;
+    case 110: statusValue = currentStatus.status4; break;
+    case 111: statusValue = lowByte(currentStatus.vvt2Angle); break; //2 bytes for vvt2Angle
+    case 112: statusValue = highByte(currentStatus.vvt2Angle); break;
+    case 113: statusValue = currentStatus.vvt2TargetAngle; break;
+    case 114: statusValue = (byte)(currentStatus.vvt2Duty); break;
+    case 115: statusValue = currentStatus.outputsStatus; break;
+    case 116: statusValue = (byte)(currentStatus.fuelTemp + CALIBRATION_TEMPERATURE_OFFSET); break; //Fuel temperature from flex sensor
+    case 117: statusValue = currentStatus.fuelTempCorrection; break; //Fuel temperature Correction (%)
+    case 118: statusValue = currentStatus.advance1; break; //advance 1 (%)
+    case 119: statusValue = currentStatus.advance2; break; //advance 2 (%)
+    case 120: statusValue = currentStatus.TS_SD_Status; break; //SD card status
+    case 121: statusValue = lowByte(currentStatus.EMAP); break; //2 bytes for EMAP
+    case 122: statusValue = highByte(currentStatus.EMAP); break;
+    case 123: statusValue = currentStatus.fanDuty; break;
+    case 124: statusValue = currentStatus.airConStatus; break;
+    //ISR execution times (0.1uS) and load. These are 0 unless the firmware is compiled with ISR_STATS
+#if defined(ISR_STATS)
+    case 125: statusValue = lowByte(isrStatsLog.triggerMean); break; //2 bytes for each ISR time
+    case 126: statusValue = highByte(isrStatsLog.triggerMean); break;
+    case 127: statusValue = lowByte(isrStatsLog.triggerMax); break;
+    case 128: statusValue = highByte(isrStatsLog.triggerMax); break;
+    case 129: statusValue = lowByte(isrStatsLog.fuelMean); break;
+    case 130: statusValue = highByte(isrStatsLog.fuelMean); break;
+    case 131: statusValue = lowByte(isrStatsLog.fuelMax); break;
+    case 132: statusValue = highByte(isrStatsLog.fuelMax); break;
+    case 133: statusValue = lowByte(isrStatsLog.ignitionMean); break;
+    case 134: statusValue = highByte(isrStatsLog.ignitionMean); break;
+    case 135: statusValue = lowByte(isrStatsLog.ignitionMax); break;
+    case 136: statusValue = highByte(isrStatsLog.ignitionMax); break;
+    case 137: statusValue = lowByte(isrStatsLog.oneMSMean); break;
+    case 138: statusValue = highByte(isrStatsLog.oneMSMean); break;
+    case 139: statusValue = lowByte(isrStatsLog.oneMSMax); break;
+    case 140: statusValue = highByte(isrStatsLog.oneMSMax); break;
+    case 141: statusValue = isrStatsLog.load; break;
+#endif
+  }
+
+  return statusValue;
+}
+
+static uint32_t randomValue(void)
+{
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+//Fills every field that is sent with random values
+static void randomiseStatus(void)
+{
+  currentStatus.secl = randomValue();
+  currentStatus.status1 = randomValue();
+  currentStatus.engine = randomValue();
+  currentStatus.syncLossCounter = randomValue();
+  currentStatus.MAP = randomValue() % 1000U;
+  currentStatus.IAT = (int)(randomValue() % 200U) - 40;
+  currentStatus.coolant = (int)(randomValue() % 200U) - 40;
+  currentStatus.batCorrection = randomValue();
+  currentStatus.battery10 = randomValue();
+  currentStatus.O2 = randomValue();
+  currentStatus.egoCorrection = randomValue();
+  currentStatus.iatCorrection = randomValue();
+  currentStatus.wueCorrection = randomValue();
+  currentStatus.RPM = randomValue();
+  currentStatus.AEamount = randomValue();
+  currentStatus.corrections = randomValue();
+  currentStatus.VE1 = randomValue();
+  currentStatus.VE2 = randomValue();
+  currentStatus.afrTarget = randomValue();
+  currentStatus.tpsDOT = randomValue();
+  currentStatus.advance = randomValue();
+  currentStatus.TPS = randomValue();
+  currentStatus.loopsPerSecond = randomValue() % 70000U;
+  currentStatus.boostTarget = randomValue();
+  currentStatus.boostDuty = randomValue() % 10001U;
+  currentStatus.spark = randomValue();
+  currentStatus.rpmDOT = (int16_t)randomValue();
+  currentStatus.ethanolPct = randomValue();
+  currentStatus.flexCorrection = randomValue();
+  currentStatus.flexIgnCorrection = randomValue();
+  currentStatus.idleLoad = randomValue();
+  currentStatus.testOutputs = randomValue();
+  currentStatus.O2_2 = randomValue();
+  currentStatus.baro = randomValue();
+  for (uint8_t x = 0; x < 16U; x++) { currentStatus.canin[x] = randomValue(); }
+  currentStatus.tpsADC = randomValue();
+  errorValue = randomValue();
+  currentStatus.PW1 = randomValue() % 65536U;
+  currentStatus.PW2 = randomValue() % 65536U;
+  currentStatus.PW3 = randomValue() % 65536U;
+  currentStatus.PW4 = randomValue() % 65536U;
+  currentStatus.status3 = randomValue();
+  currentStatus.engineProtectStatus = randomValue();
+  currentStatus.fuelLoad = randomValue();
+  currentStatus.ignLoad = randomValue();
+  currentStatus.dwell = (int16_t)randomValue();
+  currentStatus.CLIdleTarget = randomValue();
+  currentStatus.mapDOT = randomValue();
+  currentStatus.vvt1Angle = randomValue();
+  currentStatus.vvt1TargetAngle = randomValue();
+  currentStatus.vvt1Duty = randomValue() % 256U;
+  currentStatus.flexBoostCorrection = randomValue();
+  currentStatus.baroCorrection = randomValue();
+  currentStatus.VE = randomValue();
+  currentStatus.ASEValue = randomValue();
+  currentStatus.vss = randomValue();
+  currentStatus.gear = randomValue();
+  currentStatus.fuelPressure = randomValue();
+  currentStatus.oilPressure = randomValue();
+  currentStatus.wmiPW = randomValue();
+  currentStatus.status4 = randomValue();
+  currentStatus.vvt2Angle = randomValue();
+  currentStatus.vvt2TargetAngle = randomValue();
+  currentStatus.vvt2Duty = randomValue() % 256U;
+  currentStatus.outputsStatus = randomValue();
+  currentStatus.fuelTemp = (int8_t)((int)(randomValue() % 160U) - 40);
+  currentStatus.fuelTempCorrection = randomValue();
+  currentStatus.advance1 = randomValue();
+  currentStatus.advance2 = randomValue();
+  currentStatus.TS_SD_Status = randomValue();
+  currentStatus.EMAP = randomValue();
+  currentStatus.fanDuty = randomValue();
+  currentStatus.airConStatus = randomValue();
+#if defined(ISR_STATS)
+  isrStatsLog.triggerMean = randomValue();
+  isrStatsLog.triggerMax = randomValue();
+  isrStatsLog.fuelMean = randomValue();
+  isrStatsLog.fuelMax = randomValue();
+  isrStatsLog.ignitionMean = randomValue();
+  isrStatsLog.ignitionMax = randomValue();
+  isrStatsLog.oneMSMean = randomValue();
+  isrStatsLog.oneMSMax = randomValue();
+  isrStatsLog.load = randomValue();
+#endif
+}
+
+static void test_outputChannels_layout(void)
+{
+  //Spot checks against the byte numbers of the ini file
+  TEST_ASSERT_EQUAL_UINT(4, offsetof(outputChannelBlock, MAP));
+  TEST_ASSERT_EQUAL_UINT(14, offsetof(outputChannelBlock, RPM));
+  TEST_ASSERT_EQUAL_UINT(42, offsetof(outputChannelBlock, canin));
+  TEST_ASSERT_EQUAL_UINT(76, offsetof(outputChannelBlock, PW1));
+  TEST_ASSERT_EQUAL_UINT(124, offsetof(outputChannelBlock, airConStatus));
+#if defined(ISR_STATS)
+  TEST_ASSERT_EQUAL_UINT(141, offsetof(outputChannelBlock, isrLoad));
+  TEST_ASSERT_EQUAL_UINT(142, sizeof(outputChannelBlock));
+#else
+  TEST_ASSERT_EQUAL_UINT(125, sizeof(outputChannelBlock)); //The ISR execution times are only sent when they are compiled in
+#endif
+
+  //The 2 byte fields are exactly those listed in fsIntIndex (Which is in order)
+  uint8_t wordFields = 0;
+  for (uint8_t field = 0; field < OUTPUT_CHANNEL_FIELD_COUNT; field++)
+  {
+    if (outputChannelFields[field].size == 2U)
+    {
+      TEST_ASSERT_TRUE(wordFields < sizeof(fsIntIndex));
+      TEST_ASSERT_EQUAL_UINT(outputChannelFields[field].offset, pgm_read_byte(&fsIntIndex[wordFields]));
+      wordFields++;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT(sizeof(fsIntIndex), wordFields);
+}
+
+static void test_outputChannels_matchReference(void)
+{
+  srand(1);
+  for (uint16_t run = 0; run < 1000U; run++)
+  {
+    randomiseStatus();
+    updateOutputChannels();
+    const byte *pBlock = (const byte *)&outputChannels;
+    for (uint16_t byteNum = 0; byteNum < sizeof(outputChannels); byteNum++)
+    {
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE(referenceLogEntry(byteNum), pBlock[byteNum], "Byte differs from the reference");
+    }
+  }
+  TEST_ASSERT_TRUE(currentStatus.loopsPerSecond <= 60000U);
+}
+
+//As generateLiveValues() (comms.cpp), before and after the realtime data block
+static byte payload[sizeof(outputChannelBlock) + 1U];
+
+static void pollReference(uint16_t offset, uint16_t length)
+{
+  for (uint16_t x = 0; x < length; x++) { payload[x + 1U] = referenceLogEntry(offset + x); }
+}
+
+static void pollBlock(uint16_t offset, uint16_t length)
+{
+  updateOutputChannels();
+  memcpy(&payload[1], (const byte *)&outputChannels + offset, length);
+}
+
+static uint64_t timePolls(void (*pPoll)(uint16_t, uint16_t), uint16_t offset, uint16_t length)
+{
+  static constexpr uint32_t POLLS = 20000U;
+  uint64_t best = UINT64_MAX;
+  for (uint8_t repeat = 0; repeat < PERF_REPEATS; repeat++)
+  {
+    uint64_t start = perf_now_ns();
+    for (uint32_t poll = 0; poll < POLLS; poll++)
+    {
+      currentStatus.RPM = (uint16_t)poll; //Something changes between polls
+      pPoll(offset, length);
+      perf_sink = perf_sink + payload[1U + (poll % length)];
+    }
+    uint64_t time = perf_now_ns() - start;
+    if (time < best) { best = time; }
+  }
+  return best / POLLS;
+}
+
+static void test_outputChannels_pollTime(void)
+{
+  srand(1);
+  randomiseStatus();
+  //The full block ('A' command) and the part of it that a typical ini requests at once ('r' command)
+  static const uint16_t lengths[] = { sizeof(outputChannelBlock), 32 };
+  for (uint8_t x = 0; x < (sizeof(lengths) / sizeof(lengths[0])); x++)
+  {
+    uint64_t reference = timePolls(pollReference, 0, lengths[x]);
+    uint64_t block = timePolls(pollBlock, 0, lengths[x]);
+    char message[128];
+    snprintf(message, sizeof(message), "%3u byte poll: per byte switch %5lu ns, refresh + copy %5lu ns (%.1fx)", lengths[x], (unsigned long)reference, (unsigned long)block, (double)reference / (double)block);
+    TEST_MESSAGE(message);
+  }
+  //Only the full block is required to be faster. A short poll still refreshes the whole block
+  TEST_ASSERT_TRUE(timePolls(pollBlock, 0, sizeof(outputChannelBlock)) < timePolls(pollReference, 0, sizeof(outputChannelBlock)));
+}
+
+//Applies a delta frame (See output_channels.h) to the receiver's copy of the block. Returns the length of the frame
+static uint16_t applyDelta(const uint8_t *pFrame, outputChannelBlock &block)
+{
+  uint8_t *pBlock = (uint8_t *)&block;
+  uint16_t length = OUTPUT_CHANNEL_BITMAP_SIZE;
+  for (uint8_t field = 0; field < OUTPUT_CHANNEL_FIELD_COUNT; field++)
+  {
+    if ((pFrame[field >> 3] & (1U << (field & 7U))) != 0U)
+    {
+      memcpy(&pBlock[outputChannelFields[field].offset], &pFrame[length], outputChannelFields[field].size);
+      length += outputChannelFields[field].size;
+    }
+  }
+  return length;
+}
+
+static void test_outputChannels_deltaRoundTrip(void)
+{
+  static uint8_t frame[OUTPUT_CHANNEL_DELTA_MAX_SIZE];
+  outputChannelBlock current;
+  outputChannelBlock previous;
+  outputChannelBlock received;
+  memset(&received, 0xAA, sizeof(received));
+
+  srand(1);
+  uint8_t *pCurrent = (uint8_t *)&current;
+  for (uint16_t x = 0; x < sizeof(current); x++) { pCurrent[x] = (uint8_t)rand(); }
+
+  //The first frame has every field
+  uint16_t length = encodeOutputChannelsDelta(current, previous, true, frame);
+  TEST_ASSERT_EQUAL_UINT(OUTPUT_CHANNEL_DELTA_MAX_SIZE, length);
+  TEST_ASSERT_EQUAL_UINT(length, applyDelta(frame, received));
+  TEST_ASSERT_EQUAL_MEMORY(&current, &received, sizeof(current));
+
+  //Then only the bytes that change, a field at a time
+  for (uint16_t run = 0; run < 2000U; run++)
+  {
+    uint8_t changes = (uint8_t)(rand() % 8);
+    uint16_t changedBytes = 0; //At most. A byte changed twice may end up unchanged
+    for (uint8_t change = 0; change < changes; change++)
+    {
+      uint8_t field = (uint8_t)(rand() % OUTPUT_CHANNEL_FIELD_COUNT);
+      uint8_t byte = outputChannelFields[field].offset + (uint8_t)(rand() % outputChannelFields[field].size);
+      pCurrent[byte] ^= (uint8_t)(1U + (rand() % 255));
+      changedBytes++;
+    }
+    length = encodeOutputChannelsDelta(current, previous, false, frame);
+    TEST_ASSERT_EQUAL_UINT(length, applyDelta(frame, received));
+    TEST_ASSERT_EQUAL_MEMORY(&current, &received, sizeof(current));
+    TEST_ASSERT_EQUAL_MEMORY(&current, &previous, sizeof(current));
+    TEST_ASSERT_TRUE(length <= (OUTPUT_CHANNEL_BITMAP_SIZE + (2U * changedBytes)));
+  }
+
+  //Nothing changed
+  TEST_ASSERT_EQUAL_UINT(OUTPUT_CHANNEL_BITMAP_SIZE, encodeOutputChannelsDelta(current, previous, false, frame));
+}
+
+static void test_outputChannels_deltaSize(void)
+{
+  //A running engine at a steady state: The fields that change from one poll to the next
+  static uint8_t frame[OUTPUT_CHANNEL_DELTA_MAX_SIZE];
+  outputChannelBlock previous;
+  srand(1);
+  randomiseStatus();
+  updateOutputChannels();
+  encodeOutputChannelsDelta(outputChannels, previous, true, frame);
+
+  uint32_t totalLength = 0;
+  static constexpr uint16_t FRAMES = 100U;
+  for (uint16_t poll = 0; poll < FRAMES; poll++)
+  {
+    currentStatus.RPM = (uint16_t)(3000U + (poll & 7U));
+    currentStatus.MAP = (long)(95U + (poll & 3U));
+    currentStatus.PW1 = 4000U + (poll & 15U);
+    currentStatus.O2 = (byte)(147U + (poll & 1U));
+    currentStatus.dwell = (uint16_t)(3000U + (poll & 3U));
+    currentStatus.loopsPerSecond = 2000U + poll;
+    if ((poll % 20U) == 0U) { currentStatus.secl++; }
+    updateOutputChannels();
+    totalLength += encodeOutputChannelsDelta(outputChannels, previous, false, frame);
+  }
+  uint32_t meanLength = (totalLength / FRAMES) + 1U; //Plus the return code
+  char message[128];
+  snprintf(message, sizeof(message), "Steady running poll: full block %u bytes, delta frame %lu bytes (%.1fx fewer)",
+           (unsigned)(sizeof(outputChannelBlock) + 1U), (unsigned long)meanLength, (double)(sizeof(outputChannelBlock) + 1U) / (double)meanLength);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_TRUE((meanLength * 4U) < sizeof(outputChannelBlock));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_outputChannels_layout);
+  RUN_TEST(test_outputChannels_matchReference);
+  RUN_TEST(test_outputChannels_pollTime);
+  RUN_TEST(test_outputChannels_deltaRoundTrip);
+  RUN_TEST(test_outputChannels_deltaSize);
+
+  UNITY_END();
+
+  return 0;
+}
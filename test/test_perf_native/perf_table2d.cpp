@@ -0,0 +1,128 @@
+#include <unity.h>
+#include <stdio.h>
+#include "table2d.h"
+#include "perf_timer.h"
+#include "perf_table2d.h"
+
+#define _countof(x) (sizeof(x) / sizeof (x[0]))
+
+// A warm up enrichment curve: coolant temperature (+40 offset) vs % fuel
+static uint8_t wueBins[] = { 0, 11, 22, 33, 44, 55, 66, 77, 88, 99 };
+static uint8_t wueValues[] = { 180, 175, 168, 154, 134, 121, 112, 104, 102, 100 };
+// An injector timing curve: RPM/100 vs end of injection angle
+static uint8_t injAngleBins[] = { 5, 25, 45, 65 };
+static uint16_t injAngleValues[] = { 355, 380, 410, 440 };
+// A coolant sensor calibration: ADC vs temperature (+40 offset)
+static uint16_t cltCalBins[32];
+static uint16_t cltCalValues[32];
+
+static table2D_u8_u8 wueTable;
+static table2D_u8_u16 injAngleTable;
+static table2D_u16_u16 cltCalTable;
+
+template <typename axisT, typename valueT>
+static void setup_table(table2D<axisT, valueT> &table, axisT *pAxis, valueT *pValues, uint8_t size)
+{
+  table.xSize = size;
+  table.values = pValues;
+  table.axisX = pAxis;
+}
+
+static void setup_tables(void)
+{
+  for (uint8_t i=0; i<32U; ++i)
+  {
+    cltCalBins[i] = (uint16_t)(i * 33U);
+    cltCalValues[i] = (uint16_t)(250U - ((i * i) / 5U));
+  }
+  setup_table(wueTable, wueBins, wueValues, _countof(wueBins));
+  setup_table(injAngleTable, injAngleBins, injAngleValues, _countof(injAngleBins));
+  setup_table(cltCalTable, cltCalBins, cltCalValues, _countof(cltCalBins));
+}
+
+// Straightforward linear scan & interpolation, to check the table lookup against
+template <typename axisT, typename valueT>
+static int reference_lookup(const axisT *pAxis, const valueT *pValues, uint8_t size, int X)
+{
+  if (X >= pAxis[size-1U]) { return pValues[size-1U]; }
+  if (X <= pAxis[0]) { return pValues[0]; }
+  uint8_t x = 1;
+  while (X > pAxis[x]) { ++x; }
+  if (X == pAxis[x]) { return pValues[x]; }
+  int16_t m = X - pAxis[x-1U];
+  int16_t n = pAxis[x] - pAxis[x-1U];
+  int16_t yMax = pValues[x];
+  int16_t yMin = pValues[x-1U];
+  return yMin + (int16_t)((((int32_t) m) * (yMax-yMin)) / n);
+}
+
+// Inputs that wander over the whole axis, so the lookups are a realistic mix of 
+// same bin, neighbouring bin & distant bin hits. Consecutive inputs always differ,
+// so the last value cache never hits.
+static constexpr uint32_t INPUT_COUNT = 20000U;
+static int inputs[INPUT_COUNT];
+
+static void make_inputs(int min, int max)
+{
+  uint32_t state = 0x2468ACE1U;
+  int value = (min + max) / 2;
+  for (uint32_t i=0; i<INPUT_COUNT; ++i)
+  {
+    state = (state * 1103515245U) + 12345U;
+    int step = (int)((state >> 16) % 7U) - 3;
+    if ((i % 1000U) == 0U) { step = (int)((state >> 16) % (uint32_t)(max - min)) - (value - min); } // Occasional jump
+    if (step == 0) { step = 1; }
+    value = value + step;
+    if (value < min) { value = min + 1; }
+    if (value > max) { value = max - 1; }
+    if ((i > 0U) && (value == inputs[i-1U])) { value = (value < max - 1) ? value + 1 : value - 1; }
+    inputs[i] = value;
+  }
+}
+
+template <typename axisT, typename valueT>
+static void run_table(const char *name, table2D<axisT, valueT> &table, const axisT *pAxis, const valueT *pValues, uint8_t size, int min, int max)
+{
+  make_inputs(min, max);
+
+  for (uint32_t i=0; i<INPUT_COUNT; ++i)
+  {
+    TEST_ASSERT_EQUAL(reference_lookup(pAxis, pValues, size, inputs[i]), table2D_getValue(&table, inputs[i]));
+  }
+
+  uint64_t bestNs = UINT64_MAX;
+  uint64_t bestCycles = UINT64_MAX;
+  for (uint8_t repeat=0; repeat<PERF_REPEATS; ++repeat)
+  {
+    uint32_t sum = 0;
+    uint64_t startNs = perf_now_ns();
+    uint64_t startCycles = perf_now_cycles();
+    for (uint32_t i=0; i<INPUT_COUNT; ++i)
+    {
+      sum += table2D_getValue(&table, inputs[i]);
+    }
+    uint64_t elapsedCycles = perf_now_cycles() - startCycles;
+    uint64_t elapsedNs = perf_now_ns() - startNs;
+    perf_sink = sum;
+    if (elapsedNs < bestNs) { bestNs = elapsedNs; }
+    if (elapsedCycles < bestCycles) { bestCycles = elapsedCycles; }
+  }
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "table2D_getValue %-14s %2u bins %8u lookups %7.2f ns/lookup %7.2f cycles/lookup", 
+          name, size, INPUT_COUNT, (double)bestNs / INPUT_COUNT, (double)bestCycles / INPUT_COUNT);
+  TEST_MESSAGE(msg);
+}
+
+static void perf_table2d_lookups(void)
+{
+  setup_tables();
+  run_table("u8 axis/u8",   wueTable,      wueBins,      wueValues,      _countof(wueBins),      0, 110);
+  run_table("u8 axis/u16",  injAngleTable, injAngleBins, injAngleValues, _countof(injAngleBins), 0, 75);
+  run_table("u16 axis/u16", cltCalTable,   cltCalBins,   cltCalValues,   _countof(cltCalBins),   0, 1050);
+}
+
+void perfTable2d(void)
+{
+  RUN_TEST(perf_table2d_lookups);
+}
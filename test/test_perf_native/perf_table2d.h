@@ -0,0 +1,3 @@
+#pragma once
+
+void perfTable2d(void);
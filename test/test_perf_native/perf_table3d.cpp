@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "perf_table3d.h"
+#include "perf_trajectory.h"
+#include "perf_timer.h"
+#include "table3d.h"
+
+static const table3d_axis_t rpmAxis[] = { 500, 700, 900, 1200, 1600, 2000, 2500, 3100, 3500, 4100, 4700, 5300, 5900, 6500, 6750, 7000 };
+static const table3d_axis_t loadAxis[] = { 16, 26, 30, 36, 40, 46, 50, 56, 60, 66, 70, 76, 86, 90, 96, 100 };
+
+static table3d16RpmLoad perfTable;
+
+static void setup_perf_table(void)
+{
+  // Axes are filled from smallest to largest via the iterators, which take care of the
+  // reversed storage order
+  {
+    table_axis_iterator itX = perfTable.axisX.begin();
+    const table3d_axis_t *pValue = rpmAxis;
+    while (!itX.at_end()) { *itX = *pValue; ++pValue; ++itX; }
+  }
+  {
+    table_axis_iterator itY = perfTable.axisY.begin();
+    const table3d_axis_t *pValue = loadAxis;
+    while (!itY.at_end()) { *itY = *pValue; ++pValue; ++itY; }
+  }
+  // A VE like surface: rises with load, peaks in the mid range. No two neighbours are
+  // equal, so the interpolation is always performed.
+  {
+    table_value_iterator itRow = perfTable.values.begin();
+    uint8_t row = 0;
+    while (!itRow.at_end())
+    {
+      table_row_iterator itCol = *itRow;
+      uint8_t col = 0;
+      while (!itCol.at_end())
+      {
+        *itCol = (table3d_value_t)(30U + (row * 5U) + (col < 10U ? col * 3U : (20U - col) * 3U) + ((row+col) % 2U));
+        ++itCol;
+        ++col;
+      }
+      ++itRow;
+      ++row;
+    }
+  }
+  invalidate_axis_cache(&perfTable.get_value_cache);
+}
+
+// How find_bin_max() will resolve a lookup. Mirrors the order of checks in
+// get3DTableValue()/find_bin_max()
+enum lookup_class_t { lookup_value_hit, lookup_bin_hit, lookup_bin_miss };
+
+static bool needs_search(table3d_axis_t value, const table3d_axis_t *pAxis, table3d_dim_t lastBin, table3d_dim_t newBin)
+{
+  // Axes are stored largest first
+  const table3d_axis_t axisMax = pAxis[0];
+  const table3d_axis_t axisMin = pAxis[15];
+  if ( (newBin+1U >= lastBin) && (newBin <= lastBin+1U) ) { return false; } // Same or adjacent bin
+  return (value < axisMax) && (value > axisMin); // Clamping doesn't search
+}
+
+static lookup_class_t classify(const table3DGetValueCache &before, const table3DGetValueCache &after, const perf_sample_t &sample)
+{
+  if ( (sample.rpm==before.last_lookup.x) && (sample.load==before.last_lookup.y) ) { return lookup_value_hit; }
+  if ( needs_search(sample.rpm, perfTable.axisX.axis, before.lastXBinMax, after.lastXBinMax) 
+    || needs_search(sample.load, perfTable.axisY.axis, before.lastYBinMax, after.lastYBinMax) )
+  {
+    return lookup_bin_miss;
+  }
+  return lookup_bin_hit;
+}
+
+struct perf_result_t
+{
+  uint32_t counts[3]; // Indexed by lookup_class_t
+  double nsPerLookup;
+};
+
+static perf_result_t run_trajectory(const perf_trajectory_t &trajectory)
+{
+  perf_result_t result = { { 0, 0, 0 }, 0.0 };
+
+  // Classify each lookup & check the cached lookup gives the same result as an uncached one
+  setup_perf_table();
+  table3DGetValueCache reference;
+  for (uint32_t i=0; i<trajectory.length; ++i)
+  {
+    const perf_sample_t &sample = trajectory.pSamples[i];
+    table3DGetValueCache before = perfTable.get_value_cache;
+    int value = get3DTableValue(&perfTable, sample.load, sample.rpm);
+    ++result.counts[classify(before, perfTable.get_value_cache, sample)];
+
+    reference = table3DGetValueCache();
+    int expected = get3DTableValue(&reference, 16, 16, perfTable.values.values, perfTable.axisX.axis, perfTable.axisY.axis, sample.load, sample.rpm);
+    TEST_ASSERT_EQUAL(expected, value);
+  }
+
+  // Time the trajectory
+  uint64_t best = UINT64_MAX;
+  for (uint8_t repeat=0; repeat<PERF_REPEATS; ++repeat)
+  {
+    invalidate_cache(&perfTable.get_value_cache);
+    uint32_t sum = 0;
+    uint64_t start = perf_now_ns();
+    for (uint32_t i=0; i<trajectory.length; ++i)
+    {
+      sum += get3DTableValue(&perfTable, trajectory.pSamples[i].load, trajectory.pSamples[i].rpm);
+    }
+    uint64_t elapsed = perf_now_ns() - start;
+    perf_sink = sum;
+    if (elapsed < best) { best = elapsed; }
+  }
+  result.nsPerLookup = (double)best / trajectory.length;
+
+  return result;
+}
+
+static void report(const char *name, const perf_result_t &result, uint32_t length)
+{
+  char msg[160];
+  snprintf(msg, sizeof(msg), "get3DTableValue %-10s %8u lookups %7.2f ns/lookup | value hit %5.1f%% bin hit %5.1f%% bin miss %5.1f%%",
+          name, length, result.nsPerLookup,
+          100.0 * result.counts[lookup_value_hit] / length,
+          100.0 * result.counts[lookup_bin_hit] / length,
+          100.0 * result.counts[lookup_bin_miss] / length);
+  TEST_MESSAGE(msg);
+}
+
+static void perf_table3d_trajectories(void)
+{
+  perf_trajectory_t trajectories[] = {
+    perf_trajectory_cruise(),
+    perf_trajectory_wot_ramp(),
+    perf_trajectory_blips(),
+    perf_trajectory_recorded(),
+  };
+  for (const perf_trajectory_t &trajectory : trajectories)
+  {
+    if (trajectory.length==0U) { continue; }
+    report(trajectory.name, run_trajectory(trajectory), trajectory.length);
+  }
+}
+
+// The cost of the bin search is the difference between a trajectory that always
+// misses the bin cache and one that always hits it (but never hits the value cache)
+static void perf_table3d_miss_path(void)
+{
+  static perf_sample_t sameBin[10000];
+  for (uint32_t i=0; i<10000U; ++i)
+  {
+    sameBin[i] = (i % 2U)==0U ? perf_sample_t{ 2600, 52 } : perf_sample_t{ 2900, 54 };
+  }
+  const perf_trajectory_t hitTrajectory = { "bin_hit", sameBin, 10000U };
+  const perf_trajectory_t missTrajectory = perf_trajectory_worst_case();
+
+  perf_result_t hit = run_trajectory(hitTrajectory);
+  perf_result_t miss = run_trajectory(missTrajectory);
+  // Allow for the first lookup, which is from a cold cache
+  TEST_ASSERT_GREATER_OR_EQUAL(hitTrajectory.length-1U, hit.counts[lookup_bin_hit]);
+  TEST_ASSERT_GREATER_OR_EQUAL(missTrajectory.length-1U, miss.counts[lookup_bin_miss]);
+  report(hitTrajectory.name, hit, hitTrajectory.length);
+  report(missTrajectory.name, miss, missTrajectory.length);
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "get3DTableValue bin search miss path: %.2f ns/lookup", miss.nsPerLookup - hit.nsPerLookup);
+  TEST_MESSAGE(msg);
+}
+
+// The same surface as perfTable, at 100x the resolution
+static table3d16_u16RpmLoad perfTable16;
+
+static void setup_perf_table16(void)
+{
+  setup_perf_table();
+  memcpy(perfTable16.axisX.axis, perfTable.axisX.axis, sizeof(perfTable16.axisX.axis));
+  memcpy(perfTable16.axisY.axis, perfTable.axisY.axis, sizeof(perfTable16.axisY.axis));
+  for (uint16_t index = 0; index < 16U*16U; ++index)
+  {
+    perfTable16.values.value_at(index) = perfTable.values.value_at(index) * 100U;
+  }
+  invalidate_axis_cache(&perfTable16.get_value_cache);
+}
+
+template <typename table_t>
+static uint64_t time_trajectory_once(table_t &table, const perf_trajectory_t &trajectory)
+{
+  invalidate_cache(&table.get_value_cache);
+  uint32_t sum = 0;
+  uint64_t start = perf_now_ns();
+  for (uint32_t i=0; i<trajectory.length; ++i)
+  {
+    sum += get3DTableValue(&table, trajectory.pSamples[i].load, trajectory.pSamples[i].rpm);
+  }
+  uint64_t elapsed = perf_now_ns() - start;
+  perf_sink = sum;
+  return elapsed;
+}
+
+// Compares the cost of a 16-bit value table lookup to an 8-bit one
+static void perf_table3d_value16(void)
+{
+  perf_trajectory_t trajectories[] = {
+    perf_trajectory_cruise(),
+    perf_trajectory_wot_ramp(),
+    perf_trajectory_blips(),
+    perf_trajectory_worst_case(),
+    perf_trajectory_recorded(),
+  };
+  setup_perf_table16();
+  for (const perf_trajectory_t &trajectory : trajectories)
+  {
+    if (trajectory.length==0U) { continue; }
+
+    // The extra resolution means the results differ by up to the 8-bit rounding
+    for (uint32_t i=0; i<trajectory.length; ++i)
+    {
+      const perf_sample_t &sample = trajectory.pSamples[i];
+      TEST_ASSERT_INT_WITHIN(100, get3DTableValue(&perfTable, sample.load, sample.rpm) * 100, get3DTableValue(&perfTable16, sample.load, sample.rpm));
+    }
+
+    // Alternate between the tables, so that any host noise affects both equally
+    uint64_t best8 = UINT64_MAX;
+    uint64_t best16 = UINT64_MAX;
+    for (uint8_t repeat=0; repeat<PERF_REPEATS*3U; ++repeat)
+    {
+      uint64_t elapsed = time_trajectory_once(perfTable, trajectory);
+      if (elapsed < best8) { best8 = elapsed; }
+      elapsed = time_trajectory_once(perfTable16, trajectory);
+      if (elapsed < best16) { best16 = elapsed; }
+    }
+    double ns8 = (double)best8 / trajectory.length;
+    double ns16 = (double)best16 / trajectory.length;
+    char msg[128];
+    snprintf(msg, sizeof(msg), "get3DTableValue %-10s 8-bit %7.2f ns/lookup 16-bit %7.2f ns/lookup (%+.1f%%)",
+            trajectory.name, ns8, ns16, 100.0 * (ns16 - ns8) / ns8);
+    TEST_MESSAGE(msg);
+  }
+}
+
+void perfTable3d(void)
+{
+  RUN_TEST(perf_table3d_trajectories);
+  RUN_TEST(perf_table3d_miss_path);
+  RUN_TEST(perf_table3d_value16);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Number of times each timed run is repeated. The fastest run is reported, as it has
+// the least interference from the host OS
+static constexpr uint8_t PERF_REPEATS = 7U;
+
+static inline uint64_t perf_now_ns(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Host CPU cycles. On x86 this is the time stamp counter, which counts at a fixed 
+// rate close to the nominal clock. Elsewhere it falls back to nanoseconds.
+static inline uint64_t perf_now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return perf_now_ns();
+#endif
+}
+
+// Prevents the compiler optimising away the benchmarked calls
+extern volatile uint32_t perf_sink;
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "perf_trajectory.h"
+
+// A small deterministic PRNG, so every run sees identical trajectories
+static uint32_t noise_state = 0x12345678U;
+static int16_t noise(int16_t amplitude)
+{
+    noise_state = (noise_state * 1103515245U) + 12345U;
+    int32_t value = (int32_t)((noise_state >> 16) % (uint32_t)(amplitude*2 + 1));
+    return (int16_t)(value - amplitude);
+}
+
+static perf_trajectory_t make_trajectory(const char *name, const std::vector<perf_sample_t> &samples)
+{
+    // Trajectories live for the duration of the test run
+    perf_sample_t *pSamples = new perf_sample_t[samples.size()];
+    for (uint32_t i=0; i<samples.size(); ++i) { pSamples[i] = samples[i]; }
+    return { name, pSamples, (uint32_t)samples.size() };
+}
+
+// Steady highway cruise: small RPM & MAP noise around a fixed point
+perf_trajectory_t perf_trajectory_cruise(void)
+{
+    std::vector<perf_sample_t> samples;
+    for (uint32_t i=0; i<10U*PERF_SAMPLE_RATE_HZ; ++i)
+    {
+        samples.push_back({ (int16_t)(2500 + noise(15)), (int16_t)(45 + noise(1)) });
+    }
+    return make_trajectory("cruise", samples);
+}
+
+// Full throttle acceleration through the gears: RPM ramps, MAP pinned at WOT, with a shift dip between gears
+perf_trajectory_t perf_trajectory_wot_ramp(void)
+{
+    std::vector<perf_sample_t> samples;
+    for (uint8_t gear=0; gear<4U; ++gear)
+    {
+        const uint32_t ramp_ms = 1500U + (gear * 1000U);
+        for (uint32_t i=0; i<ramp_ms; ++i)
+        {
+            int16_t rpm = (int16_t)(3000 + ((6800 - 3000) * i) / ramp_ms);
+            samples.push_back({ (int16_t)(rpm + noise(10)), (int16_t)(98 + noise(1)) });
+        }
+        // Gear change: throttle closed, RPM drops
+        for (uint32_t i=0; i<200U; ++i)
+        {
+            int16_t rpm = (int16_t)(6800 - ((6800 - 3000) * i) / 200U);
+            samples.push_back({ rpm, (int16_t)(30 + noise(2)) });
+        }
+    }
+    return make_trajectory("wot_ramp", samples);
+}
+
+// Throttle blips from idle: RPM & MAP jump across many bins within a few loops
+perf_trajectory_t perf_trajectory_blips(void)
+{
+    std::vector<perf_sample_t> samples;
+    for (uint8_t blip=0; blip<20U; ++blip)
+    {
+        for (uint32_t i=0; i<300U; ++i) { samples.push_back({ (int16_t)(850 + noise(20)), (int16_t)(32 + noise(2)) }); }
+        // MAP snaps up, RPM follows
+        for (uint32_t i=0; i<150U; ++i)
+        {
+            int16_t rpm = (int16_t)(850 + ((4500 - 850) * i) / 150U);
+            samples.push_back({ rpm, (int16_t)(95 + noise(2)) });
+        }
+        // Throttle snaps shut, RPM falls back
+        for (uint32_t i=0; i<250U; ++i)
+        {
+            int16_t rpm = (int16_t)(4500 - ((4500 - 850) * i) / 250U);
+            samples.push_back({ rpm, (int16_t)(20 + noise(2)) });
+        }
+    }
+    return make_trajectory("blips", samples);
+}
+
+perf_trajectory_t perf_trajectory_worst_case(void)
+{
+    std::vector<perf_sample_t> samples;
+    for (uint32_t i=0; i<10000U; ++i)
+    {
+        if ((i % 2U)==0U) { samples.push_back({ (int16_t)(600 + noise(50)), (int16_t)(20 + noise(2)) }); }
+        else { samples.push_back({ (int16_t)(6600 + noise(50)), (int16_t)(93 + noise(2)) }); }
+    }
+    return make_trajectory("worst_case", samples);
+}
+
+perf_trajectory_t perf_trajectory_recorded(void)
+{
+    std::vector<perf_sample_t> samples;
+    const char *path = getenv("SPEEDUINO_TRAJECTORY");
+    FILE *pFile = path!=nullptr ? fopen(path, "r") : nullptr;
+    if (pFile!=nullptr)
+    {
+        int rpm, load;
+        char line[128];
+        while (fgets(line, sizeof(line), pFile)!=nullptr)
+        {
+            if (sscanf(line, "%d,%d", &rpm, &load)==2) { samples.push_back({ (int16_t)rpm, (int16_t)load }); }
+        }
+        fclose(pFile);
+    }
+    return make_trajectory("recorded", samples);
+}
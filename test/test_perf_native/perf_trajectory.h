@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+
+/** @brief One sample of engine operating point, as seen by the main loop */
+struct perf_sample_t
+{
+    int16_t rpm;
+    int16_t load;
+};
+
+/** @brief A sequence of operating points, sampled at a fixed rate (PERF_SAMPLE_RATE_HZ) */
+struct perf_trajectory_t
+{
+    const char *name;
+    const perf_sample_t *pSamples;
+    uint32_t length;
+};
+
+static constexpr uint16_t PERF_SAMPLE_RATE_HZ = 1000U;
+
+// Synthetic trajectories
+perf_trajectory_t perf_trajectory_cruise(void);
+perf_trajectory_t perf_trajectory_wot_ramp(void);
+perf_trajectory_t perf_trajectory_blips(void);
+// Alternates between opposite corners of the table: every lookup misses the bin cache
+perf_trajectory_t perf_trajectory_worst_case(void);
+
+// Recorded trajectory. Loaded from the CSV file (rpm,load per line) named by the 
+// SPEEDUINO_TRAJECTORY environment variable. Length is 0 if the variable isn't set.
+perf_trajectory_t perf_trajectory_recorded(void);
@@ -0,0 +1,24 @@
+#include <unity.h>
+#include "table3d_interpolate.cpp"
+typedef uint8_t byte;
+#include "table2d.ino"
+#include "perf_timer.h"
+#include "perf_table3d.h"
+#include "perf_table2d.h"
+
+volatile uint32_t perf_sink;
+
+// Benchmarks for the hot paths in the firmware. Each benchmark also checks its results,
+// so an optimisation that changes behaviour fails here.
+//
+// Timings are for the host CPU, so only compare numbers from the same machine.
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  perfTable3d();
+  perfTable2d();
+
+  UNITY_END();
+
+  return 0;
+}
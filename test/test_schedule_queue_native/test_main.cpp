@@ -0,0 +1,148 @@
+#include <unity.h>
+#include "schedule_queue.h"
+
+static scheduleQueue<uint16_t> queue;
+
+static void resetQueue(void)
+{
+  scheduleQueue_clear(&queue);
+}
+
+static void test_scheduleQueue_empty(void)
+{
+  resetQueue();
+  uint16_t startCompare = 1234;
+  unsigned long duration = 5678;
+
+  TEST_ASSERT_TRUE(scheduleQueue_isEmpty(&queue));
+  TEST_ASSERT_EQUAL(0, scheduleQueue_count(&queue));
+  TEST_ASSERT_FALSE(scheduleQueue_pop(&queue, &startCompare, &duration));
+  //Output is untouched if there is no event
+  TEST_ASSERT_EQUAL(1234, startCompare);
+  TEST_ASSERT_EQUAL(5678, duration);
+}
+
+static void test_scheduleQueue_ordering(void)
+{
+  resetQueue();
+  for (uint8_t i = 0; i < SCHEDULE_QUEUE_SIZE; i++)
+  {
+    TEST_ASSERT_TRUE(scheduleQueue_push(&queue, (uint16_t)(1000U + i), 100UL * i));
+  }
+  TEST_ASSERT_EQUAL(SCHEDULE_QUEUE_SIZE, scheduleQueue_count(&queue));
+
+  //Events come out in the order they were added
+  uint16_t startCompare;
+  unsigned long duration;
+  for (uint8_t i = 0; i < SCHEDULE_QUEUE_SIZE; i++)
+  {
+    TEST_ASSERT_TRUE(scheduleQueue_pop(&queue, &startCompare, &duration));
+    TEST_ASSERT_EQUAL(1000U + i, startCompare);
+    TEST_ASSERT_EQUAL(100UL * i, duration);
+  }
+  TEST_ASSERT_TRUE(scheduleQueue_isEmpty(&queue));
+}
+
+static void test_scheduleQueue_overflow(void)
+{
+  resetQueue();
+  for (uint8_t i = 0; i < SCHEDULE_QUEUE_SIZE; i++)
+  {
+    TEST_ASSERT_TRUE(scheduleQueue_push(&queue, (uint16_t)(2000U + i), 10UL + i));
+  }
+
+  //The queue is full: new events are dropped & the queued events are untouched
+  TEST_ASSERT_FALSE(scheduleQueue_push(&queue, 9999U, 9999UL));
+  TEST_ASSERT_FALSE(scheduleQueue_push(&queue, 8888U, 8888UL));
+  TEST_ASSERT_EQUAL(SCHEDULE_QUEUE_SIZE, scheduleQueue_count(&queue));
+
+  uint16_t startCompare;
+  unsigned long duration;
+  TEST_ASSERT_TRUE(scheduleQueue_pop(&queue, &startCompare, &duration));
+  TEST_ASSERT_EQUAL(2000U, startCompare);
+
+  //Popping an event makes room for exactly one more, which goes to the back
+  TEST_ASSERT_TRUE(scheduleQueue_push(&queue, 3000U, 30UL));
+  TEST_ASSERT_FALSE(scheduleQueue_push(&queue, 9999U, 9999UL));
+
+  for (uint8_t i = 1; i < SCHEDULE_QUEUE_SIZE; i++)
+  {
+    TEST_ASSERT_TRUE(scheduleQueue_pop(&queue, &startCompare, &duration));
+    TEST_ASSERT_EQUAL(2000U + i, startCompare);
+    TEST_ASSERT_EQUAL(10UL + i, duration);
+  }
+  TEST_ASSERT_TRUE(scheduleQueue_pop(&queue, &startCompare, &duration));
+  TEST_ASSERT_EQUAL(3000U, startCompare);
+  TEST_ASSERT_EQUAL(30UL, duration);
+  TEST_ASSERT_FALSE(scheduleQueue_pop(&queue, &startCompare, &duration));
+}
+
+static void test_scheduleQueue_indexWrap(void)
+{
+  resetQueue();
+  //Run the free running 8-bit indices through several wraps, with the queue at varying fill levels
+  uint16_t nextIn = 0;
+  uint16_t nextOut = 0;
+  uint16_t startCompare;
+  unsigned long duration;
+  for (uint16_t loop = 0; loop < 1000U; loop++)
+  {
+    uint8_t pushes = (uint8_t)(1U + (loop % SCHEDULE_QUEUE_SIZE));
+    for (uint8_t i = 0; i < pushes; i++)
+    {
+      if (scheduleQueue_push(&queue, nextIn, (unsigned long)nextIn * 3UL)) { ++nextIn; }
+    }
+    TEST_ASSERT_TRUE(scheduleQueue_count(&queue) <= SCHEDULE_QUEUE_SIZE);
+    uint8_t pops = (uint8_t)(1U + ((loop * 7U) % SCHEDULE_QUEUE_SIZE));
+    for (uint8_t i = 0; i < pops; i++)
+    {
+      if (scheduleQueue_pop(&queue, &startCompare, &duration))
+      {
+        TEST_ASSERT_EQUAL(nextOut, startCompare);
+        TEST_ASSERT_EQUAL((unsigned long)nextOut * 3UL, duration);
+        ++nextOut;
+      }
+    }
+  }
+  while (scheduleQueue_pop(&queue, &startCompare, &duration))
+  {
+    TEST_ASSERT_EQUAL(nextOut, startCompare);
+    ++nextOut;
+  }
+  TEST_ASSERT_EQUAL(nextIn, nextOut);
+  TEST_ASSERT_TRUE(nextIn > 512U);
+}
+
+static void test_scheduleQueue_clear(void)
+{
+  resetQueue();
+  scheduleQueue_push(&queue, 1U, 1UL);
+  scheduleQueue_push(&queue, 2U, 2UL);
+  scheduleQueue_clear(&queue);
+  TEST_ASSERT_TRUE(scheduleQueue_isEmpty(&queue));
+
+  //The queue is fully usable after a clear
+  for (uint8_t i = 0; i < SCHEDULE_QUEUE_SIZE; i++)
+  {
+    TEST_ASSERT_TRUE(scheduleQueue_push(&queue, (uint16_t)(10U + i), 1UL));
+  }
+  TEST_ASSERT_FALSE(scheduleQueue_push(&queue, 99U, 1UL));
+  uint16_t startCompare;
+  unsigned long duration;
+  TEST_ASSERT_TRUE(scheduleQueue_pop(&queue, &startCompare, &duration));
+  TEST_ASSERT_EQUAL(10U, startCompare);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_scheduleQueue_empty);
+  RUN_TEST(test_scheduleQueue_ordering);
+  RUN_TEST(test_scheduleQueue_overflow);
+  RUN_TEST(test_scheduleQueue_indexWrap);
+  RUN_TEST(test_scheduleQueue_clear);
+
+  UNITY_END();
+
+  return 0;
+}
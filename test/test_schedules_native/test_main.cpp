@@ -0,0 +1,422 @@
+#include <stdio.h>
+#include <unity.h>
+#include "src/NativeArduino/NativeArduino.cpp"
+#include "table2d.ino"
+#include "scheduler.ino"
+#include "utilities.h"
+
+/*
+Runs the schedulers against the native board's compare unit model (See board_native.h), driven by a
+virtual clock. The clock steps from one compare match to the next, so every ISR runs at exactly the
+time its hardware counterpart would and a sweep of thousands of schedules takes well under a second.
+The error of each scheduler state transition is recorded across the sweep and the worst case reported.
+*/
+
+// The firmware state used by scheduler.ino
+struct statuses currentStatus;
+struct config4 configPage4;
+table2D_u8_u8 PrimingPulseTable;
+byte channelInjEnabled;
+volatile uint16_t ignitionCount;
+int CRANK_ANGLE_MAX_INJ = 720;
+volatile uint16_t timePerDegreex16;
+native_compare_t nativeTimers[NATIVE_TIMER_COUNT];
+
+//Only the schedule compare units are simulated. Must be in the same order as native_timer_t
+static void (* const scheduleISRs[NATIVE_TIMER_COUNT])(void) = {
+  fuelSchedule1Interrupt, fuelSchedule2Interrupt, fuelSchedule3Interrupt, fuelSchedule4Interrupt,
+  fuelSchedule5Interrupt, fuelSchedule6Interrupt, fuelSchedule7Interrupt, fuelSchedule8Interrupt,
+  ignitionSchedule1Interrupt, ignitionSchedule2Interrupt, ignitionSchedule3Interrupt, ignitionSchedule4Interrupt,
+  ignitionSchedule5Interrupt, ignitionSchedule6Interrupt, ignitionSchedule7Interrupt, ignitionSchedule8Interrupt,
+  nullptr, nullptr, nullptr, nullptr,
+};
+static COUNTER_TYPE lastTimerCounter;
+
+void nativeServiceInterrupts(void)
+{
+  static bool inInterrupt = false;
+  if ( (nativeInterruptsEnabled == false) || (inInterrupt == true) ) { return; }
+  inInterrupt = true;
+
+  COUNTER_TYPE counter = NATIVE_TIMER_COUNTER;
+  if (counter != lastTimerCounter)
+  {
+    nativeServiceCompareUnits(lastTimerCounter, counter, scheduleISRs);
+    lastTimerCounter = counter;
+  }
+
+  inInterrupt = false;
+}
+
+// Moves the virtual clock to the given time, stopping at every compare match on the way
+static void runUntil(uint32_t until)
+{
+  uint32_t now = micros();
+  while ((int32_t)(until - now) > 0)
+  {
+    uint32_t ticks = nativeTicksToNextCompare(lastTimerCounter, scheduleISRs);
+    //The counter is lastTimerCounter from the start of the current 4uS tick
+    uint32_t next = (now & ~3UL) + (ticks * 4UL);
+    if ( (ticks == 0U) || ((int32_t)(next - until) > 0) ) { next = until; }
+    nativeSetVirtualClock(next);
+    now = next;
+  }
+}
+
+// Callback timestamps, per channel
+static uint32_t startTimes[SCHEDULE_CHANNELS];
+static uint32_t endTimes[SCHEDULE_CHANNELS];
+static uint8_t startCount[SCHEDULE_CHANNELS];
+static uint8_t endCount[SCHEDULE_CHANNELS];
+
+template <uint8_t channel> static void recordStart(void) { startTimes[channel] = micros(); ++startCount[channel]; }
+template <uint8_t channel> static void recordEnd(void) { endTimes[channel] = micros(); ++endCount[channel]; }
+
+static void (* const startCallbacks[SCHEDULE_CHANNELS])(void) = {
+  recordStart<0>, recordStart<1>, recordStart<2>, recordStart<3>, recordStart<4>, recordStart<5>, recordStart<6>, recordStart<7>,
+};
+static void (* const endCallbacks[SCHEDULE_CHANNELS])(void) = {
+  recordEnd<0>, recordEnd<1>, recordEnd<2>, recordEnd<3>, recordEnd<4>, recordEnd<5>, recordEnd<6>, recordEnd<7>,
+};
+
+static void (* const setFuelSchedules[SCHEDULE_CHANNELS])(unsigned long, unsigned long) = {
+  setFuelSchedule1, setFuelSchedule2, setFuelSchedule3, setFuelSchedule4, setFuelSchedule5, setFuelSchedule6, setFuelSchedule7, setFuelSchedule8,
+};
+static void (* const setIgnitionSchedules[SCHEDULE_CHANNELS])(void (*)(), unsigned long, unsigned long, void(*)()) = {
+  setIgnitionSchedule1, setIgnitionSchedule2, setIgnitionSchedule3, setIgnitionSchedule4, setIgnitionSchedule5, setIgnitionSchedule6, setIgnitionSchedule7, setIgnitionSchedule8,
+};
+
+static void resetSchedulers(void)
+{
+  initialiseSchedulers();
+  inj1StartFunction = startCallbacks[0]; inj1EndFunction = endCallbacks[0];
+  inj2StartFunction = startCallbacks[1]; inj2EndFunction = endCallbacks[1];
+  inj3StartFunction = startCallbacks[2]; inj3EndFunction = endCallbacks[2];
+  inj4StartFunction = startCallbacks[3]; inj4EndFunction = endCallbacks[3];
+  inj5StartFunction = startCallbacks[4]; inj5EndFunction = endCallbacks[4];
+  inj6StartFunction = startCallbacks[5]; inj6EndFunction = endCallbacks[5];
+  inj7StartFunction = startCallbacks[6]; inj7EndFunction = endCallbacks[6];
+  inj8StartFunction = startCallbacks[7]; inj8EndFunction = endCallbacks[7];
+}
+
+// The range of errors (Actual - requested, in uS) seen for one state transition
+struct transitionError {
+  const char *name;
+  int32_t min;
+  int32_t max;
+  uint32_t count;
+};
+
+static void recordError(transitionError &error, int32_t value)
+{
+  if ( (error.count == 0U) || (value < error.min) ) { error.min = value; }
+  if ( (error.count == 0U) || (value > error.max) ) { error.max = value; }
+  ++error.count;
+}
+
+static void reportError(const char *schedule, const transitionError &error)
+{
+  char message[128];
+  snprintf(message, sizeof(message), "%s %-18s %6lu events, error %4ld to %4ld uS", schedule, error.name, (unsigned long)error.count, (long)error.min, (long)error.max);
+  TEST_MESSAGE(message);
+}
+
+// The timer has a 4uS tick. Setting a schedule rounds both the current time and the timeout down to a tick (Up to 2 ticks early)
+// Starting the end timer rounds the duration down to a tick (Up to 1 tick early)
+#define TICK_US 4
+#define MAX_START_ERROR (2*TICK_US)
+#define MAX_DURATION_ERROR TICK_US
+
+static void assertErrors(const transitionError &start, const transitionError &duration)
+{
+  TEST_ASSERT_TRUE(start.count > 0U);
+  TEST_ASSERT_TRUE(duration.count > 0U);
+  TEST_ASSERT_LESS_OR_EQUAL(0, start.max);
+  TEST_ASSERT_GREATER_OR_EQUAL(-MAX_START_ERROR, start.min);
+  TEST_ASSERT_LESS_OR_EQUAL(0, duration.max);
+  TEST_ASSERT_GREATER_OR_EQUAL(-MAX_DURATION_ERROR, duration.min);
+}
+
+// The sweep: timeouts and durations from a few uS to the maximum timer period, roughly logarithmically
+// spaced, each started at every phase of the 4uS timer tick
+#define SWEEP_PHASES 4U
+static const uint32_t sweepTimeouts[] = { 8, 13, 20, 37, 64, 101, 150, 333, 500, 999, 1000, 1777, 2500, 5003, 10000, 25001, 50000, 99999, 150000, 200003, MAX_TIMER_PERIOD - 4 };
+static const uint32_t sweepDurations[] = { 4, 7, 18, 50, 123, 401, 1000, 1501, 2999, 4000, 7777, 15000, 22222, 50001, 100000 };
+
+static uint32_t sweepTime = 1000UL;
+
+// Starts the next sweep point at the requested phase of the timer tick, leaving a gap after the previous one
+static void beginSweepPoint(uint8_t phase)
+{
+  sweepTime = micros() + 1000UL;
+  sweepTime = (sweepTime & ~3UL) + phase;
+  runUntil(sweepTime);
+}
+
+static void test_schedules_fuel_sweep(void)
+{
+  transitionError pendingToRunning = { "PENDING->RUNNING", 0, 0, 0 };
+  transitionError runningToOff = { "RUNNING->OFF", 0, 0, 0 };
+  transitionError runningToPending = { "RUNNING->PENDING", 0, 0, 0 };
+  transitionError queuedDuration = { "Queued duration", 0, 0, 0 };
+
+  resetSchedulers();
+  for (uint8_t channel = 0; channel < INJ_CHANNELS; channel++)
+  {
+    FuelSchedule &schedule = fuelSchedules[channel];
+    for (uint8_t timeoutIndex = 0; timeoutIndex < _countof(sweepTimeouts); timeoutIndex++)
+    {
+      for (uint8_t durationIndex = 0; durationIndex < _countof(sweepDurations); durationIndex++)
+      {
+        for (uint8_t phase = 0; phase < SWEEP_PHASES; phase++)
+        {
+          uint32_t timeout = sweepTimeouts[timeoutIndex];
+          uint32_t duration = sweepDurations[durationIndex];
+          beginSweepPoint(phase);
+          startCount[channel] = 0;
+          endCount[channel] = 0;
+
+          //OFF -> PENDING: immediately on setting the schedule
+          uint32_t setTime = micros();
+          setFuelSchedules[channel](timeout, duration);
+          TEST_ASSERT_EQUAL(PENDING, schedule.Status);
+
+          //PENDING -> RUNNING: the start callback is called after the timeout
+          runUntil(setTime + timeout + MAX_START_ERROR);
+          TEST_ASSERT_EQUAL(1, startCount[channel]);
+          recordError(pendingToRunning, (int32_t)(startTimes[channel] - (setTime + timeout)));
+          uint32_t firstStart = startTimes[channel];
+
+          //While running, queue the next pulse to start shortly after this one ends
+          uint32_t queueTime = micros();
+          uint32_t nextTimeout = (firstStart + duration - queueTime) + 100UL;
+          bool canQueue = (schedule.Status == RUNNING) && (nextTimeout < MAX_TIMER_PERIOD);
+          if (canQueue) { setFuelSchedules[channel](nextTimeout, duration); }
+
+          //RUNNING -> OFF (Or PENDING if the next pulse was queued): the end callback is called after the duration
+          runUntil(firstStart + duration + MAX_DURATION_ERROR);
+          TEST_ASSERT_EQUAL(1, endCount[channel]);
+          recordError(runningToOff, (int32_t)((endTimes[channel] - firstStart) - duration));
+
+          if (canQueue)
+          {
+            TEST_ASSERT_EQUAL(PENDING, schedule.Status);
+            runUntil(queueTime + nextTimeout + duration + MAX_START_ERROR);
+            TEST_ASSERT_EQUAL(2, startCount[channel]);
+            TEST_ASSERT_EQUAL(2, endCount[channel]);
+            recordError(runningToPending, (int32_t)(startTimes[channel] - (queueTime + nextTimeout)));
+            recordError(queuedDuration, (int32_t)((endTimes[channel] - startTimes[channel]) - duration));
+          }
+          TEST_ASSERT_EQUAL(OFF, schedule.Status);
+        }
+      }
+    }
+  }
+
+  reportError("Fuel", pendingToRunning);
+  reportError("Fuel", runningToOff);
+  reportError("Fuel", runningToPending);
+  reportError("Fuel", queuedDuration);
+  assertErrors(pendingToRunning, runningToOff);
+  assertErrors(runningToPending, queuedDuration);
+}
+
+static void test_schedules_ignition_sweep(void)
+{
+  transitionError pendingToRunning = { "PENDING->RUNNING", 0, 0, 0 };
+  transitionError runningToOff = { "RUNNING->OFF", 0, 0, 0 };
+  transitionError runningToPending = { "RUNNING->PENDING", 0, 0, 0 };
+  transitionError queuedDuration = { "Queued duration", 0, 0, 0 };
+
+  resetSchedulers();
+  for (uint8_t channel = 0; channel < IGN_CHANNELS; channel++)
+  {
+    Schedule &schedule = ignitionSchedules[channel];
+    for (uint8_t timeoutIndex = 0; timeoutIndex < _countof(sweepTimeouts); timeoutIndex++)
+    {
+      for (uint8_t durationIndex = 0; durationIndex < _countof(sweepDurations); durationIndex++)
+      {
+        for (uint8_t phase = 0; phase < SWEEP_PHASES; phase++)
+        {
+          uint32_t timeout = sweepTimeouts[timeoutIndex];
+          uint32_t duration = sweepDurations[durationIndex];
+          beginSweepPoint(phase);
+          startCount[channel] = 0;
+          endCount[channel] = 0;
+
+          uint32_t setTime = micros();
+          setIgnitionSchedules[channel](startCallbacks[channel], timeout, duration, endCallbacks[channel]);
+          TEST_ASSERT_EQUAL(PENDING, schedule.Status);
+
+          runUntil(setTime + timeout + MAX_START_ERROR);
+          TEST_ASSERT_EQUAL(1, startCount[channel]);
+          recordError(pendingToRunning, (int32_t)(startTimes[channel] - (setTime + timeout)));
+          uint32_t firstStart = startTimes[channel];
+
+          uint32_t queueTime = micros();
+          uint32_t nextTimeout = (firstStart + duration - queueTime) + 100UL;
+          bool canQueue = (schedule.Status == RUNNING) && (nextTimeout < MAX_TIMER_PERIOD);
+          if (canQueue) { setIgnitionSchedules[channel](startCallbacks[channel], nextTimeout, duration, endCallbacks[channel]); }
+
+          runUntil(firstStart + duration + MAX_DURATION_ERROR);
+          TEST_ASSERT_EQUAL(1, endCount[channel]);
+          recordError(runningToOff, (int32_t)((endTimes[channel] - firstStart) - duration));
+
+          if (canQueue)
+          {
+            TEST_ASSERT_EQUAL(PENDING, schedule.Status);
+            runUntil(queueTime + nextTimeout + duration + MAX_START_ERROR);
+            TEST_ASSERT_EQUAL(2, startCount[channel]);
+            TEST_ASSERT_EQUAL(2, endCount[channel]);
+            recordError(runningToPending, (int32_t)(startTimes[channel] - (queueTime + nextTimeout)));
+            recordError(queuedDuration, (int32_t)((endTimes[channel] - startTimes[channel]) - duration));
+          }
+          TEST_ASSERT_EQUAL(OFF, schedule.Status);
+        }
+      }
+    }
+  }
+
+  reportError("Ignition", pendingToRunning);
+  reportError("Ignition", runningToOff);
+  reportError("Ignition", runningToPending);
+  reportError("Ignition", queuedDuration);
+  assertErrors(pendingToRunning, runningToOff);
+  assertErrors(runningToPending, queuedDuration);
+}
+
+// Several pulses queued on one channel run back to back, in order, with the requested timing
+static void test_schedules_fuel_queue(void)
+{
+  resetSchedulers();
+  beginSweepPoint(0);
+  startCount[0] = 0;
+  endCount[0] = 0;
+
+  uint32_t setTime = micros();
+  TEST_ASSERT_TRUE(queueFuelSchedule(0, 1000, 500));
+  TEST_ASSERT_TRUE(queueFuelSchedule(0, 2000, 400));
+  TEST_ASSERT_TRUE(queueFuelSchedule(0, 3000, 300));
+
+  runUntil(setTime + 1000 + MAX_START_ERROR);
+  TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, 1000, (int32_t)(startTimes[0] - setTime));
+  runUntil(setTime + 2000 + MAX_START_ERROR);
+  TEST_ASSERT_EQUAL(2, startCount[0]);
+  TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, 2000, (int32_t)(startTimes[0] - setTime));
+  runUntil(setTime + 4000);
+  TEST_ASSERT_EQUAL(3, startCount[0]);
+  TEST_ASSERT_EQUAL(3, endCount[0]);
+  TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, 3000, (int32_t)(startTimes[0] - setTime));
+  TEST_ASSERT_INT_WITHIN(MAX_DURATION_ERROR, 300, (int32_t)(endTimes[0] - startTimes[0]));
+  TEST_ASSERT_EQUAL(OFF, fuelSchedules[0].Status);
+}
+
+// Refreshing a running ignition schedule moves its end (The spark) on every channel, unless the new time is out of range
+static void test_schedules_ignition_refresh(void)
+{
+  resetSchedulers();
+  for (uint8_t channel = 0; channel < IGN_CHANNELS; channel++)
+  {
+    beginSweepPoint(0);
+    startCount[channel] = 0;
+    endCount[channel] = 0;
+
+    uint32_t setTime = micros();
+    setIgnitionSchedules[channel](startCallbacks[channel], 1000, 3000, endCallbacks[channel]);
+    runUntil(setTime + 1000 + MAX_START_ERROR);
+    TEST_ASSERT_EQUAL(RUNNING, ignitionSchedules[channel].Status);
+
+    //Longer than the dwell and too short to set safely are both ignored
+    refreshIgnitionSchedule(channel, 3500);
+    TEST_ASSERT_EQUAL(ignitionSchedules[channel].endCompare, nativeTimers[NATIVE_TIMER_IGN1 + channel].compare);
+    refreshIgnitionSchedule(channel, IGNITION_REFRESH_THRESHOLD);
+    TEST_ASSERT_EQUAL(ignitionSchedules[channel].endCompare, nativeTimers[NATIVE_TIMER_IGN1 + channel].compare);
+
+    uint32_t refreshTime = micros();
+    refreshIgnitionSchedule(channel, 500);
+    runUntil(refreshTime + 500 + MAX_START_ERROR);
+    TEST_ASSERT_EQUAL(1, endCount[channel]);
+    TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, 500, (int32_t)(endTimes[channel] - refreshTime));
+    TEST_ASSERT_EQUAL(OFF, ignitionSchedules[channel].Status);
+  }
+}
+
+// With the dwell limit set, a schedule longer than the limit ends (Sparks) at the limit rather than being cut off by polling
+static void test_schedules_ignition_dwell_limit(void)
+{
+  resetSchedulers();
+  setIgnitionDwellLimit(2000);
+  for (uint8_t channel = 0; channel < IGN_CHANNELS; channel++)
+  {
+    beginSweepPoint(0);
+    startCount[channel] = 0;
+    endCount[channel] = 0;
+
+    uint32_t setTime = micros();
+    setIgnitionSchedules[channel](startCallbacks[channel], 1000, 5000, endCallbacks[channel]);
+    runUntil(setTime + 1000 + MAX_START_ERROR);
+    TEST_ASSERT_EQUAL(1, startCount[channel]);
+
+    //A refresh can't move the end past the limit either
+    refreshIgnitionSchedule(channel, 4000);
+    runUntil(startTimes[channel] + 2000 + MAX_START_ERROR);
+    TEST_ASSERT_EQUAL(1, endCount[channel]);
+    TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, 2000, (int32_t)(endTimes[channel] - startTimes[channel]));
+    TEST_ASSERT_EQUAL(OFF, ignitionSchedules[channel].Status);
+
+    //Shorter than the limit is unaffected
+    setTime = micros();
+    setIgnitionSchedules[channel](startCallbacks[channel], 1000, 1500, endCallbacks[channel]);
+    runUntil(setTime + 1000 + 1500 + (2 * MAX_START_ERROR));
+    TEST_ASSERT_EQUAL(2, endCount[channel]);
+    TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, 1500, (int32_t)(endTimes[channel] - startTimes[channel]));
+  }
+  setIgnitionDwellLimit(0);
+}
+
+// A refresh of a coil that has already charged for (nearly) the limit (Eg. The limit was lowered while it was charging) sparks
+// straight away. Bringing the end forward to the limit would put the compare behind the counter, where it isn't matched until the timer wraps
+static void test_schedules_ignition_dwell_limit_passed(void)
+{
+  resetSchedulers();
+  for (uint8_t channel = 0; channel < IGN_CHANNELS; channel++)
+  {
+    beginSweepPoint(0);
+    startCount[channel] = 0;
+    endCount[channel] = 0;
+    setIgnitionDwellLimit(0);
+
+    uint32_t setTime = micros();
+    setIgnitionSchedules[channel](startCallbacks[channel], 1000, 5000, endCallbacks[channel]);
+    runUntil(setTime + 1000 + MAX_START_ERROR);
+    TEST_ASSERT_EQUAL(1, startCount[channel]);
+
+    runUntil(startTimes[channel] + 1500);
+    setIgnitionDwellLimit(1000);
+    uint32_t refreshTime = micros();
+    refreshIgnitionSchedule(channel, 3000);
+    runUntil(refreshTime + IGNITION_REFRESH_THRESHOLD + MAX_START_ERROR);
+    TEST_ASSERT_EQUAL(1, endCount[channel]);
+    TEST_ASSERT_INT_WITHIN(MAX_START_ERROR, IGNITION_REFRESH_THRESHOLD, (int32_t)(endTimes[channel] - refreshTime));
+    TEST_ASSERT_EQUAL(OFF, ignitionSchedules[channel].Status);
+  }
+  setIgnitionDwellLimit(0);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  nativeSetVirtualClock(0);
+  lastTimerCounter = NATIVE_TIMER_COUNTER;
+
+  RUN_TEST(test_schedules_fuel_sweep);
+  RUN_TEST(test_schedules_ignition_sweep);
+  RUN_TEST(test_schedules_fuel_queue);
+  RUN_TEST(test_schedules_ignition_refresh);
+  RUN_TEST(test_schedules_ignition_dwell_limit);
+  RUN_TEST(test_schedules_ignition_dwell_limit_passed);
+
+  UNITY_END();
+
+  return 0;
+}
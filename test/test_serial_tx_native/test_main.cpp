@@ -0,0 +1,342 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "src/FastCRC/FastCRCsw.cpp"
+#include "serial_tx.cpp"
+#include "../test_perf_native/perf_timer.h"
+
+volatile uint32_t perf_sink;
+static FastCRC32 crc;
+
+/*
+A port on the host. It takes up to hostSpace bytes per service, as a tx buffer that is emptied between main loop
+iterations (Or a DMA transfer that completes between them)
+*/
+static uint8_t hostData[2048];
+static uint16_t hostLength;
+static uint16_t hostSpace;
+static uint16_t hostSpaceCalls;
+static uint16_t hostWriteCalls;
+
+static uint16_t hostSpaceFn(void)
+{
+  hostSpaceCalls++;
+  return hostSpace;
+}
+
+static uint16_t hostWriteFn(const uint8_t *pData, uint16_t length)
+{
+  hostWriteCalls++;
+  if (length > hostSpace) { length = hostSpace; }
+  memcpy(&hostData[hostLength], pData, length);
+  hostLength += length;
+  hostSpace -= length;
+  return length;
+}
+
+static const serialTxPort hostPort = { hostSpaceFn, hostWriteFn };
+
+static void hostReset(uint16_t space)
+{
+  hostLength = 0;
+  hostSpace = space;
+  hostSpaceCalls = 0;
+  hostWriteCalls = 0;
+}
+
+//Services the queue until it is empty, refilling the port space between services. Returns the number of services
+static uint16_t serviceAll(serialTxQueue &queue, uint16_t space)
+{
+  uint16_t services = 0;
+  while (serialTx_isBusy(queue) == true)
+  {
+    hostSpace = space;
+    serialTx_service(queue);
+    services++;
+  }
+  return services;
+}
+
+static serialTxQueue queue;
+static crcStream stream;
+static uint8_t payload[1024];
+
+//Queues a message as sendSerialPayload() does: Length, payload, CRC
+static void queueMessage(const uint8_t *pPayload, uint16_t length)
+{
+  const uint8_t header[2] = { (uint8_t)(length >> 8), (uint8_t)length };
+  TEST_ASSERT_TRUE(serialTx_queueBytes(queue, header, sizeof(header)));
+  crcStream_begin(stream);
+  TEST_ASSERT_TRUE(serialTx_queueBuffer(queue, pPayload, length, &stream, NULL));
+  TEST_ASSERT_TRUE(serialTx_queueCRC(queue, &stream));
+}
+
+static void checkMessage(const uint8_t *pData, const uint8_t *pPayload, uint16_t length)
+{
+  TEST_ASSERT_EQUAL_UINT(length >> 8, pData[0]);
+  TEST_ASSERT_EQUAL_UINT(length & 0xFFU, pData[1]);
+  TEST_ASSERT_EQUAL_MEMORY(pPayload, &pData[2], length);
+  uint32_t expected = crc.crc32(pPayload, length);
+  uint32_t sentCRC = ((uint32_t)pData[length + 2U] << 24) | ((uint32_t)pData[length + 3U] << 16) | ((uint32_t)pData[length + 4U] << 8) | pData[length + 5U];
+  TEST_ASSERT_EQUAL_UINT32(expected, sentCRC);
+}
+
+static void test_serialTx_message(void)
+{
+  //Every length of message is sent intact whatever the port can take at a time
+  srand(1);
+  for (uint16_t x = 0; x < sizeof(payload); x++) { payload[x] = (uint8_t)rand(); }
+
+  static const uint16_t spaces[] = { 1, 3, 4, 5, 64, 2048 };
+  for (uint8_t s = 0; s < (sizeof(spaces) / sizeof(spaces[0])); s++)
+  {
+    for (uint16_t run = 0; run < 50U; run++)
+    {
+      uint16_t length = (uint16_t)(rand() % sizeof(payload));
+      serialTx_init(queue, &hostPort, &crc);
+      hostReset(0);
+      queueMessage(payload, length);
+      uint16_t services = serviceAll(queue, spaces[s]);
+      TEST_ASSERT_EQUAL_UINT(length + 6U, hostLength);
+      TEST_ASSERT_EQUAL_UINT((length + 6U + spaces[s] - 1U) / spaces[s], services);
+      checkMessage(hostData, payload, length);
+    }
+  }
+
+  //An empty message
+  serialTx_init(queue, &hostPort, &crc);
+  hostReset(0);
+  queueMessage(payload, 0);
+  serviceAll(queue, 64);
+  TEST_ASSERT_EQUAL_UINT(6, hostLength);
+  checkMessage(hostData, payload, 0);
+}
+
+static uint8_t completed;
+static uint16_t completedAt;
+static void onComplete(void)
+{
+  completed++;
+  completedAt = hostLength;
+}
+
+static uint8_t second[3] = { 7, 8, 9 };
+static void queueSecond(void)
+{
+  //A callback can queue more
+  TEST_ASSERT_TRUE(serialTx_queueBuffer(queue, second, sizeof(second), NULL, onComplete));
+}
+
+static void test_serialTx_callbacks(void)
+{
+  serialTx_init(queue, &hostPort, &crc);
+  hostReset(0);
+  completed = 0;
+  TEST_ASSERT_TRUE(serialTx_queueBuffer(queue, payload, 100, NULL, onComplete));
+
+  //Not called until the whole buffer has been written
+  hostSpace = 99;
+  serialTx_service(queue);
+  TEST_ASSERT_EQUAL_UINT(0, completed);
+  TEST_ASSERT_TRUE(serialTx_isBusy(queue));
+  hostSpace = 1;
+  serialTx_service(queue);
+  TEST_ASSERT_EQUAL_UINT(1, completed);
+  TEST_ASSERT_EQUAL_UINT(100, completedAt);
+  TEST_ASSERT_FALSE(serialTx_isBusy(queue));
+
+  //A zero length buffer completes straight away, even when the port is full
+  hostSpace = 0;
+  TEST_ASSERT_TRUE(serialTx_queueBuffer(queue, payload, 0, NULL, onComplete));
+  serialTx_service(queue);
+  TEST_ASSERT_EQUAL_UINT(2, completed);
+
+  //Chained from a callback
+  hostReset(0);
+  TEST_ASSERT_TRUE(serialTx_queueBuffer(queue, payload, 10, NULL, queueSecond));
+  serviceAll(queue, 64);
+  TEST_ASSERT_EQUAL_UINT(13, hostLength);
+  TEST_ASSERT_EQUAL_MEMORY(second, &hostData[10], sizeof(second));
+  TEST_ASSERT_EQUAL_UINT(3, completed);
+}
+
+/*
+A message larger than the buffer it is sent from, as the tooth logs are sent (See queueToothLogChunk() in comms.cpp):
+Each chunk is copied into the buffer and queued by the completion callback of the one before, and the CRC follows the
+last chunk
+*/
+#define CHUNK_SIZE 37U
+static uint8_t chunk[CHUNK_SIZE];
+static uint16_t chunkedLength;
+static uint16_t chunkedOffset;
+
+static void queueNextChunk(void)
+{
+  uint16_t length = chunkedLength - chunkedOffset;
+  if (length > CHUNK_SIZE) { length = CHUNK_SIZE; }
+  memcpy(chunk, &payload[chunkedOffset], length);
+  memset(&payload[chunkedOffset], 0, length); //The source is free once it has been copied (Eg. The log buffer is handed back)
+  chunkedOffset += length;
+  bool last = (chunkedOffset >= chunkedLength);
+  TEST_ASSERT_TRUE(serialTx_queueBuffer(queue, chunk, length, &stream, last ? NULL : queueNextChunk));
+  if (last == true) { TEST_ASSERT_TRUE(serialTx_queueCRC(queue, &stream)); }
+}
+
+static void test_serialTx_chunkedMessage(void)
+{
+  static uint8_t expected[sizeof(payload)];
+  static const uint16_t spaces[] = { 1, 5, 64, 2048 };
+  for (uint8_t s = 0; s < (sizeof(spaces) / sizeof(spaces[0])); s++)
+  {
+    for (uint16_t run = 0; run < 20U; run++)
+    {
+      chunkedLength = 1U + (uint16_t)(rand() % (sizeof(payload) - 1U));
+      for (uint16_t x = 0; x < chunkedLength; x++) { payload[x] = (uint8_t)rand(); }
+      memcpy(expected, payload, chunkedLength);
+      chunkedOffset = 0;
+
+      serialTx_init(queue, &hostPort, &crc);
+      hostReset(0);
+      const uint8_t header[2] = { (uint8_t)(chunkedLength >> 8), (uint8_t)chunkedLength };
+      TEST_ASSERT_TRUE(serialTx_queueBytes(queue, header, sizeof(header)));
+      crcStream_begin(stream);
+      queueNextChunk();
+      serviceAll(queue, spaces[s]);
+      TEST_ASSERT_EQUAL_UINT(chunkedLength + 6U, hostLength);
+      checkMessage(hostData, expected, chunkedLength);
+    }
+  }
+}
+
+static void test_serialTx_queueFull(void)
+{
+  serialTx_init(queue, &hostPort, &crc);
+  hostReset(0);
+  uint8_t bytes[SERIAL_TX_INLINE_SIZE + 1U] = { 1, 2, 3, 4, 5 };
+  TEST_ASSERT_FALSE(serialTx_queueBytes(queue, bytes, sizeof(bytes))); //Too many to copy
+
+  for (uint8_t x = 0; x < SERIAL_TX_QUEUE_SIZE; x++)
+  {
+    TEST_ASSERT_EQUAL_UINT(SERIAL_TX_QUEUE_SIZE - x, serialTx_available(queue));
+    bytes[0] = x;
+    TEST_ASSERT_TRUE(serialTx_queueBytes(queue, bytes, 1));
+  }
+  TEST_ASSERT_EQUAL_UINT(0, serialTx_available(queue));
+  TEST_ASSERT_FALSE(serialTx_queueBytes(queue, bytes, 1));
+  TEST_ASSERT_FALSE(serialTx_queueBuffer(queue, payload, 1, NULL, NULL));
+  TEST_ASSERT_FALSE(serialTx_queueCRC(queue, &stream));
+
+  //The bytes were copied when queued
+  bytes[0] = 0xFF;
+  hostSpace = 2;
+  serialTx_service(queue);
+  TEST_ASSERT_EQUAL_UINT(2, serialTx_available(queue));
+  TEST_ASSERT_EQUAL_UINT(2, hostLength);
+  hostSpace = 2;
+  serialTx_service(queue);
+  TEST_ASSERT_EQUAL_UINT(4, hostLength);
+  TEST_ASSERT_FALSE(serialTx_isBusy(queue));
+  for (uint8_t x = 0; x < SERIAL_TX_QUEUE_SIZE; x++) { TEST_ASSERT_EQUAL_UINT(x, hostData[x]); }
+
+  //The indices wrap
+  for (uint16_t x = 0; x < 300U; x++)
+  {
+    TEST_ASSERT_TRUE(serialTx_queueBytes(queue, bytes, 1));
+    hostReset(1);
+    serialTx_service(queue);
+    TEST_ASSERT_FALSE(serialTx_isBusy(queue));
+  }
+}
+
+/*
+The previous way of sending a payload (Each byte written separately, checking the tx buffer after each) against the
+queue, for the same 64 byte tx buffer. Counts the calls into the port (The serial driver) and times the main loop
+services needed to send the whole payload
+*/
+#define TX_BUFFER_SIZE 64U
+static uint16_t bytesSent;
+
+static bool sendBytewise(const uint8_t *pPayload, uint16_t length)
+{
+  for (; bytesSent < length; )
+  {
+    hostWriteFn(&pPayload[bytesSent], 1);
+    bytesSent++;
+    if (hostSpaceFn() == 0U) { break; }
+  }
+  return (bytesSent >= length);
+}
+
+struct sendCost {
+  uint32_t calls;   //Calls into the port
+  uint64_t total;   //ns, all of the services
+};
+
+static sendCost timeSend(uint16_t length, bool queued)
+{
+  static constexpr uint32_t SENDS = 2000U;
+  sendCost best = { 0, UINT64_MAX };
+  for (uint8_t repeat = 0; repeat < PERF_REPEATS; repeat++)
+  {
+    uint64_t total = 0;
+    for (uint32_t send = 0; send < SENDS; send++)
+    {
+      hostReset(0);
+      bytesSent = 0;
+      if (queued == true) { serialTx_queueBuffer(queue, payload, length, NULL, NULL); }
+      bool done = false;
+      while (done == false)
+      {
+        hostSpace = TX_BUFFER_SIZE;
+        hostLength = 0; //The tx buffer is emptied between services
+        uint64_t start = perf_now_ns();
+        if (queued == true)
+        {
+          serialTx_service(queue);
+          done = !serialTx_isBusy(queue);
+        }
+        else { done = sendBytewise(payload, length); }
+        uint64_t time = perf_now_ns() - start;
+        total += time;
+      }
+      perf_sink = perf_sink + hostData[0];
+    }
+    best.calls = hostSpaceCalls + hostWriteCalls;
+    if (total < best.total) { best.total = total; }
+  }
+  best.total /= SENDS;
+  return best;
+}
+
+static void test_serialTx_portCalls(void)
+{
+  serialTx_init(queue, &hostPort, &crc);
+  //A realtime data poll, a full serial buffer (Page reads) and a page read with SD logging (Larger buffer)
+  static const uint16_t lengths[] = { 143, 517, 1024 };
+  for (uint8_t x = 0; x < (sizeof(lengths) / sizeof(lengths[0])); x++)
+  {
+    sendCost bytewise = timeSend(lengths[x], false);
+    sendCost queued = timeSend(lengths[x], true);
+    char message[160];
+    snprintf(message, sizeof(message), "%4u bytes: port calls %4lu -> %3lu, time %5lu ns -> %4lu ns",
+             lengths[x], (unsigned long)bytewise.calls, (unsigned long)queued.calls, (unsigned long)bytewise.total, (unsigned long)queued.total);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(2U * lengths[x], bytewise.calls);
+    TEST_ASSERT_EQUAL_UINT32(2U * ((lengths[x] + TX_BUFFER_SIZE - 1U) / TX_BUFFER_SIZE), queued.calls);
+  }
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_serialTx_message);
+  RUN_TEST(test_serialTx_callbacks);
+  RUN_TEST(test_serialTx_chunkedMessage);
+  RUN_TEST(test_serialTx_queueFull);
+  RUN_TEST(test_serialTx_portCalls);
+
+  UNITY_END();
+
+  return 0;
+}
@@ -0,0 +1,274 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define TOOTH_LOG_SIZE 127
+#include "tooth_log.h"
+#include "test_single_buffer.h"
+
+static toothLogRing ring;
+static uint32_t entries[TOOTH_LOG_BUFFERS * TOOTH_LOG_SIZE];
+static uint8_t flags[TOOTH_LOG_SIZE];
+#define COMPOSITE_FLAG_PRI  0 //As COMPOSITE_LOG_PRI
+#define COMPOSITE_FLAG_SYNC 3 //As COMPOSITE_LOG_SYNC
+
+//As addToothLogEntry()
+static bool addEntry(uint32_t value)
+{
+  uint16_t slot = toothLog_reserve(ring);
+  if (slot == TOOTH_LOG_NO_SLOT) { return false; }
+  TEST_ASSERT_TRUE(slot < (TOOTH_LOG_BUFFERS * TOOTH_LOG_SIZE));
+  entries[slot] = value;
+  toothLog_commit(ring);
+  return true;
+}
+
+static void test_toothLog_fill(void)
+{
+  toothLog_reset(ring);
+  for (uint32_t i = 0; i < (TOOTH_LOG_SIZE - 1U); i++)
+  {
+    TEST_ASSERT_TRUE(addEntry(i));
+    TEST_ASSERT_FALSE(toothLog_isReady(ring));
+  }
+
+  //The last entry publishes the buffer
+  TEST_ASSERT_TRUE(addEntry(TOOTH_LOG_SIZE - 1U));
+  TEST_ASSERT_TRUE(toothLog_isReady(ring));
+  TEST_ASSERT_EQUAL_UINT16(1, ring.sequence);
+  uint16_t start = toothLog_readStart(ring);
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_EQUAL_UINT32(i, entries[start + i]); }
+}
+
+static void test_toothLog_logsWhileSending(void)
+{
+  //The other buffer fills while the first one is waiting to be sent
+  toothLog_reset(ring);
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_TRUE(addEntry(i)); }
+  uint16_t start = toothLog_readStart(ring);
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_TRUE(addEntry(100U + i)); }
+
+  //Which doesn't disturb the buffer being sent
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_EQUAL_UINT32(i, entries[start + i]); }
+
+  //Both are full, so the next entries are dropped
+  TEST_ASSERT_FALSE(addEntry(200));
+  TEST_ASSERT_FALSE(addEntry(201));
+  TEST_ASSERT_EQUAL_UINT16(2, ring.dropped);
+  TEST_ASSERT_EQUAL_UINT16(1, ring.sequence);
+
+  //Once the first buffer is sent, the second is published by the next entry, which goes into the first
+  toothLog_release(ring);
+  TEST_ASSERT_FALSE(toothLog_isReady(ring));
+  TEST_ASSERT_TRUE(addEntry(300));
+  TEST_ASSERT_TRUE(toothLog_isReady(ring));
+  TEST_ASSERT_EQUAL_UINT16(2, ring.sequence);
+  start = toothLog_readStart(ring);
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_EQUAL_UINT32(100U + i, entries[start + i]); }
+  TEST_ASSERT_EQUAL_UINT8(1, ring.index);
+}
+
+static void test_toothLog_continuous(void)
+{
+  //When each buffer is sent before the next one fills, every entry comes out, in order, however long the log runs
+  toothLog_reset(ring);
+  uint32_t nextExpected = 0;
+  uint16_t sequence = 0;
+  for (uint32_t i = 0; i < (500U * TOOTH_LOG_SIZE); i++)
+  {
+    TEST_ASSERT_TRUE(addEntry(i));
+    //The consumer only gets round to sending some time after each buffer is published
+    if ( toothLog_isReady(ring) && ((i % TOOTH_LOG_SIZE) == (TOOTH_LOG_SIZE / 2U)) )
+    {
+      TEST_ASSERT_EQUAL_UINT16(sequence + 1U, ring.sequence);
+      sequence = ring.sequence;
+      uint16_t start = toothLog_readStart(ring);
+      for (uint32_t x = 0; x < TOOTH_LOG_SIZE; x++) { TEST_ASSERT_EQUAL_UINT32(nextExpected++, entries[start + x]); }
+      toothLog_release(ring);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, ring.dropped);
+  TEST_ASSERT_TRUE(nextExpected >= (499U * TOOTH_LOG_SIZE));
+}
+
+static void test_toothLog_reset(void)
+{
+  toothLog_reset(ring);
+  for (uint32_t i = 0; i < (3U * TOOTH_LOG_SIZE); i++) { addEntry(i); }
+  TEST_ASSERT_TRUE(ring.dropped > 0U);
+
+  toothLog_reset(ring);
+  TEST_ASSERT_FALSE(toothLog_isReady(ring));
+  TEST_ASSERT_EQUAL_UINT16(0, ring.dropped);
+  TEST_ASSERT_EQUAL_UINT16(0, ring.sequence);
+  TEST_ASSERT_EQUAL_UINT8(0, ring.index);
+}
+
+static uint32_t readUint32(const uint8_t *pSource)
+{
+  return ((uint32_t)pSource[0] << 24) | ((uint32_t)pSource[1] << 16) | ((uint32_t)pSource[2] << 8) | pSource[3];
+}
+
+//Decodes a response of toothLog_encodeCompact(). Returns the number of bytes read
+static uint16_t decodeCompact(const uint8_t *pSource, bool composite, uint8_t &firstEntry, uint8_t &count, uint32_t *pValues, uint8_t *pFlags)
+{
+  firstEntry = pSource[0];
+  count = pSource[1];
+  uint32_t lastTime = readUint32(&pSource[2]);
+  uint32_t gaps[2] = { readUint32(&pSource[6]), readUint32(&pSource[10]) };
+  uint16_t position = TOOTH_LOG_COMPACT_HEADER_SIZE;
+  for (uint8_t entry = 0; entry < count; entry++)
+  {
+    uint8_t flagBits = composite ? TOOTH_LOG_COMPACT_FLAG_BITS : 0U;
+    uint8_t nextByte = pSource[position++];
+    pFlags[entry] = nextByte & ((1U << flagBits) - 1U);
+    uint32_t value = (nextByte & 0x7FU) >> flagBits;
+    uint8_t shift = 7U - flagBits;
+    while ((nextByte & 0x80U) != 0U)
+    {
+      nextByte = pSource[position++];
+      value |= (uint32_t)(nextByte & 0x7FU) << shift;
+      shift += 7U;
+    }
+    int32_t delta = (int32_t)(value >> 1) ^ -(int32_t)(value & 1U);
+    uint32_t gap = (composite ? gaps[0] : gaps[1]) + (uint32_t)delta;
+    gaps[0] = gaps[1];
+    gaps[1] = gap;
+    lastTime += gap;
+    pValues[entry] = composite ? lastTime : gap;
+  }
+  return position;
+}
+
+//Gaps of a 36-1 wheel at 3000rpm, with the jitter of a 4uS timer
+static void fillToothLog(bool composite)
+{
+  uint32_t time = 0x7FFFFF00UL; //Includes the micros() wrap
+  srand(1);
+  for (uint16_t entry = 0; entry < TOOTH_LOG_SIZE; entry++)
+  {
+    uint32_t gap = ((entry % 35U) == 34U) ? 1110U : 555U;
+    if (composite) { gap = (entry & 1U) ? (gap / 3U) : (gap - (gap / 3U)); } //Both edges, with the teeth a third of the gap
+    gap += ((uint32_t)rand() % 3U) * 4U;
+    time += gap;
+    entries[entry] = composite ? time : gap;
+    flags[entry] = (uint8_t)(((entry & 1U) << COMPOSITE_FLAG_PRI) | (1U << COMPOSITE_FLAG_SYNC));
+  }
+}
+
+//Sends a whole buffer in chunks of at most chunkLength bytes, decodes it, and checks that it comes back the same
+static uint16_t roundTrip(bool composite, uint16_t chunkLength)
+{
+  uint8_t payload[512];
+  uint32_t decoded[TOOTH_LOG_SIZE];
+  uint8_t decodedFlags[TOOTH_LOG_SIZE];
+  uint16_t totalLength = 0;
+  uint8_t offset = 0;
+  while (offset < TOOTH_LOG_SIZE)
+  {
+    uint16_t length;
+    uint8_t count = toothLog_encodeCompact(entries, composite ? flags : NULL, offset, payload, chunkLength, length);
+    TEST_ASSERT_TRUE(count > 0U);
+    TEST_ASSERT_TRUE(length <= chunkLength);
+
+    uint8_t firstEntry;
+    uint8_t decodedCount;
+    TEST_ASSERT_EQUAL_UINT16(length, decodeCompact(payload, composite, firstEntry, decodedCount, &decoded[offset], &decodedFlags[offset]));
+    TEST_ASSERT_EQUAL_UINT8(offset, firstEntry);
+    TEST_ASSERT_EQUAL_UINT8(count, decodedCount);
+    offset += count;
+    totalLength += length;
+  }
+  for (uint16_t entry = 0; entry < TOOTH_LOG_SIZE; entry++)
+  {
+    TEST_ASSERT_EQUAL_UINT32(entries[entry], decoded[entry]);
+    if (composite) { TEST_ASSERT_EQUAL_UINT8(flags[entry], decodedFlags[entry]); }
+  }
+  return totalLength;
+}
+
+static void test_toothLog_compactVarint(void)
+{
+  uint8_t buffer[TOOTH_LOG_COMPACT_MAX_ENTRY];
+  TEST_ASSERT_EQUAL_UINT32(0, toothLog_zigzag(0));
+  TEST_ASSERT_EQUAL_UINT32(1, toothLog_zigzag(-1));
+  TEST_ASSERT_EQUAL_UINT32(2, toothLog_zigzag(1));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFUL, toothLog_zigzag(INT32_MIN));
+
+  TEST_ASSERT_EQUAL_UINT8(1, toothLog_writeVarint(buffer, 127, 0, 0));
+  TEST_ASSERT_EQUAL_UINT8(0x7F, buffer[0]);
+  TEST_ASSERT_EQUAL_UINT8(2, toothLog_writeVarint(buffer, 128, 0, 0));
+  TEST_ASSERT_EQUAL_UINT8(0x80, buffer[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x01, buffer[1]);
+  //With flags, the first byte only holds 3 bits of the value
+  TEST_ASSERT_EQUAL_UINT8(1, toothLog_writeVarint(buffer, 7, 0x0A, 4));
+  TEST_ASSERT_EQUAL_UINT8(0x7A, buffer[0]);
+  TEST_ASSERT_EQUAL_UINT8(2, toothLog_writeVarint(buffer, 8, 0x0A, 4));
+  TEST_ASSERT_EQUAL_UINT8(0x8A, buffer[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x01, buffer[1]);
+  //The largest values fit in TOOTH_LOG_COMPACT_MAX_ENTRY
+  TEST_ASSERT_EQUAL_UINT8(5, toothLog_writeVarint(buffer, 0xFFFFFFFFUL, 0, 0));
+  TEST_ASSERT_EQUAL_UINT8(TOOTH_LOG_COMPACT_MAX_ENTRY, toothLog_writeVarint(buffer, 0xFFFFFFFFUL, 0x0F, 4));
+}
+
+static void test_toothLog_compactRoundTrip(void)
+{
+  fillToothLog(false);
+  roundTrip(false, 512);
+  roundTrip(false, 40); //Split over many responses
+  fillToothLog(true);
+  roundTrip(true, 512);
+  roundTrip(true, 40);
+
+  //Extreme gaps
+  for (uint16_t entry = 0; entry < TOOTH_LOG_SIZE; entry++) { entries[entry] = (entry & 1U) ? 0xFFFFFFFFUL : 0U; flags[entry] = 0x0F; }
+  roundTrip(false, 512);
+  roundTrip(true, 512);
+}
+
+//The length of a whole buffer in the compact format, with the same framing and stream header as the 'T' format
+static uint16_t compactResponseLength(bool composite)
+{
+  const uint16_t maxLength = 264U - 1U - 4U; //The smallest serialPayload (AVR), less the return code and stream header
+  const uint16_t overhead = 2U + 1U + 4U + 4U; //Length, return code, stream header and CRC
+  uint16_t length = roundTrip(composite, maxLength);
+  return length + (overhead * ((length + maxLength - 1U) / maxLength));
+}
+
+static void test_toothLog_compactSize(void)
+{
+  //Compared with the 'T' format (4 or 5 bytes per entry)
+  const uint16_t overhead = 2U + 1U + 4U; //Length, return code and CRC
+  char message[96];
+
+  fillToothLog(false);
+  uint16_t rawLength = overhead + (TOOTH_LOG_SIZE * 4U);
+  uint16_t compactLength = compactResponseLength(false);
+  snprintf(message, sizeof(message), "Tooth log:     %u bytes raw, %u bytes compact, %.2fx", rawLength, compactLength, (double)rawLength / compactLength);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_TRUE((compactLength * 5U) <= (rawLength * 2U)); //At least 2.5x
+
+  fillToothLog(true);
+  rawLength = overhead + (TOOTH_LOG_SIZE * 5U);
+  compactLength = compactResponseLength(true);
+  snprintf(message, sizeof(message), "Composite log: %u bytes raw, %u bytes compact, %.2fx", rawLength, compactLength, (double)rawLength / compactLength);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_TRUE((compactLength * 5U) <= (rawLength * 2U));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_toothLog_fill);
+  RUN_TEST(test_toothLog_logsWhileSending);
+  RUN_TEST(test_toothLog_continuous);
+  RUN_TEST(test_toothLog_reset);
+  RUN_TEST(test_toothLog_singleBuffer);
+  RUN_TEST(test_toothLog_singleBufferContinuous);
+  RUN_TEST(test_toothLog_compactVarint);
+  RUN_TEST(test_toothLog_compactRoundTrip);
+  RUN_TEST(test_toothLog_compactSize);
+
+  UNITY_END();
+
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <unity.h>
+/*
+The single buffered log of the Mega (See tooth_log.h). This is built on its own, as TOOTH_LOG_BUFFERS is fixed for
+each file that includes tooth_log.h
+*/
+#define TOOTH_LOG_SIZE 127
+#define TOOTH_LOG_BUFFERS 1
+#include "tooth_log.h"
+#include "test_single_buffer.h"
+
+static toothLogRing ring;
+static uint32_t entries[TOOTH_LOG_BUFFERS * TOOTH_LOG_SIZE];
+
+//As addToothLogEntry()
+static bool addEntry(uint32_t value)
+{
+  uint16_t slot = toothLog_reserve(ring);
+  if (slot == TOOTH_LOG_NO_SLOT) { return false; }
+  TEST_ASSERT_TRUE(slot < (TOOTH_LOG_BUFFERS * TOOTH_LOG_SIZE));
+  entries[slot] = value;
+  toothLog_commit(ring);
+  return true;
+}
+
+void test_toothLog_singleBuffer(void)
+{
+  toothLog_reset(ring);
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_TRUE(addEntry(i)); }
+  TEST_ASSERT_TRUE(toothLog_isReady(ring));
+  TEST_ASSERT_EQUAL_UINT16(0, toothLog_readStart(ring));
+
+  //Nothing is logged while the buffer is waiting to be sent, so it isn't disturbed
+  TEST_ASSERT_FALSE(addEntry(200));
+  TEST_ASSERT_FALSE(addEntry(201));
+  TEST_ASSERT_EQUAL_UINT16(2, ring.dropped);
+  for (uint32_t i = 0; i < TOOTH_LOG_SIZE; i++) { TEST_ASSERT_EQUAL_UINT32(i, entries[i]); }
+
+  //Once it has been sent, it is filled again from the start
+  toothLog_release(ring);
+  TEST_ASSERT_TRUE(addEntry(300));
+  TEST_ASSERT_FALSE(toothLog_isReady(ring));
+  TEST_ASSERT_EQUAL_UINT32(300, entries[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, ring.index);
+}
+
+void test_toothLog_singleBufferContinuous(void)
+{
+  //Each buffer is complete and in order, with the entries logged while it was waiting to be sent counted as dropped
+  toothLog_reset(ring);
+  uint32_t sentEntries = 0;
+  uint16_t sequence = 0;
+  for (uint32_t i = 0; i < (500U * TOOTH_LOG_SIZE); i++)
+  {
+    addEntry(i);
+    if ( toothLog_isReady(ring) && ((i % TOOTH_LOG_SIZE) == (TOOTH_LOG_SIZE / 2U)) )
+    {
+      TEST_ASSERT_EQUAL_UINT16(sequence + 1U, ring.sequence);
+      sequence = ring.sequence;
+      for (uint32_t x = 1; x < TOOTH_LOG_SIZE; x++) { TEST_ASSERT_EQUAL_UINT32(entries[0] + x, entries[x]); }
+      sentEntries += TOOTH_LOG_SIZE;
+      toothLog_release(ring);
+    }
+  }
+  TEST_ASSERT_TRUE(sequence > 0U);
+  TEST_ASSERT_EQUAL_UINT32(500U * TOOTH_LOG_SIZE, sentEntries + ring.dropped + ring.index + (toothLog_isReady(ring) ? TOOTH_LOG_SIZE : 0U));
+}
@@ -0,0 +1,2 @@
+void test_toothLog_singleBuffer(void);
+void test_toothLog_singleBufferContinuous(void);
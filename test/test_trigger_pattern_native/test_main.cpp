@@ -0,0 +1,214 @@
+#include <unity.h>
+#include "trigger_pattern.cpp"
+
+/*
+Feeds simulated tooth gaps through the pattern matcher. The crank speed is given in uS per degree x 16
+and changes by accelPerTooth on each tooth (So the gaps are never exactly as per the pattern)
+*/
+struct wheelSimulation {
+  const triggerPattern *pattern;
+  uint8_t nextTooth;
+  int32_t uSPerDegreex16;
+  int32_t accelPerTooth;
+};
+
+static triggerPatternState state;
+
+static void beginSimulation(wheelSimulation &wheel, const triggerPattern *pattern, uint8_t firstTooth, int32_t uSPerDegreex16, int32_t accelPerTooth)
+{
+  wheel.pattern = pattern;
+  wheel.nextTooth = firstTooth;
+  wheel.uSPerDegreex16 = uSPerDegreex16;
+  wheel.accelPerTooth = accelPerTooth;
+  TEST_ASSERT_TRUE(triggerPattern_begin(state, pattern));
+}
+
+//Returns the matcher result for the next tooth of the wheel
+static uint8_t simulateTooth(wheelSimulation &wheel)
+{
+  uint32_t gap = ((uint32_t)triggerPattern_gapAngle(wheel.pattern, wheel.nextTooth) * (uint32_t)wheel.uSPerDegreex16) / 16U;
+  wheel.nextTooth = triggerPattern_nextTooth(wheel.pattern, wheel.nextTooth);
+  wheel.uSPerDegreex16 += wheel.accelPerTooth;
+  return triggerPattern_tooth(state, gap);
+}
+
+//The tooth the simulation last produced
+static uint8_t simulatedTooth(const wheelSimulation &wheel)
+{
+  return (wheel.nextTooth == 0U) ? (wheel.pattern->teeth - 1U) : (wheel.nextTooth - 1U);
+}
+
+//Runs the wheel until sync, checking it takes no more than a cycle plus the sync signature
+static void simulateUntilSync(wheelSimulation &wheel)
+{
+  uint16_t teeth = 0;
+  uint8_t result;
+  do
+  {
+    result = simulateTooth(wheel);
+    teeth++;
+    TEST_ASSERT_TRUE(teeth <= (wheel.pattern->teeth + state.signatureLength + 1U));
+  } while (result != TRIGGER_PATTERN_SYNCED);
+  TEST_ASSERT_EQUAL(simulatedTooth(wheel), state.tooth);
+}
+
+//Runs the wheel for the given number of cycles, checking that every tooth is identified
+static void simulateInSync(wheelSimulation &wheel, uint8_t cycles)
+{
+  for (uint16_t tooth = 0; tooth < (uint16_t)(cycles * wheel.pattern->teeth); tooth++)
+  {
+    TEST_ASSERT_EQUAL(TRIGGER_PATTERN_TOOTH, simulateTooth(wheel));
+    TEST_ASSERT_EQUAL(simulatedTooth(wheel), state.tooth);
+  }
+}
+
+static void test_triggerPattern_builtIn(void)
+{
+  for (uint8_t index = 0; index < TRIGGER_PATTERN_COUNT; index++)
+  {
+    const triggerPattern *pattern = getTriggerPattern(index);
+    TEST_ASSERT_TRUE(triggerPattern_begin(state, pattern));
+    TEST_ASSERT_TRUE(state.signatureLength <= TRIGGER_PATTERN_MAX_SIGNATURE);
+    TEST_ASSERT_EQUAL(0, triggerPattern_toothAngle(pattern, 0));
+
+    //The angles must be ascending and within the cycle
+    uint16_t total = 0;
+    for (uint8_t tooth = 0; tooth < pattern->teeth; tooth++) { total += triggerPattern_gapAngle(pattern, tooth); }
+    TEST_ASSERT_EQUAL(pattern->cycleAngle, total);
+  }
+  //Out of range selections fall back to the first pattern
+  TEST_ASSERT_TRUE(getTriggerPattern(TRIGGER_PATTERN_COUNT) == getTriggerPattern(0));
+}
+
+static void test_triggerPattern_missingTooth(void)
+{
+  //On a missing tooth wheel, the only tooth that can be recognised straight away is the one after the gap
+  TEST_ASSERT_TRUE(triggerPattern_begin(state, getTriggerPattern(0)));
+  TEST_ASSERT_EQUAL(0, state.syncTooth);
+  TEST_ASSERT_EQUAL(1, state.signatureLength);
+  TEST_ASSERT_EQUAL(10, state.minGapAngle);
+  TEST_ASSERT_EQUAL(20, state.maxGapAngle);
+}
+
+static const uint16_t evenTeeth[] PROGMEM = { 0, 90, 180, 270 };
+static const uint16_t repeatingTeeth[] PROGMEM = { 0, 70, 180, 250 };
+
+static void test_triggerPattern_cantSync(void)
+{
+  //Evenly spaced, or repeating within the cycle, so no tooth can be told apart from the gaps
+  const triggerPattern even = { evenTeeth, 4, 360 };
+  const triggerPattern repeating = { repeatingTeeth, 4, 360 };
+  TEST_ASSERT_FALSE(triggerPattern_begin(state, &even));
+  TEST_ASSERT_FALSE(triggerPattern_begin(state, &repeating));
+  for (uint8_t tooth = 0; tooth < 20; tooth++) { TEST_ASSERT_EQUAL(TRIGGER_PATTERN_NO_SYNC, triggerPattern_tooth(state, 1000)); }
+}
+
+static void test_triggerPattern_syncFromAnyTooth(void)
+{
+  wheelSimulation wheel;
+  for (uint8_t index = 0; index < TRIGGER_PATTERN_COUNT; index++)
+  {
+    const triggerPattern *pattern = getTriggerPattern(index);
+    for (uint8_t firstTooth = 0; firstTooth < pattern->teeth; firstTooth++)
+    {
+      beginSimulation(wheel, pattern, firstTooth, 16 * 55, 0); //~3000rpm
+      simulateUntilSync(wheel);
+      simulateInSync(wheel, 3);
+    }
+  }
+}
+
+static void test_triggerPattern_speedChanges(void)
+{
+  wheelSimulation wheel;
+  for (uint8_t index = 0; index < TRIGGER_PATTERN_COUNT; index++)
+  {
+    //Cranking at ~250rpm and accelerating hard, then decelerating from ~6000rpm
+    beginSimulation(wheel, getTriggerPattern(index), 5, 16 * 666, -(16 * 666 / 200));
+    simulateUntilSync(wheel);
+    simulateInSync(wheel, 2);
+
+    beginSimulation(wheel, getTriggerPattern(index), 5, 16 * 28, 1);
+    simulateUntilSync(wheel);
+    simulateInSync(wheel, 4);
+  }
+}
+
+static void test_triggerPattern_noise(void)
+{
+  wheelSimulation wheel;
+  const triggerPattern *pattern = getTriggerPattern(2); //36-2-2-2
+  beginSimulation(wheel, pattern, 0, 16 * 55, 0);
+  simulateUntilSync(wheel);
+  simulateInSync(wheel, 1);
+
+  //A noise pulse part way through a gap splits it in 2, which loses sync
+  uint32_t gap = ((uint32_t)triggerPattern_gapAngle(pattern, wheel.nextTooth) * 55U);
+  wheel.nextTooth = triggerPattern_nextTooth(pattern, wheel.nextTooth);
+  TEST_ASSERT_EQUAL(TRIGGER_PATTERN_SYNC_LOST, triggerPattern_tooth(state, gap / 3U));
+  TEST_ASSERT_FALSE(state.synced);
+  triggerPattern_tooth(state, gap - (gap / 3U));
+
+  //Then it is regained from the pattern again
+  simulateUntilSync(wheel);
+  simulateInSync(wheel, 1);
+
+  //As does a tooth that isn't seen, as the gap either side of it is then seen as one
+  simulateTooth(wheel);
+  uint8_t missedTooth = wheel.nextTooth;
+  wheel.nextTooth = triggerPattern_nextTooth(pattern, missedTooth);
+  gap = ((uint32_t)(triggerPattern_gapAngle(pattern, missedTooth) + triggerPattern_gapAngle(pattern, wheel.nextTooth)) * 55U);
+  wheel.nextTooth = triggerPattern_nextTooth(pattern, wheel.nextTooth);
+  TEST_ASSERT_EQUAL(TRIGGER_PATTERN_SYNC_LOST, triggerPattern_tooth(state, gap));
+}
+
+static void test_triggerPattern_toothAtAngle(void)
+{
+  const triggerPattern *pattern = getTriggerPattern(2); //36-2-2-2
+  TEST_ASSERT_EQUAL(0, triggerPattern_toothAtAngle(pattern, 0));
+  TEST_ASSERT_EQUAL(0, triggerPattern_toothAtAngle(pattern, 9));
+  TEST_ASSERT_EQUAL(12, triggerPattern_toothAtAngle(pattern, 120));
+  TEST_ASSERT_EQUAL(12, triggerPattern_toothAtAngle(pattern, 149)); //In the gap
+  TEST_ASSERT_EQUAL(13, triggerPattern_toothAtAngle(pattern, 150));
+  TEST_ASSERT_EQUAL(29, triggerPattern_toothAtAngle(pattern, 359));
+}
+
+// The next gap is predicted without a division (For the trigger filter), to within 2% of the exact ratio of the gap angles (1/3 is held as 21/64)
+static void test_triggerPattern_nextGap(void)
+{
+  for (uint8_t index = 0; index < TRIGGER_PATTERN_COUNT; index++)
+  {
+    const triggerPattern *pattern = getTriggerPattern(index);
+    TEST_ASSERT_TRUE(triggerPattern_begin(state, pattern));
+    for (uint8_t tooth = 0; tooth < pattern->teeth; tooth++)
+    {
+      state.tooth = tooth;
+      uint32_t gap = 1000UL * triggerPattern_gapAngle(pattern, tooth);
+      uint32_t exact = 1000UL * triggerPattern_gapAngle(pattern, triggerPattern_nextTooth(pattern, tooth));
+      uint32_t predicted = triggerPattern_nextGap(state, gap);
+      TEST_ASSERT_TRUE( (predicted * 100U >= exact * 98U) && (predicted * 100U <= exact * 102U) );
+    }
+  }
+
+  //A pattern with too many teeth is refused
+  static const uint16_t manyTeeth[TRIGGER_PATTERN_MAX_TEETH + 1] = { 0 };
+  const triggerPattern tooMany = { manyTeeth, TRIGGER_PATTERN_MAX_TEETH + 1, 360 };
+  TEST_ASSERT_FALSE(triggerPattern_begin(state, &tooMany));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_triggerPattern_builtIn);
+  RUN_TEST(test_triggerPattern_missingTooth);
+  RUN_TEST(test_triggerPattern_cantSync);
+  RUN_TEST(test_triggerPattern_syncFromAnyTooth);
+  RUN_TEST(test_triggerPattern_speedChanges);
+  RUN_TEST(test_triggerPattern_noise);
+  RUN_TEST(test_triggerPattern_toothAtAngle);
+  RUN_TEST(test_triggerPattern_nextGap);
+
+  UNITY_END();
+
+  return 0;
+}
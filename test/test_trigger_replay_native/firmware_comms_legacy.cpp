@@ -0,0 +1,6 @@
+/*
+comms_legacy.cpp has helpers (In an anonymous namespace) with the same names as those in comms.cpp, so it is built on its
+own rather than with the rest of the firmware in test_main.cpp
+*/
+#undef UNIT_TEST
+#include "comms_legacy.cpp"
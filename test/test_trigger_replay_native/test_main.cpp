@@ -0,0 +1,149 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Replays a recorded trigger file through the complete native firmware (See board_native_replay.ino), as
+SPEEDUINO_NATIVE_REPLAY does, and checks the replay report. The file (missing_tooth_36_1.csv) is a synthetic
+36-1 crank wheel at a constant speed, with the true crank angle and RPM of each edge.
+
+The firmware is built here as the Arduino build puts the sketch together: speeduino.ino, then the other .ino files
+in alphabetical order. A new .ino file must be added to the list. The sketch is built without the unit test guards,
+as it is the real setup() and loop() that are run. comms_legacy.cpp is built separately (See firmware_comms_legacy.cpp)
+*/
+#include "src/NativeArduino/NativeArduino.cpp" //With UNIT_TEST, so that this provides main()
+#undef UNIT_TEST
+#include "speeduino.ino"
+#include "SD_logger.ino"
+#include "TS_CommandButtonHandler.ino"
+#include "acc_mc33810.ino"
+#include "auxiliaries.ino"
+#include "board_avr2560.ino"
+#include "board_native.ino"
+#include "board_native_replay.ino"
+#include "board_same51.ino"
+#include "board_stm32_generic.ino"
+#include "board_stm32_official.ino"
+#include "board_teensy35.ino"
+#include "board_teensy41.ino"
+#include "board_template.ino"
+#include "canBroadcast.ino"
+#include "cancomms.ino"
+#include "corrections.ino"
+#include "crankMaths.ino"
+#include "decoders.ino"
+#include "display.ino"
+#include "engineProtection.ino"
+#include "errors.ino"
+#include "globals.ino"
+#include "idle.ino"
+#include "init.ino"
+#include "logger.ino"
+#include "maths.ino"
+#include "rtc_common.ino"
+#include "scheduledIO.ino"
+#include "scheduler.ino"
+#include "secondaryTables.ino"
+#include "sensors.ino"
+#include "table2d.ino"
+#include "timers.ino"
+#include "updates.ino"
+#include "utilities.ino"
+#include "comms.cpp"
+#include "crank_prediction.cpp"
+#include "isr_stats.cpp"
+#include "output_channels.cpp"
+#include "page_crc.cpp"
+#include "pages.cpp"
+#include "serial_tx.cpp"
+#include "storage.cpp"
+#include "table3d.cpp"
+#include "table3d_axis_io.cpp"
+#include "table3d_interpolate.cpp"
+#include "trigger_pattern.cpp"
+#include "src/FastCRC/FastCRCsw.cpp"
+#include "src/PID_v1/PID_v1.cpp"
+
+#define REPLAY_FILE         "missing_tooth_36_1.csv"
+#define REPLAY_RPM          1500
+#define REPLAY_MAX_LOOPS    100000UL //Far more than the file needs (NATIVE_REPLAY_LOOP_TIME per loop)
+
+static unsigned long replayLoops;
+
+//Runs the firmware as main() in src/NativeArduino does, with the replay of the file next to this one
+static void runReplay(void)
+{
+  char path[512];
+  const char *directoryEnd = strrchr(__FILE__, '/');
+  int directoryLength = (directoryEnd == nullptr) ? 0 : (int)(directoryEnd - __FILE__) + 1;
+  snprintf(path, sizeof(path), "%.*s%s", directoryLength, __FILE__, REPLAY_FILE);
+
+  //A blank tune (Which is the 36-1 wheel of nativeDefaultConfig()) and no serial ports
+  unsetenv("SPEEDUINO_EEPROM");
+  unsetenv("SPEEDUINO_SERIAL");
+  unsetenv("SPEEDUINO_SERIAL3");
+  setenv("SPEEDUINO_NATIVE_REPLAY", path, 1);
+  setenv("SPEEDUINO_NATIVE_DECODER", "0,36,1", 1);
+
+  initTime();
+  initEEPROM();
+  setup();
+  nativeBoardBegin();
+  for (replayLoops = 0; replayLoops < REPLAY_MAX_LOOPS; ++replayLoops)
+  {
+    loop();
+    if (nativeBoardLoop() == false) { break; }
+  }
+}
+
+static void test_replay_complete(void)
+{
+  TEST_ASSERT_LESS_THAN_UINT32(REPLAY_MAX_LOOPS, replayLoops);
+  TEST_ASSERT_NULL(replayFile);
+  TEST_ASSERT_GREATER_THAN_UINT32(800, replayLine);
+}
+
+// The file starts on tooth 1, so the gap is first seen at the end of the first revolution and sync is gained on the tooth after it
+static void test_replay_sync_time(void)
+{
+  TEST_ASSERT_GREATER_THAN_UINT32(0, replaySyncTeeth);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(36, replaySyncTeeth);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(60000000UL / REPLAY_RPM, replaySyncTime); //1 revolution
+}
+
+static void test_replay_no_sync_loss(void)
+{
+  TEST_ASSERT_EQUAL_UINT32(0, replaySyncLosses);
+  TEST_ASSERT_EQUAL_UINT(0, currentStatus.syncLossCounter);
+  TEST_ASSERT_TRUE(currentStatus.hasSync);
+}
+
+// At a constant speed, the angle between teeth (ie on the falling edges) is only out by the rounding of the file times
+static void test_replay_angle_error(void)
+{
+  TEST_ASSERT_GREATER_THAN_UINT32(600, replayAngleErrors.count);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(2, replayAngleErrors.maxAbs);
+  TEST_ASSERT_TRUE(replayAngleErrors.totalAbs <= replayAngleErrors.count); //Mean of at most 1 degree
+}
+
+static void test_replay_rpm_error(void)
+{
+  TEST_ASSERT_GREATER_THAN_UINT32(0, replayRPMErrors.count);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(REPLAY_RPM / 100, replayRPMErrors.maxAbs);
+}
+
+int main(int argc, char **argv)
+{
+  runReplay();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_replay_complete);
+  RUN_TEST(test_replay_sync_time);
+  RUN_TEST(test_replay_no_sync_loss);
+  RUN_TEST(test_replay_angle_error);
+  RUN_TEST(test_replay_rpm_error);
+  UNITY_END();
+
+  return 0;
+}